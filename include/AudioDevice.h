@@ -98,6 +98,12 @@ protected:
 	// called by according driver for fetching new sound-data
 	fpp_t getNextBuffer(SampleFrame* _ab);
 
+	// same as getNextBuffer() but without copying - the returned buffer is
+	// valid until releaseNextBuffer() is called. Returns nullptr if there
+	// are no more buffers.
+	const SampleFrame* acquireNextBuffer();
+	void releaseNextBuffer();
+
 	// convert a given audio-buffer to a buffer in signed 16-bit samples
 	// returns num of bytes in outbuf
 	int convertToS16(const SampleFrame* _ab,
@@ -134,8 +140,6 @@ private:
 
 	QMutex m_devMutex;
 
-	SampleFrame* m_buffer;
-
 };
 
 } // namespace lmms
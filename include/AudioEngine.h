@@ -40,6 +40,7 @@
 #include "FifoBuffer.h"
 #include "AudioEngineProfiler.h"
 #include "PlayHandle.h"
+#include "RcuSnapshot.h"
 
 
 namespace lmms
@@ -175,11 +176,10 @@ public:
 	// audio-port-stuff
 	inline void addAudioPort(AudioPort * port)
 	{
-		requestChangeInModel();
-		m_audioPorts.push_back(port);
-		doneChangeInModel();
+		m_audioPorts.update([port](auto& ports) { ports.push_back(port); });
 	}
 
+	//! Once this returns, the audio engine doesn't use the port anymore
 	void removeAudioPort(AudioPort * port);
 
 
@@ -295,9 +295,16 @@ public:
 		return m_inputBufferFrames[ m_inputBufferRead ];
 	}
 
+	//! Return the next period. It stays valid until releaseNextBuffer() is
+	//! called, which must happen before requesting the next one.
 	inline const SampleFrame* nextBuffer()
 	{
-		return hasFifoWriter() ? m_fifo->read() : renderNextBuffer();
+		return hasFifoWriter() ? m_fifo->beginRead() : renderNextBuffer();
+	}
+
+	inline void releaseNextBuffer()
+	{
+		if (hasFifoWriter()) { m_fifo->endRead(); }
 	}
 
 	void changeQuality(const struct qualitySettings & qs);
@@ -306,6 +313,16 @@ public:
 	void requestChangeInModel();
 	void doneChangeInModel();
 
+	//! Snapshots published to the rendering thread are valid for a period
+	inline const RcuDomain& rcuDomain() const
+	{
+		return m_rcuDomain;
+	}
+
+	//! Wait until the period which might still use snapshots replaced before
+	//! this call has been rendered. Returns immediately in the rendering thread.
+	void synchronizeSnapshots();
+
 	RequestChangesGuard requestChangesGuard()
 	{
 		return RequestChangesGuard{this};
@@ -322,7 +339,7 @@ signals:
 
 
 private:
-	using Fifo = FifoBuffer<SampleFrame*>;
+	using Fifo = FifoBuffer;
 
 	class fifoWriter : public QThread
 	{
@@ -338,8 +355,6 @@ private:
 		volatile bool m_writing;
 
 		void run() override;
-
-		void write(SampleFrame* buffer);
 	} ;
 
 
@@ -366,7 +381,9 @@ private:
 
 	bool m_renderOnly;
 
-	std::vector<AudioPort *> m_audioPorts;
+	RcuDomain m_rcuDomain;
+
+	RcuSnapshot<std::vector<AudioPort *>> m_audioPorts;
 
 	fpp_t m_framesPerPeriod;
 
@@ -388,7 +405,8 @@ private:
 	PlayHandleList m_playHandles;
 	// place where new playhandles are added temporarily
 	LocklessList<PlayHandle *> m_newPlayHandles;
-	ConstPlayHandleList m_playHandlesToRemove;
+	// play-handles which are removed at the beginning of the next period
+	LocklessList<PlayHandle *> m_playHandlesToRemove;
 
 
 	struct qualitySettings m_qualitySettings;
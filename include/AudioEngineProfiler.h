@@ -27,10 +27,13 @@
 
 #include <array>
 #include <atomic>
+#include <cstdint>
 #include <QFile>
 
 #include "lmms_basics.h"
+#include "CpuTimeCounter.h"
 #include "MicroTimer.h"
+#include "RenderTracer.h"
 
 namespace lmms
 {
@@ -39,7 +42,7 @@ class AudioEngineProfiler
 {
 public:
 	AudioEngineProfiler();
-	~AudioEngineProfiler() = default;
+	~AudioEngineProfiler();
 
 	void startPeriod()
 	{
@@ -55,6 +58,10 @@ public:
 
 	void setOutputFile( const QString& outputFile );
 
+	//! Record a timeline of the render loop into @p traceFile, which can be
+	//! opened in chrome://tracing or Perfetto, see RenderTracer
+	bool setTraceFile(const QString& traceFile);
+
 	enum class DetailType {
 		NoteSetup,
 		Instruments,
@@ -70,12 +77,44 @@ public:
 		return m_detailLoad[static_cast<std::size_t>(type)].load(std::memory_order_relaxed);
 	}
 
+	//! Sum of the time budgets of all periods rendered so far
+	std::uint64_t renderedNanoseconds() const
+	{
+		return m_renderedNanoseconds.load(std::memory_order_relaxed);
+	}
+
+	/**
+		Computes the load caused by a single object, like an instrument
+		track, an effect or a mixer channel, from its CpuTimeCounter. The
+		load is relative to the budget of the periods rendered in between
+		two calls of update(), so views can poll it at any rate, e.g. on
+		MainWindow::periodicUpdate. With multiple worker threads, the loads
+		of all objects can sum up to more than 100%.
+	*/
+	class LoadMeter
+	{
+	public:
+		int update(const AudioEngineProfiler& profiler, const CpuTimeCounter& counter);
+
+		int load() const
+		{
+			return static_cast<int>(m_load);
+		}
+
+	private:
+		std::uint64_t m_lastCpuTime = 0;
+		std::uint64_t m_lastRenderedTime = 0;
+		bool m_started = false;
+		float m_load = 0.f;
+	};
+
 	class Probe
 	{
 	public:
 		Probe(AudioEngineProfiler& profiler, AudioEngineProfiler::DetailType type)
 			: m_profiler(profiler)
 			, m_type(type)
+			, m_traceScope(s_detailNames[static_cast<std::size_t>(type)], "render")
 		{
 			profiler.startDetail(type);
 		}
@@ -87,9 +126,14 @@ public:
 	private:
 		AudioEngineProfiler &m_profiler;
 		const AudioEngineProfiler::DetailType m_type;
+		RenderTracer::Scope m_traceScope;
 	};
 
 private:
+	static constexpr std::array<const char*, DetailCount> s_detailNames{
+		"Note setup", "Instruments", "Effects", "Mixing"
+	};
+
 	void startDetail(const DetailType type) { m_detailTimer[static_cast<std::size_t>(type)].reset(); }
 	void finishDetail(const DetailType type)
 	{
@@ -98,6 +142,7 @@ private:
 
 	MicroTimer m_periodTimer;
 	std::atomic<float> m_cpuLoad;
+	std::atomic<std::uint64_t> m_renderedNanoseconds;
 	QFile m_outputFile;
 
 	// Use arrays to avoid dynamic allocations in realtime code
@@ -28,13 +28,15 @@
 #include <QThread>
 
 #include <atomic>
-
-class QWaitCondition;
+#include <cstdint>
+#include <memory>
+#include <vector>
 
 namespace lmms
 {
 
 class AudioEngine;
+class Semaphore;
 class ThreadableJob;
 
 class AudioEngineWorkerThread : public QThread
@@ -42,6 +44,11 @@ class AudioEngineWorkerThread : public QThread
 	Q_OBJECT
 public:
 	// internal representation of the job queue - all functions are thread-safe
+	//
+	// Every worker thread (including the "inline" worker that runs within the
+	// rendering thread) owns a work-stealing deque. Jobs are pushed onto the
+	// deque of the thread that adds them and popped from its bottom by that
+	// thread only, while idle workers steal from the top of other deques.
 	class JobQueue
 	{
 	public:
@@ -51,28 +58,65 @@ public:
 			Dynamic	// jobs can be added while processing queue
 		} ;
 
+		// capacity of each worker's deque, must be a power of two
 		static constexpr size_t JOB_QUEUE_SIZE = 8192;
 
 		JobQueue() :
-			m_items(),
-			m_writeIndex( 0 ),
+			m_deques(),
+			m_itemsAdded( 0 ),
 			m_itemsDone( 0 ),
 			m_opMode( OperationMode::Static )
 		{
-			std::fill(m_items, m_items + JOB_QUEUE_SIZE, nullptr);
 		}
 
+		//! Add a deque for a new worker and return its index. Must not be
+		//! called while jobs are being processed.
+		int addWorker();
+
 		void reset( OperationMode _opMode );
 
 		void addJob( ThreadableJob * _job );
 
+		//! Process jobs until there is no more work for this thread
 		void run();
 		void wait();
 
+		OperationMode opMode() const
+		{
+			return m_opMode;
+		}
+
+		//! Number of jobs that have been added but not completed yet
+		size_t pending() const
+		{
+			return m_itemsAdded.load( std::memory_order_acquire ) -
+				m_itemsDone.load( std::memory_order_acquire );
+		}
+
 	private:
-		std::atomic<ThreadableJob*> m_items[JOB_QUEUE_SIZE];
-		std::atomic_size_t m_writeIndex;
-		std::atomic_size_t m_itemsDone;
+		//! Bounded Chase-Lev work-stealing deque. push() and pop() may only
+		//! be called by the owning thread, steal() by any thread.
+		class Deque
+		{
+		public:
+			Deque();
+
+			bool push( ThreadableJob * _job );
+			ThreadableJob * pop();
+			ThreadableJob * steal();
+
+		private:
+			alignas( 64 ) std::atomic<std::int64_t> m_top;
+			alignas( 64 ) std::atomic<std::int64_t> m_bottom;
+			alignas( 64 ) std::unique_ptr<std::atomic<ThreadableJob*>[]> m_items;
+		} ;
+
+		Deque & ownDeque();
+		ThreadableJob * findJob();
+
+		std::vector<std::unique_ptr<Deque>> m_deques;
+		alignas( 64 ) std::atomic_size_t m_itemsAdded;
+		alignas( 64 ) std::atomic_size_t m_itemsDone;
 		OperationMode m_opMode;
 	} ;
 
@@ -112,10 +156,15 @@ public:
 private:
 	void run() override;
 
+	//! Wake up to \p count parked worker threads
+	static void wakeWorkers( size_t count );
+
 	static JobQueue globalJobQueue;
-	static QWaitCondition * queueReadyWaitCond;
+	static Semaphore * queueReadySemaphore;
+	static std::atomic_int parkedWorkers;
 	static QList<AudioEngineWorkerThread *> workerThreads;
 
+	int m_index;
 	volatile bool m_quit;
 } ;
 
@@ -25,6 +25,7 @@
 #ifndef LMMS_AUTOMATABLE_MODEL_H
 #define LMMS_AUTOMATABLE_MODEL_H
 
+#include <atomic>
 #include <cmath>
 #include <QMap>
 #include <QMutex>
@@ -213,6 +214,10 @@ public:
 	void setInitValue( const float value );
 
 	void setAutomatedValue( const float value );
+	//! Makes valueBuffer() return @p values for the frames from @p offset
+	//! to the end of the current period, for automation which changes
+	//! within a period. The values are unscaled like for setAutomatedValue().
+	void setAutomatedValueBuffer(const float* values, fpp_t offset);
 	void setValue( const float value );
 
 	void incValue( int steps )
@@ -406,14 +411,35 @@ private:
 	ControllerConnection* m_controllerConnection;
 
 
-	ValueBuffer m_valueBuffer;
-	long m_lastUpdatedPeriod;
+	//! Computes m_valueBuffer for the current period, returns whether
+	//! there is sample-exact data
+	bool updateValueBuffer();
+
+	//! Must be called when the value, the controller connection or the
+	//! linked models change, so valueBuffer() does not skip the update
+	void markValueBufferChanged()
+	{
+		++m_valueVersion;
+		m_valueBufferIdle.store(false);
+	}
+
+	//! Returns m_valueBuffer, acquiring it from the ValueBufferPool if needed
+	ValueBuffer* acquireValueBuffer();
+	void releaseValueBuffer();
+
+	//! Only held while there is sample-exact data, see ValueBufferPool
+	ValueBuffer* m_valueBuffer;
+	//! The period m_valueBuffer and m_hasSampleExactData are published for
+	std::atomic<long> m_lastUpdatedPeriod;
+	//! The period a thread has started to compute m_valueBuffer for
+	std::atomic<long> m_claimedPeriod;
 	static long s_periodCounter;
 
 	bool m_hasSampleExactData;
-
-	// prevent several threads from attempting to write the same vb at the same time
-	QMutex m_valueBufferMutex;
+	//! Set if valueBuffer() can return nullptr without any checks, because
+	//! there is no controller or linked model and the value did not change
+	std::atomic<bool> m_valueBufferIdle;
+	std::atomic<unsigned> m_valueVersion = 0;
 
 	bool m_useControllerValue;
 
@@ -29,6 +29,8 @@
 
 #include <QMap>
 #include <QPointer>
+#include <atomic>
+#include <vector>
 #if (QT_VERSION >= QT_VERSION_CHECK(5,14,0))
 	#include <QRecursiveMutex>
 #endif
@@ -173,6 +175,11 @@ public:
 	float valueAt( const TimePos & _time ) const;
 	float *valuesAfter( const TimePos & _time ) const;
 
+	//! Writes the values at @p count times into @p values, the first one
+	//! at @p time (in ticks relative to the clip) and the others following
+	//! in steps of @p step ticks, e.g. the length of one frame
+	void valuesAt(double time, double step, float* values, int count) const;
+
 	QString name() const;
 
 	// settings-management
@@ -209,6 +216,30 @@ private:
 	void generateTangents(timeMap::iterator it, int numToGenerate);
 	float valueAt( timeMap::const_iterator v, int offset ) const;
 
+	//! The curve from one node to the next one, or the value after the
+	//! last node, as a polynomial of the ticks since the node
+	struct Segment
+	{
+		int pos;
+		//! The value exactly at pos
+		float inValue;
+		float c0, c1, c2, c3;
+
+		float valueAt(float offset) const
+		{
+			return c0 + offset * (c1 + offset * (c2 + offset * c3));
+		}
+	};
+
+	void invalidateSegments()
+	{
+		m_segmentsValid = false;
+	}
+	void updateSegments() const;
+	//! Index of the segment containing @p time, or -1 if it is before the
+	//! first node. Calls with increasing times are amortized O(1).
+	int segmentAt(double time) const;
+
 	/**
 	 * @brief
 	 * This function combines the song tracks, pattern store tracks,
@@ -231,6 +262,11 @@ private:
 	objectVector m_objects;
 	timeMap m_timeMap;	// actual values
 	timeMap m_oldTimeMap;	// old values for storing the values before setDragValue() is called.
+
+	// m_timeMap compiled for playback, only accessed with m_clipMutex locked
+	mutable std::vector<Segment> m_segments;
+	mutable std::atomic<bool> m_segmentsValid = false;
+	mutable int m_segmentCursor = 0;
 	float m_tension;
 	bool m_hasAutomation;
 	ProgressionType m_progressionType;
@@ -29,6 +29,9 @@
 class QDataStream;
 class QString;
 
+#include <array>
+#include <memory>
+
 #include "lmms_export.h"
 #include "interpolation.h"
 #include "lmms_basics.h"
@@ -57,7 +60,7 @@ const int TLENS[MAXTBL+1] = { 2 << 0, 3 << 0, 2 << 1, 3 << 1,
 struct WaveMipMap
 {
 public:
-	inline sample_t sampleAt(int table, int ph)
+	inline sample_t sampleAt(int table, int ph) const
 	{
 		if (table % 2 == 0) { return m_data[TLENS[table] + ph]; }
 		else
@@ -140,12 +143,12 @@ public:
 		int lookup = static_cast<int>( lookupf );
 		const float ip = fraction( lookupf );
 
-		const sample_t s1 = s_waveforms[ static_cast<std::size_t>(_wave) ].sampleAt( t, lookup );
-		const sample_t s2 = s_waveforms[ static_cast<std::size_t>(_wave) ].sampleAt( t, ( lookup + 1 ) % tlen );
+		const sample_t s1 = (*s_waveforms)[ static_cast<std::size_t>(_wave) ].sampleAt( t, lookup );
+		const sample_t s2 = (*s_waveforms)[ static_cast<std::size_t>(_wave) ].sampleAt( t, ( lookup + 1 ) % tlen );
 
 		const int lm = lookup == 0 ? tlen - 1 : lookup - 1;
-		const sample_t s0 = s_waveforms[ static_cast<std::size_t>(_wave) ].sampleAt( t, lm );
-		const sample_t s3 = s_waveforms[ static_cast<std::size_t>(_wave) ].sampleAt( t, ( lookup + 2 ) % tlen );
+		const sample_t s0 = (*s_waveforms)[ static_cast<std::size_t>(_wave) ].sampleAt( t, lm );
+		const sample_t s3 = (*s_waveforms)[ static_cast<std::size_t>(_wave) ].sampleAt( t, ( lookup + 2 ) % tlen );
 		const sample_t sr = optimal4pInterpolate( s0, s1, s2, s3, ip );
 
 		return sr;
@@ -154,8 +157,8 @@ public:
 		lookup = lookup << 1;
 		tlen = tlen << 1;
 		t += 1;
-		const sample_t s3 = s_waveforms[ static_cast<std::size_t>(_wave) ].sampleAt( t, lookup );
-		const sample_t s4 = s_waveforms[ static_cast<std::size_t>(_wave) ].sampleAt( t, ( lookup + 1 ) % tlen );
+		const sample_t s3 = (*s_waveforms)[ static_cast<std::size_t>(_wave) ].sampleAt( t, lookup );
+		const sample_t s4 = (*s_waveforms)[ static_cast<std::size_t>(_wave) ].sampleAt( t, ( lookup + 1 ) % tlen );
 		const sample_t s34 = linearInterpolate( s3, s4, ip );
 
 		const float ip2 = ( ( tlen - _wavelen ) / tlen - 0.5 ) * 2.0;
@@ -169,7 +172,10 @@ public:
 
 	static bool s_wavesGenerated;
 
-	static std::array<WaveMipMap, NumWaveforms> s_waveforms;
+	using Waveforms = std::array<WaveMipMap, NumWaveforms>;
+	//! Mapped from the MappedCache, or s_generatedWaveforms if the cache could not be used
+	static const Waveforms* s_waveforms;
+	static std::unique_ptr<Waveforms> s_generatedWaveforms;
 
 	static QString s_wavetableDir;
 };
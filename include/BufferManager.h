@@ -28,19 +28,28 @@
 
 #include "lmms_export.h"
 #include "lmms_basics.h"
+#include "LocklessPool.h"
 
 namespace lmms
 {
 
 class SampleFrame;
 
+//! Real-time safe pool of period-sized, cache-line aligned sample buffers.
+//! acquire() and release() are lock-free and don't allocate as long as the
+//! pool is not exhausted, see LocklessPool.
 class LMMS_EXPORT BufferManager
 {
 public:
+	using Statistics = LocklessPool::Statistics;
+
 	static void init( fpp_t fpp );
 	static SampleFrame* acquire();
 	static void release( SampleFrame* buf );
 
+	static Statistics statistics();
+	static void resetHighWaterMark();
+
 private:
 	static fpp_t s_framesPerPeriod;
 };
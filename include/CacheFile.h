@@ -0,0 +1,50 @@
+/*
+ * CacheFile.h - versioned data streams in the cache directory
+ *
+ * This file is part of LMMS - https://lmms.io
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this program (see COPYING); if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301 USA.
+ *
+ */
+
+#ifndef LMMS_CACHE_FILE_H
+#define LMMS_CACHE_FILE_H
+
+#include <QtGlobal>
+#include <functional>
+
+#include "lmms_export.h"
+
+class QDataStream;
+class QString;
+
+//! Files in ConfigManager::cacheDir() holding data that can be regenerated at
+//! any time, e.g. catalogs of installed plugins. Each file starts with a version,
+//! which must be bumped whenever the format of the data changes.
+namespace lmms::CacheFile
+{
+	//! Reads the cache file \a name with \a read if it has the given \a version.
+	//! Returns false if the file is missing, has another version or is incomplete.
+	LMMS_EXPORT bool read(const QString& name, quint32 version,
+		const std::function<void(QDataStream&)>& read);
+
+	//! Replaces the cache file \a name with the data written by \a write.
+	//! Readers see either the old or the new file, never a partially written one.
+	LMMS_EXPORT bool write(const QString& name, quint32 version,
+		const std::function<void(QDataStream&)>& write);
+} // namespace lmms::CacheFile
+
+#endif // LMMS_CACHE_FILE_H
@@ -238,6 +238,10 @@ public:
 	// Returns true if the working dir (e.g. ~/lmms) exists on disk.
 	bool hasWorkingDir() const;
 
+	// Directory for data that is derived from other files and can be regenerated at any time,
+	// e.g. ~/.cache/lmms/. It is not created by this method.
+	QString cacheDir() const;
+
 	void addRecentlyOpenedProject(const QString & _file);
 
 	QString value(const QString& cls, const QString& attribute, const QString& defaultVal = "") const;
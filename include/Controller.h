@@ -154,8 +154,8 @@ protected:
 
 	// buffer for storing sample-exact values in case there
 	// are more than one model wanting it, so we don't have to create it
-	// again every time
-	ValueBuffer m_valueBuffer;
+	// again every time - acquired from the ValueBufferPool on first use
+	ValueBuffer * m_valueBuffer;
 	// when we last updated the valuebuffer - so we know if we have to update it
 	long m_bufferLastUpdated;
 
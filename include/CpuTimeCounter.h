@@ -0,0 +1,82 @@
+/*
+ * CpuTimeCounter.h - processing time spent on behalf of an object
+ *
+ * This file is part of LMMS - https://lmms.io
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this program (see COPYING); if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301 USA.
+ *
+ */
+
+#ifndef LMMS_CPU_TIME_COUNTER_H
+#define LMMS_CPU_TIME_COUNTER_H
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+
+namespace lmms
+{
+
+/**
+	Sums up the processing time spent on behalf of a single object, e.g. an
+	instrument track with all its play-handles, over all threads. Adding is
+	lock-free, so it can be done from the worker threads around every job.
+
+	The counter only ever grows. Loads are derived by the readers from the
+	difference between two readings, see AudioEngineProfiler::LoadMeter.
+*/
+class CpuTimeCounter
+{
+public:
+	using Clock = std::chrono::steady_clock;
+
+	//! Adds the time between its construction and its destruction
+	class Scope
+	{
+	public:
+		explicit Scope(CpuTimeCounter& counter) :
+			m_counter(counter),
+			m_start(Clock::now())
+		{
+		}
+		~Scope() { m_counter.add(Clock::now() - m_start); }
+		Scope(const Scope&) = delete;
+		Scope& operator=(const Scope&) = delete;
+
+	private:
+		CpuTimeCounter& m_counter;
+		const Clock::time_point m_start;
+	};
+
+	void add(Clock::duration time)
+	{
+		const auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(time).count();
+		m_nanoseconds.fetch_add(static_cast<std::uint64_t>(ns), std::memory_order_relaxed);
+	}
+
+	//! Total processing time so far
+	std::uint64_t nanoseconds() const
+	{
+		return m_nanoseconds.load(std::memory_order_relaxed);
+	}
+
+private:
+	std::atomic<std::uint64_t> m_nanoseconds = 0;
+};
+
+} // namespace lmms
+
+#endif // LMMS_CPU_TIME_COUNTER_H
@@ -31,12 +31,14 @@
 #include "AudioEngine.h"
 #include "AutomatableModel.h"
 #include "TempoSyncKnobModel.h"
+#include "CpuTimeCounter.h"
 
 namespace lmms
 {
 
 class EffectChain;
 class EffectControls;
+class PlanarBuffer;
 
 namespace gui
 {
@@ -66,6 +68,16 @@ public:
 	//! Returns true if audio was processed and should continue being processed
 	bool processAudioBuffer(SampleFrame* buf, const fpp_t frames);
 
+	//! Same for effects processing planar buffers, see isPlanar()
+	bool processAudioBuffer(PlanarBuffer& buf, const fpp_t frames);
+
+	//! Whether processPlanarImpl() is used instead of processImpl(). Effect
+	//! chains pass planar buffers between such effects without converting.
+	inline bool isPlanar() const
+	{
+		return m_planar;
+	}
+
 	inline ch_cnt_t processorCount() const
 	{
 		return m_processors;
@@ -165,6 +177,12 @@ public:
 		return m_parent;
 	}
 
+	//! Time spent processing this effect
+	const CpuTimeCounter& cpuTime() const
+	{
+		return m_cpuTime;
+	}
+
 	virtual EffectControls * controls() = 0;
 
 	static Effect * instantiate( const QString & _plugin_name,
@@ -190,6 +208,20 @@ protected:
 	 */
 	virtual ProcessStatus processImpl(SampleFrame* buf, const fpp_t frames) = 0;
 
+	/**
+	 * The audio processing method for effects which have enabled it with
+	 * setPlanar(). Each channel of @p buf holds @p frames samples.
+	 */
+	virtual ProcessStatus processPlanarImpl(PlanarBuffer&, const fpp_t)
+	{
+		return ProcessStatus::Sleep;
+	}
+
+	inline void setPlanar(bool planar)
+	{
+		m_planar = planar;
+	}
+
 	/**
 	 * Optional method that runs when plugin is sleeping (not enabled,
 	 * not running, not in the Okay state, or in the Don't Run state)
@@ -245,6 +277,7 @@ private:
 	bool m_okay;
 	bool m_noRun;
 	bool m_running;
+	bool m_planar;
 	f_cnt_t m_bufferCount;
 
 	BoolModel m_enabledModel;
@@ -254,6 +287,8 @@ private:
 	
 	bool m_autoQuitDisabled;
 
+	CpuTimeCounter m_cpuTime;
+
 	SRC_DATA m_srcData[2];
 	SRC_STATE * m_srcState[2];
 
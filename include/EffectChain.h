@@ -29,6 +29,7 @@
 #include "Model.h"
 #include "SerializingObject.h"
 #include "AutomatableModel.h"
+#include "PlanarBuffer.h"
 
 namespace lmms
 {
@@ -75,6 +76,8 @@ private:
 
 	BoolModel m_enabledModel;
 
+	//! The signal while it is processed by planar effects
+	PlanarBuffer m_planarBuffer;
 
 	friend class gui::EffectRackView;
 
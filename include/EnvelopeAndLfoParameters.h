@@ -25,11 +25,14 @@
 #ifndef LMMS_ENVELOPE_AND_LFO_PARAMETERS_H
 #define LMMS_ENVELOPE_AND_LFO_PARAMETERS_H
 
+#include <array>
+#include <atomic>
 #include <memory>
 #include <vector>
 
 #include "JournallingObject.h"
 #include "AutomatableModel.h"
+#include "RcuSnapshot.h"
 #include "SampleBuffer.h"
 #include "TempoSyncKnobModel.h"
 #include "lmms_basics.h"
@@ -48,29 +51,25 @@ class LMMS_EXPORT EnvelopeAndLfoParameters : public Model, public JournallingObj
 {
 	Q_OBJECT
 public:
+	//! Clock shared by all LFOs. Each LFO derives its position from it,
+	//! so advancing all of them is a single atomic add per period.
 	class LfoInstances
 	{
 	public:
-		LfoInstances() = default;
-
-		~LfoInstances() = default;
-
-		inline bool isEmpty() const
-		{
-			return m_lfos.isEmpty();
-		}
-
+		//! Advance all LFOs by one period
 		void trigger();
+		//! Restart all LFOs at their first frame
 		void reset();
 
-		void add( EnvelopeAndLfoParameters * lfo );
-		void remove( EnvelopeAndLfoParameters * lfo );
+		f_cnt_t frame() const { return m_frame.load(std::memory_order_relaxed); }
+		unsigned resets() const { return m_resets.load(std::memory_order_relaxed); }
+		long period() const { return m_period.load(std::memory_order_relaxed); }
 
 	private:
-		QMutex m_lfoListMutex;
-		using LfoList = QList<EnvelopeAndLfoParameters*>;
-		LfoList m_lfos;
-
+		std::atomic<f_cnt_t> m_frame = 0;
+		std::atomic<unsigned> m_resets = 0;
+		//! Number of periods since start, never reset
+		std::atomic<long> m_period = 0;
 	};
 
 	enum class LfoShape
@@ -95,7 +94,7 @@ public:
 
 	static LfoInstances * instances()
 	{
-		return s_lfoInstances;
+		return &s_lfoInstances;
 	}
 
 	void fillLevel( float * _buf, f_cnt_t _frame,
@@ -152,16 +151,45 @@ public slots:
 	void updateSampleVars();
 
 
-protected:
-	void fillLfoLevel( float * _buf, f_cnt_t _frame, const fpp_t _frames );
+private:
+	//! Everything fillLevel() needs, published as a whole by updateSampleVars()
+	//! so that notes can read it from any thread without locking
+	struct Levels
+	{
+		//! Linear piece of the envelope, ranging from the end of the previous
+		//! one to end, starting at base
+		struct Segment
+		{
+			f_cnt_t end;
+			float base;
+			float slope;
+		};
+
+		//! Pre-delay, attack, hold and decay
+		std::array<Segment, 4> pahd;
+		float sustainLevel;
+		f_cnt_t releaseFrames;
+		float releaseSlope;
+		bool controlEnvAmount;
+
+		f_cnt_t lfoPredelayFrames;
+		f_cnt_t lfoAttackFrames;
+		f_cnt_t lfoOscillationFrames;
+		float lfoAmount;
+		bool lfoAmountIsZero;
+		LfoShape lfoShape;
+		std::shared_ptr<const SampleBuffer> userWave;
+
+		float envelopeLevel(f_cnt_t frame) const;
+	};
 
+	void fillEnvelopeLevel(const Levels& levels, float* buf, f_cnt_t frame,
+		f_cnt_t releaseBegin, fpp_t frames) const;
+	void fillLfoLevel(const Levels& levels, float* buf, f_cnt_t frame, fpp_t frames);
 
-private:
-	static LfoInstances * s_lfoInstances;
+	static LfoInstances s_lfoInstances;
 	bool m_used;
 
-	QMutex m_paramMutex;
-
 	FloatModel m_predelayModel;
 	FloatModel m_attackModel;
 	FloatModel m_holdModel;
@@ -170,16 +198,9 @@ private:
 	FloatModel m_releaseModel;
 	FloatModel m_amountModel;
 
-	float  m_sustainLevel;
-	float  m_amount;
 	float  m_valueForZeroAmount;
-	float  m_amountAdd;
 	f_cnt_t m_pahdFrames;
 	f_cnt_t m_rFrames;
-	sample_t * m_pahdEnv;
-	sample_t * m_rEnv;
-	f_cnt_t m_pahdBufSize;
-	f_cnt_t m_rBufSize;
 
 
 	FloatModel m_lfoPredelayModel;
@@ -195,18 +216,25 @@ private:
 	f_cnt_t m_lfoPredelayFrames;
 	f_cnt_t m_lfoAttackFrames;
 	f_cnt_t m_lfoOscillationFrames;
-	f_cnt_t m_lfoFrame;
-	float m_lfoAmount;
-	bool m_lfoAmountIsZero;
-	sample_t * m_lfoShapeData;
-	sample_t m_random;
-	bool m_bad_lfoShapeData;
 	std::shared_ptr<const SampleBuffer> m_userWave = SampleBuffer::emptyBuffer();
 
+	RcuSnapshot<Levels> m_levels;
+
+	//! LfoInstances::frame() and resets() when this LFO started
+	f_cnt_t m_lfoFrameOffset;
+	unsigned m_lfoResets;
+
+	//! The LFO shape of the current period, shared by all notes. The first
+	//! note of a period claims and computes it, the others wait for it.
+	std::vector<sample_t> m_lfoShapeData;
+	std::atomic<long> m_lfoShapePeriod;
+	std::atomic<long> m_lfoShapeClaimedPeriod;
+	sample_t m_random;
+
 	constexpr static auto NumLfoShapes = static_cast<std::size_t>(LfoShape::Count);
 
-	sample_t lfoShapeSample( fpp_t _frame_offset );
-	void updateLfoShapeData();
+	const sample_t* lfoShapeData(const Levels& levels);
+	void updateLfoShapeData(const Levels& levels);
 
 
 	friend class gui::EnvelopeAndLfoView;
@@ -1,5 +1,5 @@
 /*
- * FifoBuffer.h - FIFO fixed-size buffer
+ * FifoBuffer.h - FIFO of fixed-size period buffers
  *
  * Copyright (c) 2007 Javier Serrano Polo <jasp00/at/users.sourceforge.net>
  *
@@ -25,70 +25,134 @@
 #ifndef LMMS_FIFO_BUFFER_H
 #define LMMS_FIFO_BUFFER_H
 
-#include <QSemaphore>
+#include <atomic>
+#include <cstdint>
+#include <memory>
+
+#include "lmms_basics.h"
+#include "SampleFrame.h"
 
 
 namespace lmms
 {
 
 
-template<typename T>
+//! Single-producer single-consumer ring of preallocated period buffers.
+//! The producer renders into a slot and publishes it, the consumer reads
+//! the slot in place and hands it back afterwards, so no buffers are
+//! allocated or copied while processing.
 class FifoBuffer
 {
 public:
-	FifoBuffer(int size) :
-		m_readSem(size),
-		m_writeSem(size),
+	FifoBuffer(int size, fpp_t frames) :
+		m_size(size),
+		m_frames(frames),
+		m_buffers(std::make_unique<SampleFrame[]>(size * frames)),
+		m_endOfStream(std::make_unique<bool[]>(size)),
 		m_readIndex(0),
-		m_writeIndex(0),
-		m_size(size)
+		m_writeIndex(0)
 	{
-		m_buffer = new T[size];
-		m_readSem.acquire(size);
 	}
 
-	~FifoBuffer()
+	//! Wait until a slot is free and return it for writing
+	SampleFrame* beginWrite()
 	{
-		delete[] m_buffer;
-		m_readSem.release(m_size);
+		const auto w = m_writeIndex.load(std::memory_order_relaxed);
+		for (auto r = m_readIndex.load(std::memory_order_acquire); distance(r, w) == m_size;
+			r = m_readIndex.load(std::memory_order_acquire))
+		{
+			m_readIndex.wait(r, std::memory_order_acquire);
+		}
+		m_endOfStream[w % m_size] = false;
+		return slot(w);
 	}
 
-	void write(T element)
+	//! Publish the slot returned by beginWrite()
+	void endWrite()
 	{
-		m_writeSem.acquire();
-		m_buffer[m_writeIndex++] = element;
-		m_writeIndex %= m_size;
-		m_readSem.release();
+		// we are the only writer of m_writeIndex
+		m_writeIndex.store(next(m_writeIndex.load(std::memory_order_relaxed)), std::memory_order_release);
+		m_writeIndex.notify_one();
 	}
 
-	T read()
+	//! Let the consumer know no more buffers will follow
+	void writeEndOfStream()
 	{
-		m_readSem.acquire();
-		T element = m_buffer[m_readIndex++];
-		m_readIndex %= m_size;
-		m_writeSem.release();
-		return element;
+		beginWrite();
+		m_endOfStream[m_writeIndex.load(std::memory_order_relaxed) % m_size] = true;
+		endWrite();
 	}
 
+	//! Wait for the next buffer and return it. It stays valid until
+	//! endRead() is called. Returns nullptr at the end of the stream.
+	const SampleFrame* beginRead()
+	{
+		const auto r = m_readIndex.load(std::memory_order_relaxed);
+		for (auto w = m_writeIndex.load(std::memory_order_acquire); w == r;
+			w = m_writeIndex.load(std::memory_order_acquire))
+		{
+			m_writeIndex.wait(w, std::memory_order_acquire);
+		}
+		if (m_endOfStream[r % m_size])
+		{
+			// the end of stream marker has no buffer to hand back
+			endRead();
+			return nullptr;
+		}
+		return slot(r);
+	}
+
+	//! Hand the buffer returned by beginRead() back to the producer
+	void endRead()
+	{
+		// we are the only writer of m_readIndex
+		m_readIndex.store(next(m_readIndex.load(std::memory_order_relaxed)), std::memory_order_release);
+		m_readIndex.notify_one();
+	}
+
+	//! Wait until the consumer has read all published buffers
 	void waitUntilRead()
 	{
-		m_writeSem.acquire(m_size);
-		m_writeSem.release(m_size);
+		const auto w = m_writeIndex.load(std::memory_order_relaxed);
+		for (auto r = m_readIndex.load(std::memory_order_acquire); r != w;
+			r = m_readIndex.load(std::memory_order_acquire))
+		{
+			m_readIndex.wait(r, std::memory_order_acquire);
+		}
 	}
 
-	bool available()
+	bool available() const
 	{
-		return m_readSem.available();
+		return m_writeIndex.load(std::memory_order_acquire) != m_readIndex.load(std::memory_order_acquire);
 	}
 
 
 private:
-	QSemaphore m_readSem;
-	QSemaphore m_writeSem;
-	int m_readIndex;
-	int m_writeIndex;
-	int m_size;
-	T * m_buffer;
+	// indices run from 0 to 2 * m_size - 1, which allows to tell a full ring
+	// from an empty one
+	std::uint32_t next(std::uint32_t index) const
+	{
+		return (index + 1) % (2 * m_size);
+	}
+
+	std::uint32_t distance(std::uint32_t from, std::uint32_t to) const
+	{
+		return (to + 2 * m_size - from) % (2 * m_size);
+	}
+
+	SampleFrame* slot(std::uint32_t index)
+	{
+		return m_buffers.get() + (index % m_size) * m_frames;
+	}
+
+	const std::uint32_t m_size;
+	const fpp_t m_frames;
+	std::unique_ptr<SampleFrame[]> m_buffers;
+	std::unique_ptr<bool[]> m_endOfStream;
+
+	// the slot of an index is the index modulo m_size
+	alignas(64) std::atomic<std::uint32_t> m_readIndex;
+	alignas(64) std::atomic<std::uint32_t> m_writeIndex;
 } ;
 
 
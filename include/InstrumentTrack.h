@@ -154,6 +154,18 @@ public:
 		return &m_midiPort;
 	}
 
+	//! Time spent processing this track's play-handles and its audio port
+	//! including the effects
+	CpuTimeCounter& cpuTime()
+	{
+		return m_cpuTime;
+	}
+
+	const CpuTimeCounter& cpuTime() const
+	{
+		return m_cpuTime;
+	}
+
 	const IntModel *baseNoteModel() const
 	{
 		return &m_baseNoteModel;
@@ -294,6 +306,7 @@ private:
 	FloatModel m_panningModel;
 
 	AudioPort m_audioPort;
+	CpuTimeCounter m_cpuTime;
 
 	FloatModel m_pitchModel;
 	IntModel m_pitchRangeModel;
@@ -29,6 +29,11 @@
 
 #include <ladspa.h>
 
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <vector>
+
 #include <QMap>
 #include <QPair>
 #include <QString>
@@ -38,6 +43,7 @@
 #include "lmms_export.h"
 #include "lmms_basics.h"
 
+class QFileInfo;
 
 namespace lmms
 {
@@ -53,6 +59,8 @@ using l_ladspa_key_t = QList<ladspa_key_t>;
 it loads all of the plug-ins found in the LADSPA_PATH environmental variable
 and stores their access descriptors according in a dictionary keyed on
 the filename the plug-in was loaded from and the label of the plug-in.
+Libraries that did not change since they were recorded in the plug-in catalog
+are only loaded when one of their plug-ins is instantiated.
 
 The can be retrieved by using ladspa_key_t.  For example, to get the
 "Phase Modulated Voice" plug-in from the cmt library, you would perform the
@@ -72,13 +80,21 @@ enum class LadspaPluginType
 	Other
 };
 
+struct LadspaCatalogEntry;
+using LadspaCatalogEntries = std::vector<std::shared_ptr<const LadspaCatalogEntry>>;
+
 struct LadspaManagerDescription
 {
-	LADSPA_Descriptor_Function descriptorFunction;
+	//! Resolved when the library is loaded, which is deferred to the first
+	//! use if the plugin was found in the catalog
+	std::atomic<LADSPA_Descriptor_Function> descriptorFunction = nullptr;
 	uint32_t index;
 	LadspaPluginType type;
 	uint16_t inputChannels;
 	uint16_t outputChannels;
+	QString library;
+	//! The names, ports and hints of the plugin, which can be queried without loading it
+	std::shared_ptr<const LadspaCatalogEntry> catalogEntry;
 };
 
 class LMMS_EXPORT LadspaManager
@@ -330,8 +346,12 @@ public:
 						LADSPA_Handle _instance );
 
 private:
-	void  addPlugins( LADSPA_Descriptor_Function _descriptor_func,
-						const QString & _file );
+	void  addPlugins( const LadspaCatalogEntries & _plugins, const QFileInfo & _file,
+						LADSPA_Descriptor_Function _descriptor_func );
+	//! Loads the library of \a _plugin if it was not loaded yet
+	LADSPA_Descriptor_Function loadDescriptorFunction( LadspaManagerDescription & _plugin );
+	//! Descriptor with the catalog data of \a _plugin, whose function pointers are null
+	const LADSPA_Descriptor * getCatalogDescriptor( const ladspa_key_t & _plugin );
 	uint16_t  getPluginInputs( const LADSPA_Descriptor * _descriptor );
 	uint16_t  getPluginOutputs( const LADSPA_Descriptor * _descriptor );
 
@@ -343,6 +363,7 @@ private:
 	using LadspaManagerMapType = QMap<ladspa_key_t, LadspaManagerDescription*>;
 	LadspaManagerMapType m_ladspaManagerMap;
 	l_sortable_plugin_t m_sortedPlugins;
+	std::mutex m_loadMutex;
 
 } ;
 
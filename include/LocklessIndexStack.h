@@ -0,0 +1,113 @@
+/*
+ * LocklessIndexStack.h - lock-free LIFO of slot indices
+ *
+ * This file is part of LMMS - https://lmms.io
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this program (see COPYING); if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301 USA.
+ *
+ */
+
+#ifndef LMMS_LOCKLESS_INDEX_STACK_H
+#define LMMS_LOCKLESS_INDEX_STACK_H
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+namespace lmms
+{
+
+/**
+	A Treiber stack of indices in the range [0, capacity), meant to be used as
+	the free list of an object pool whose slots are addressed by index.
+
+	The head is a tagged index: the lower 32 bits hold the index of the top
+	element plus one (0 means empty), the upper 32 bits hold a counter which
+	is incremented on every modification to prevent the ABA problem. All
+	storage is allocated in the constructor, so push() and pop() are wait-free
+	with respect to the allocator and may be called from any thread.
+*/
+class LocklessIndexStack
+{
+public:
+	static constexpr std::uint32_t Empty = ~std::uint32_t{0};
+
+	explicit LocklessIndexStack(std::size_t capacity) :
+		m_head(0),
+		m_size(0),
+		m_capacity(capacity),
+		m_next(std::make_unique<std::atomic<std::uint32_t>[]>(capacity))
+	{
+		std::fill(m_next.get(), m_next.get() + capacity, 0);
+	}
+
+	std::size_t capacity() const { return m_capacity; }
+
+	//! Number of indices on the stack. Only a snapshot when used concurrently.
+	std::size_t size() const { return m_size.load(std::memory_order_relaxed); }
+
+	//! Push @p index, which must be < capacity() and not already on the stack
+	void push(std::uint32_t index)
+	{
+		// account for the index before publishing it, so size() never
+		// underflows when the index gets popped right away
+		m_size.fetch_add(1, std::memory_order_relaxed);
+
+		auto head = m_head.load(std::memory_order_relaxed);
+		std::uint64_t newHead;
+		do
+		{
+			m_next[index].store(static_cast<std::uint32_t>(head), std::memory_order_relaxed);
+			newHead = nextTag(head) | (index + 1);
+		}
+		while (!m_head.compare_exchange_weak(head, newHead,
+				std::memory_order_release, std::memory_order_relaxed));
+	}
+
+	//! Pop the most recently pushed index, or return Empty
+	std::uint32_t pop()
+	{
+		auto head = m_head.load(std::memory_order_acquire);
+		std::uint64_t newHead;
+		do
+		{
+			const auto top = static_cast<std::uint32_t>(head);
+			if (top == 0) { return Empty; }
+			newHead = nextTag(head) | m_next[top - 1].load(std::memory_order_relaxed);
+		}
+		while (!m_head.compare_exchange_weak(head, newHead,
+				std::memory_order_acquire, std::memory_order_acquire));
+		m_size.fetch_sub(1, std::memory_order_relaxed);
+		return static_cast<std::uint32_t>(head) - 1;
+	}
+
+private:
+	static std::uint64_t nextTag(std::uint64_t head)
+	{
+		return ((head >> 32) + 1) << 32;
+	}
+
+	std::atomic<std::uint64_t> m_head;
+	std::atomic<std::size_t> m_size;
+	const std::size_t m_capacity;
+	std::unique_ptr<std::atomic<std::uint32_t>[]> m_next;
+} ;
+
+} // namespace lmms
+
+#endif // LMMS_LOCKLESS_INDEX_STACK_H
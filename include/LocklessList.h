@@ -67,6 +67,26 @@ public:
 		}
 	}
 
+	//! Like push(), but returns false instead of pushing if the list is full
+	bool tryPush( T value )
+	{
+		Element * e = m_allocator->alloc();
+		if( e == nullptr )
+		{
+			return false;
+		}
+		e->value = value;
+		e->next = m_first.load(std::memory_order_relaxed);
+
+		while (!m_first.compare_exchange_weak(e->next, e,
+				std::memory_order_release,
+				std::memory_order_relaxed))
+		{
+			// Empty loop (compare_exchange_weak updates e->next)
+		}
+		return true;
+	}
+
 	Element * popList()
 	{
 		return m_first.exchange(nullptr);
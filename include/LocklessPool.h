@@ -0,0 +1,133 @@
+/*
+ * LocklessPool.h - growable object pool with lockless alloc and free
+ *
+ * This file is part of LMMS - https://lmms.io
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this program (see COPYING); if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301 USA.
+ *
+ */
+
+#ifndef LMMS_LOCKLESS_POOL_H
+#define LMMS_LOCKLESS_POOL_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <thread>
+
+#include "LocklessIndexStack.h"
+#include "lmms_export.h"
+
+namespace lmms
+{
+
+class Semaphore;
+
+/**
+	Pool of cache-line aligned memory blocks of a fixed size.
+
+	alloc() and free() are lock-free and don't touch the system allocator as
+	long as the pool has free blocks. When the number of free blocks drops
+	below the refill watermark, alloc() wakes a background thread which adds
+	more blocks, so the pool grows ahead of demand without allocating in the
+	calling (usually the audio) thread. Only when the pool is completely
+	exhausted, alloc() has to allocate a block itself.
+*/
+class LMMS_EXPORT LocklessPool
+{
+public:
+	struct Statistics
+	{
+		std::size_t capacity;      //!< number of blocks owned by the pool
+		std::size_t inUse;         //!< number of blocks currently allocated
+		std::size_t highWaterMark; //!< maximum of inUse since the last reset
+		std::size_t poolMisses;    //!< allocations that had to hit the system allocator
+	};
+
+	LocklessPool(std::size_t blockSize, std::uint32_t initialBlocks,
+		std::uint32_t refillWatermark, std::uint32_t refillStep,
+		std::uint32_t maxBlocks);
+	virtual ~LocklessPool();
+
+	void* alloc();
+	void free(void* ptr);
+
+	Statistics statistics() const;
+	void resetHighWaterMark();
+
+private:
+	void grow(std::uint32_t count);
+	std::uint32_t claimSlot();
+	void* allocateBlock(std::uint32_t slot) const;
+	static void freeBlock(void* ptr);
+	void refillLoop();
+
+	const std::size_t m_blockSize;
+	const std::uint32_t m_refillWatermark;
+	const std::uint32_t m_refillStep;
+	const std::uint32_t m_maxBlocks;
+
+	LocklessIndexStack m_freeSlots;
+	std::unique_ptr<void*[]> m_slots;
+	std::atomic<std::uint32_t> m_numSlots;
+
+	std::atomic<std::size_t> m_inUse;
+	std::atomic<std::size_t> m_highWaterMark;
+	std::atomic<std::size_t> m_poolMisses;
+
+	std::atomic<bool> m_refillRequested;
+	std::unique_ptr<Semaphore> m_refillSemaphore;
+	std::atomic<bool> m_quit;
+	std::thread m_refillThread;
+} ;
+
+
+
+
+template<typename T>
+class LocklessPoolT : private LocklessPool
+{
+public:
+	LocklessPoolT(std::uint32_t initialBlocks, std::uint32_t refillWatermark,
+			std::uint32_t refillStep, std::uint32_t maxBlocks) :
+		LocklessPool(sizeof(T), initialBlocks, refillWatermark, refillStep, maxBlocks)
+	{
+		static_assert(alignof(T) <= 64, "LocklessPool blocks are aligned to 64 bytes");
+	}
+
+	~LocklessPoolT() override = default;
+
+	//! Returns uninitialized storage for one T
+	T* alloc()
+	{
+		return static_cast<T*>(LocklessPool::alloc());
+	}
+
+	void free(T* ptr)
+	{
+		LocklessPool::free(ptr);
+	}
+
+	using LocklessPool::Statistics;
+	using LocklessPool::statistics;
+	using LocklessPool::resetHighWaterMark;
+} ;
+
+
+} // namespace lmms
+
+#endif // LMMS_LOCKLESS_POOL_H
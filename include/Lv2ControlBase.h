@@ -42,6 +42,7 @@ namespace lmms
 
 
 class Lv2Proc;
+class PlanarBuffer;
 class PluginIssue;
 class SampleFrame;
 
@@ -122,6 +123,9 @@ protected:
 	void copyBuffersFromLmms(const SampleFrame* buf, fpp_t frames);
 	//! Copy our ports into buffers passed by LMMS
 	void copyBuffersToLmms(SampleFrame* buf, fpp_t frames) const;
+	//! Same as above for planar buffers
+	void copyBuffersFromLmms(const PlanarBuffer& buf, fpp_t frames);
+	void copyBuffersToLmms(PlanarBuffer& buf, fpp_t frames) const;
 	//! Run the Lv2 plugin instance for @param frames frames
 	void run(fpp_t frames);
 
@@ -96,19 +96,23 @@ public:
 		//! use only for std::map internals
 		Lv2Info() : m_plugin(nullptr) {}
 		//! ctor used inside Lv2Manager
-		Lv2Info(const LilvPlugin* plug, Plugin::Type type, bool valid) :
-			m_plugin(plug), m_type(type), m_valid(valid) {}
+		Lv2Info(const LilvPlugin* plug, Plugin::Type type, bool valid, QString name) :
+			m_plugin(plug), m_type(type), m_valid(valid), m_name(std::move(name)) {}
 		Lv2Info(Lv2Info&& other) = default;
 		Lv2Info& operator=(Lv2Info&& other) = default;
 
 		const LilvPlugin* plugin() const { return m_plugin; }
 		Plugin::Type type() const { return m_type; }
 		bool isValid() const { return m_valid; }
+		//! Plugin name, read without making lilv parse the plugin's data
+		//! (empty for invalid plugins)
+		const QString& name() const { return m_name; }
 
 	private:
 		const LilvPlugin* m_plugin;
 		Plugin::Type m_type;
 		bool m_valid = false;
+		QString m_name;
 	};
 
 	//! Return descriptor with URI @p uri or nullptr if none exists
@@ -41,6 +41,7 @@
 namespace lmms
 {
 
+class PlanarBuffer;
 class SampleFrame;
 
 struct ConnectPortVisitor;
@@ -196,6 +197,14 @@ struct Audio : public VisitablePort<Audio, PortBase>
 	void copyBuffersToCore(SampleFrame* lmmsBuf,
 		unsigned channel, fpp_t frames) const;
 
+	//! Same as above for planar buffers, @param channel channel of @p lmmsBuf
+	void copyBuffersFromCore(const PlanarBuffer& lmmsBuf,
+		unsigned channel, fpp_t frames);
+	void averageWithBuffersFromCore(const PlanarBuffer& lmmsBuf,
+		unsigned channel, fpp_t frames);
+	void copyBuffersToCore(PlanarBuffer& lmmsBuf,
+		unsigned channel, fpp_t frames) const;
+
 	bool isSideChain() const { return m_sidechain; }
 	bool isOptional() const { return m_optional; }
 	bool mustBeUsed() const { return !isSideChain() && !isOptional(); }
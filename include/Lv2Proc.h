@@ -48,6 +48,7 @@
 namespace lmms
 {
 
+class PlanarBuffer;
 class PluginIssue;
 class SampleFrame;
 
@@ -150,6 +151,11 @@ public:
 	 */
 	void copyBuffersToCore(SampleFrame* buf, unsigned firstChan, unsigned num,
 								fpp_t frames) const;
+	//! Same as above for planar buffers, @p firstChan being a channel of @p buf
+	void copyBuffersFromCore(const PlanarBuffer& buf,
+								unsigned firstChan, unsigned num, fpp_t frames);
+	void copyBuffersToCore(PlanarBuffer& buf, unsigned firstChan, unsigned num,
+								fpp_t frames) const;
 	//! Run the Lv2 plugin instance for @param frames frames
 	void run(fpp_t frames);
 
@@ -0,0 +1,101 @@
+/*
+ * MappedCache.h - precomputed data cached on disk and memory-mapped read-only
+ *
+ * This file is part of LMMS - https://lmms.io
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this program (see COPYING); if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301 USA.
+ *
+ */
+
+#ifndef LMMS_MAPPED_CACHE_H
+#define LMMS_MAPPED_CACHE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+
+#include "lmms_export.h"
+
+class QString;
+
+namespace lmms
+{
+
+/**
+	Fixed-size blobs of precomputed data, stored in ConfigManager::cacheDir()
+	and memory-mapped read-only.
+
+	A blob is generated once, stored, and mapped on later runs instead of being
+	regenerated. The pages are backed by the file, so concurrently running
+	instances on the same host share them.
+
+	Each file carries a version, the blob size and optionally the parameters
+	the blob was generated from, such as table sizes. A file that does not
+	match all of them is ignored and overwritten by the next store(), so the
+	version must be bumped whenever the generator changes its output. Files are
+	written to a temporary file and renamed, so a reader never maps a partially
+	written file.
+*/
+class LMMS_EXPORT MappedCache
+{
+public:
+	//! Maps the cache file \a name if it holds \a size bytes of data with
+	//! the given \a version and the \a parametersSize bytes of \a parameters,
+	//! otherwise returns nullptr.
+	//! The mapping stays valid for the rest of the program's lifetime.
+	static const void* map(const QString& name, std::uint32_t version, std::size_t size,
+		const void* parameters = nullptr, std::size_t parametersSize = 0);
+
+	//! Writes \a size bytes from \a data and the parameters they were generated
+	//! from to the cache file \a name. Returns false if the file could not be written.
+	static bool store(const QString& name, std::uint32_t version, const void* data, std::size_t size,
+		const void* parameters = nullptr, std::size_t parametersSize = 0);
+
+	template<typename T>
+	static const T* map(const QString& name, std::uint32_t version)
+	{
+		static_assert(std::is_trivially_copyable_v<T>);
+		return static_cast<const T*>(map(name, version, sizeof(T)));
+	}
+
+	//! \a parameters are compared byte by byte, so they must not contain padding
+	template<typename T, typename Parameters>
+	static const T* map(const QString& name, std::uint32_t version, const Parameters& parameters)
+	{
+		static_assert(std::is_trivially_copyable_v<T>);
+		static_assert(std::has_unique_object_representations_v<Parameters>);
+		return static_cast<const T*>(map(name, version, sizeof(T), &parameters, sizeof(Parameters)));
+	}
+
+	template<typename T>
+	static bool store(const QString& name, std::uint32_t version, const T& data)
+	{
+		static_assert(std::is_trivially_copyable_v<T>);
+		return store(name, version, &data, sizeof(T));
+	}
+
+	template<typename T, typename Parameters>
+	static bool store(const QString& name, std::uint32_t version, const T& data, const Parameters& parameters)
+	{
+		static_assert(std::is_trivially_copyable_v<T>);
+		static_assert(std::has_unique_object_representations_v<Parameters>);
+		return store(name, version, &data, sizeof(T), &parameters, sizeof(Parameters));
+	}
+};
+
+} // namespace lmms
+
+#endif // LMMS_MAPPED_CACHE_H
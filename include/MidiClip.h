@@ -76,6 +76,12 @@ public:
 		return m_notes;
 	}
 
+	//! Returns the first note not starting before @p pos. Meant for the
+	//! audio thread while holding the lock of the instrument track. Calls
+	//! with increasing positions continue from the previous result, so
+	//! playing a clip does not search the notes on every tick.
+	NoteVector::const_iterator firstNoteFrom(const TimePos& pos) const;
+
 	Note * addStepNote( int step );
 	void setStep( int step, bool enabled );
 
@@ -143,6 +149,9 @@ private:
 	NoteVector m_notes;
 	int m_steps;
 
+	//! Index of the last result of firstNoteFrom()
+	mutable std::size_t m_playCursor = 0;
+
 	MidiClip * adjacentMidiClipByOffset(int offset) const;
 
 	friend class gui::MidiClipView;
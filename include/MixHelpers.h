@@ -32,10 +32,33 @@ namespace lmms
 
 class ValueBuffer;
 class SampleFrame;
+class PlanarBuffer;
 
 namespace MixHelpers
 {
 
+//! Instruction sets the mixing functions can be run with
+enum class SimdLevel
+{
+	None,
+	Sse2,
+	Avx2,
+	Avx512
+};
+
+//! The best instruction set supported by both this build and the CPU
+SimdLevel supportedSimdLevel();
+
+//! The instruction set currently used, supportedSimdLevel() by default
+SimdLevel simdLevel();
+
+/*! \brief Use at most the instruction set @p level
+ *
+ * Not thread-safe, must not be called while the audio engine is running.
+ * Meant for tests and benchmarks comparing the implementations.
+ */
+void setSimdLevel( SimdLevel level );
+
 bool isSilent( const SampleFrame* src, int frames );
 
 bool useNaNHandler();
@@ -44,6 +67,9 @@ void setNaNHandler( bool use );
 
 bool sanitize( SampleFrame* src, int frames );
 
+/*! \brief Same as sanitize(), for the first @p frames frames of all channels of @p buf */
+bool sanitize( PlanarBuffer& buf, int frames );
+
 /*! \brief Add samples from src to dst */
 void add( SampleFrame* dst, const SampleFrame* src, int frames );
 
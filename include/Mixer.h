@@ -28,9 +28,9 @@
 #include "Model.h"
 #include "EffectChain.h"
 #include "JournallingObject.h"
+#include "RcuSnapshot.h"
 #include "ThreadableJob.h"
 
-#include <atomic>
 #include <optional>
 #include <QColor>
 
@@ -64,8 +64,7 @@ class MixerChannel : public ThreadableJob
 		QString m_name;
 		QMutex m_lock;
 		int m_channelIndex; // what channel index are we
-		bool m_queued; // are we queued up for rendering yet?
-		bool m_muted; // are we muted? updated per period so we don't have to call m_muteModel.value() twice
+		bool m_muted; // are we muted? sampled once per period so we don't have to call m_muteModel.value() twice
 
 		// pointers to other channels that this one sends to
 		MixerRouteVector m_sends;
@@ -73,19 +72,22 @@ class MixerChannel : public ThreadableJob
 		// pointers to other channels that send to this one
 		MixerRouteVector m_receives;
 
+		// time spent processing this channel including its effects
+		CpuTimeCounter m_cpuTime;
+
 		bool requiresProcessing() const override { return true; }
 		void unmuteForSolo();
 
 		auto color() const -> const std::optional<QColor>& { return m_color; }
 		void setColor(const std::optional<QColor>& color) { m_color = color; }
 
-		std::atomic_size_t m_dependenciesMet;
-		void incrementDeps();
-		void processed();
-		
 	private:
 		void doProcessing() override;
 
+		// number of senders not yet scheduled, only used while
+		// compiling the routing plan
+		std::size_t m_unscheduledReceives;
+
 		std::optional<QColor> m_color;
 };
 
@@ -216,6 +218,27 @@ private:
 	// make sure we have at least num channels
 	void allocateChannelsTo(int num);
 
+	struct RoutingPlan
+	{
+		// all channels by index, 0 is master
+		std::vector<MixerChannel*> channels;
+		// all channels in processing order
+		std::vector<MixerChannel*> order;
+		// order[levels[i]] is the first channel of level i,
+		// the last element marks the end of the plan
+		std::vector<std::size_t> levels;
+	} ;
+
+	// publish a new routing plan after channels or routes have changed.
+	// the audio thread keeps using the previous one until the next period
+	void updateRoutingPlan();
+
+	// sort all channels topologically into levels, so that every
+	// channel only depends on channels of previous levels
+	void compileRoutingPlan(RoutingPlan& plan);
+
+	RcuSnapshot<RoutingPlan> m_routingPlan;
+
 	int m_lastSoloed;
 } ;
 
@@ -29,12 +29,11 @@
 #include <memory>
 
 #include "BasicFilters.h"
+#include "LocklessPool.h"
 #include "Note.h"
 #include "PlayHandle.h"
 #include "Track.h"
 
-class QReadWriteLock;
-
 namespace lmms
 {
 
@@ -334,8 +333,11 @@ private:
 
 
 const int INITIAL_NPH_CACHE = 256;
-const int NPH_CACHE_INCREMENT = 16;
+const int NPH_CACHE_INCREMENT = 64;
+const int NPH_CACHE_WATERMARK = 32;
+const int MAX_NPH_CACHE = 16384;
 
+//! Real-time safe allocation of NotePlayHandles, see LocklessPool
 class NotePlayHandleManager
 {
 public:
@@ -348,14 +350,12 @@ public:
 					int midiEventChannel = -1,
 					NotePlayHandle::Origin origin = NotePlayHandle::Origin::MidiClip );
 	static void release( NotePlayHandle * nph );
-	static void extend( int i );
 	static void free();
 
+	static LocklessPool::Statistics statistics();
+
 private:
-	static NotePlayHandle ** s_available;
-	static QReadWriteLock s_mutex;
-	static std::atomic_int s_availableIndex;
-	static int s_size;
+	static LocklessPoolT<NotePlayHandle> * s_pool;
 };
 
 
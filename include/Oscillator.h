@@ -84,10 +84,14 @@ public:
 			const float &detuning_div_samplerate,
 			const float &phase_offset,
 			const float &volume,
-			Oscillator *m_subOsc = nullptr);
+			Oscillator *m_subOsc = nullptr,
+			bool ownsSubOsc = true);
 	virtual ~Oscillator()
 	{
-		delete m_subOsc;
+		if (m_ownsSubOsc)
+		{
+			delete m_subOsc;
+		}
 	}
 
 	static void waveTableInit();
@@ -222,6 +226,13 @@ public:
 				table[control.band][control.f2], fraction(control.frame));
 	}
 
+	//! The band-limited tables of \a shape, which must have a pre-generated table,
+	//! see FirstWaveShapeTable. Only valid after waveTableInit()
+	static const OscillatorConstants::waveform_t& waveTable(WaveShape shape)
+	{
+		return (*s_waveTables)[static_cast<std::size_t>(shape) - FirstWaveShapeTable];
+	}
+
 	static inline int waveTableBandFromFreq(float freq)
 	{
 		// Frequency bands are indexed relative to default MIDI key frequencies.
@@ -248,6 +259,8 @@ private:
 	const float & m_volume;
 	const float & m_ext_phaseOffset;
 	Oscillator * m_subOsc;
+	//! False if the sub oscillator is stored by the caller, e.g. in a voice
+	bool m_ownsSubOsc;
 	float m_phaseOffset;
 	float m_phase;
 	std::shared_ptr<const SampleBuffer> m_userWave = SampleBuffer::emptyBuffer();
@@ -258,7 +271,10 @@ private:
 	bool m_isModulator;
 
 	/* Multiband WaveTable */
-	static sample_t s_waveTables[NumWaveShapeTables][OscillatorConstants::WAVE_TABLES_PER_WAVEFORM_COUNT][OscillatorConstants::WAVETABLE_LENGTH];
+	using WaveTables = std::array<OscillatorConstants::waveform_t, NumWaveShapeTables>;
+	//! Mapped from the MappedCache, or s_generatedWaveTables if the cache could not be used
+	static const WaveTables* s_waveTables;
+	static std::unique_ptr<WaveTables> s_generatedWaveTables;
 	static fftwf_plan s_fftPlan;
 	static fftwf_plan s_ifftPlan;
 	static fftwf_complex * s_specBuf;
@@ -268,7 +284,7 @@ private:
 	static void generateTriangleWaveTable(int bands, sample_t* table, int firstBand = 1);
 	static void generateSquareWaveTable(int bands, sample_t* table, int firstBand = 1);
 	static void generateFromFFT(int bands, sample_t* table);
-	static void generateWaveTables();
+	static void generateWaveTables(WaveTables& tables);
 	static void createFFTPlans();
 
 	/* End Multiband wavetable */
@@ -310,8 +326,19 @@ private:
 	void updateFM( SampleFrame* _ab, const fpp_t _frames,
 							const ch_cnt_t _chnl );
 
+	//! Frames rendered at once. The phases of a block are computed first,
+	//! then its samples in loops without dependencies between the frames.
+	static constexpr fpp_t BlockSize = 64;
+
+	template<WaveShape W, typename NextPhase, typename Mix>
+	void renderBlocks(SampleFrame* ab, fpp_t frames, ch_cnt_t chnl,
+		NextPhase nextPhase, Mix mix);
+
 	template<WaveShape W>
-	inline sample_t getSample( const float _sample );
+	void getSamples(const float* phases, sample_t* samples, fpp_t count);
+
+	static void wtSamples(const sample_t* bandTable, const float* phases,
+		sample_t* samples, fpp_t count);
 
 	inline void recalcPhase();
 
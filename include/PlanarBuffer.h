@@ -0,0 +1,119 @@
+/*
+ * PlanarBuffer.h - audio buffer storing each channel contiguously
+ *
+ * This file is part of LMMS - https://lmms.io
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this program (see COPYING); if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301 USA.
+ *
+ */
+
+#ifndef LMMS_PLANAR_BUFFER_H
+#define LMMS_PLANAR_BUFFER_H
+
+#include <algorithm>
+#include <array>
+#include <cassert>
+#include <vector>
+
+#include "lmms_basics.h"
+#include "SampleFrame.h"
+
+namespace lmms
+{
+
+/**
+	A buffer of DEFAULT_CHANNELS channels of up to capacity() samples each,
+	where the samples of every channel are stored one after another (planar,
+	or "structure of arrays"), as opposed to the interleaved SampleFrame
+	arrays used for the buses of the engine.
+
+	Most plugin APIs expect planar buffers, and loops over a single channel
+	can be vectorized. The storage is allocated in the constructor only, so
+	a PlanarBuffer can be used on the audio thread.
+*/
+class PlanarBuffer
+{
+public:
+	explicit PlanarBuffer(fpp_t capacity = 0) :
+		m_capacity(capacity),
+		// start every channel on a cache line, relative to the first one
+		m_stride((capacity + 15) / 16 * 16),
+		m_samples(m_stride * DEFAULT_CHANNELS)
+	{
+		for (ch_cnt_t ch = 0; ch < DEFAULT_CHANNELS; ++ch)
+		{
+			m_channels[ch] = m_samples.data() + ch * m_stride;
+		}
+	}
+
+	PlanarBuffer(const PlanarBuffer&) = delete;
+	PlanarBuffer& operator=(const PlanarBuffer&) = delete;
+
+	fpp_t capacity() const { return m_capacity; }
+
+	sample_t* channel(ch_cnt_t ch) { return m_channels[ch]; }
+	const sample_t* channel(ch_cnt_t ch) const { return m_channels[ch]; }
+
+	//! The channel pointers, as passed to plugin APIs taking `float**`
+	sample_t* const* channels() { return m_channels.data(); }
+
+	//! Copy @p frames frames from the interleaved buffer @p src
+	void deinterleave(const SampleFrame* src, fpp_t frames)
+	{
+		assert(frames <= m_capacity);
+		for (ch_cnt_t ch = 0; ch < DEFAULT_CHANNELS; ++ch)
+		{
+			sample_t* dst = m_channels[ch];
+			for (fpp_t f = 0; f < frames; ++f)
+			{
+				dst[f] = src[f][ch];
+			}
+		}
+	}
+
+	//! Copy the first @p frames frames to the interleaved buffer @p dst
+	void interleave(SampleFrame* dst, fpp_t frames) const
+	{
+		assert(frames <= m_capacity);
+		for (ch_cnt_t ch = 0; ch < DEFAULT_CHANNELS; ++ch)
+		{
+			const sample_t* src = m_channels[ch];
+			for (fpp_t f = 0; f < frames; ++f)
+			{
+				dst[f][ch] = src[f];
+			}
+		}
+	}
+
+	void zero(fpp_t frames)
+	{
+		assert(frames <= m_capacity);
+		for (ch_cnt_t ch = 0; ch < DEFAULT_CHANNELS; ++ch)
+		{
+			std::fill_n(m_channels[ch], frames, sample_t{0});
+		}
+	}
+
+private:
+	fpp_t m_capacity;
+	fpp_t m_stride;
+	std::vector<sample_t> m_samples;
+	std::array<sample_t*, DEFAULT_CHANNELS> m_channels;
+} ;
+
+} // namespace lmms
+
+#endif // LMMS_PLANAR_BUFFER_H
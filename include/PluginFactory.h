@@ -58,7 +58,7 @@ public:
 	using DescriptorMap = QMultiMap<Plugin::Type, Plugin::Descriptor*>;
 
 	PluginFactory();
-	~PluginFactory() = default;
+	~PluginFactory();
 
 	static void setupSearchPaths();
 
@@ -92,14 +92,21 @@ public:
 	QString errorString(QString pluginName) const;
 
 public slots:
+	/// Registers the plugins in all plugin search paths. Libraries that are
+	/// unchanged since they were recorded in the plugin manifest are registered
+	/// from it without loading them; they are loaded once they are instantiated.
 	void discoverPlugins();
 
 private:
+	//! Descriptor of a plugin registered from the manifest
+	struct CachedPlugin;
+
 	DescriptorMap m_descriptors;
 	PluginInfoList m_pluginInfos;
 
 	QMap<QString, PluginInfoAndKey> m_pluginByExt;
 	std::vector<std::string> m_garbage; //!< cleaned up at destruction
+	std::vector<std::unique_ptr<CachedPlugin>> m_cachedPlugins; //!< cleaned up at destruction
 
 	QHash<QString, QString> m_errors;
 
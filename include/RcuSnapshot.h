@@ -0,0 +1,185 @@
+/*
+ * RcuSnapshot.h - versioned snapshots which are read without locking
+ *
+ * This file is part of LMMS - https://lmms.io
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this program (see COPYING); if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301 USA.
+ *
+ */
+
+#ifndef LMMS_RCU_SNAPSHOT_H
+#define LMMS_RCU_SNAPSHOT_H
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace lmms
+{
+
+/**
+	Tracks the read sections of a single reader thread, e.g. the periods
+	rendered by the audio engine, so writers know when a replaced snapshot
+	is not referenced anymore (read-copy-update).
+
+	Read sections must not overlap, i.e. there must be at most one reader at
+	a time. Between two read sections the reader must not keep references to
+	any snapshot.
+*/
+class RcuDomain
+{
+public:
+	void beginRead()
+	{
+		// sequentially consistent, so either the writer sees this read
+		// section in stamp() or the reader sees the new snapshot
+		m_started.fetch_add(1, std::memory_order_seq_cst);
+	}
+
+	void endRead()
+	{
+		m_finished.fetch_add(1, std::memory_order_release);
+		m_finished.notify_all();
+	}
+
+	//! Identifies the newest read section which might still see a snapshot
+	//! replaced before this call
+	std::uint64_t stamp() const
+	{
+		return m_started.load(std::memory_order_seq_cst);
+	}
+
+	//! Whether the read section identified by @p stamp and all before are over
+	bool expired(std::uint64_t stamp) const
+	{
+		return m_finished.load(std::memory_order_acquire) >= stamp;
+	}
+
+	//! Wait until all read sections running at the time of the call are
+	//! over. Must not be called from within a read section.
+	void synchronize() const
+	{
+		const auto until = stamp();
+		auto finished = m_finished.load(std::memory_order_acquire);
+		while (finished < until)
+		{
+			m_finished.wait(finished, std::memory_order_acquire);
+			finished = m_finished.load(std::memory_order_acquire);
+		}
+	}
+
+private:
+	alignas(64) std::atomic<std::uint64_t> m_started = 0;
+	alignas(64) std::atomic<std::uint64_t> m_finished = 0;
+} ;
+
+
+
+
+/**
+	An immutable value of type T which can be replaced by writers at any time
+	while the reader of an RcuDomain keeps using the version it has read.
+
+	Writers copy the current version, modify the copy and publish it with a
+	single atomic store. Replaced versions are deleted by later writes as
+	soon as the read sections which could have seen them are over. Writers
+	are serialized by a mutex that is never touched by the reader.
+*/
+template<typename T>
+class RcuSnapshot
+{
+public:
+	explicit RcuSnapshot(const RcuDomain& domain, T initial = T{}) :
+		m_domain(domain),
+		m_current(new T(std::move(initial)))
+	{
+	}
+
+	~RcuSnapshot()
+	{
+		delete m_current.load(std::memory_order_relaxed);
+		for (const auto& retired : m_retired)
+		{
+			delete retired.version;
+		}
+	}
+
+	RcuSnapshot(const RcuSnapshot&) = delete;
+	RcuSnapshot& operator=(const RcuSnapshot&) = delete;
+
+	//! The current version. The reader may only use it during the read
+	//! section it was obtained in, writers until they publish a new one.
+	const T& read() const
+	{
+		return *m_current.load(std::memory_order_seq_cst);
+	}
+
+	//! Publish a copy of the current version modified by @p edit
+	template<typename Edit>
+	void update(Edit&& edit)
+	{
+		const auto lock = std::lock_guard{m_writeMutex};
+		auto next = std::make_unique<T>(*m_current.load(std::memory_order_relaxed));
+		edit(*next);
+		publish(std::move(next));
+	}
+
+	//! Publish @p next as the new version
+	void store(T next)
+	{
+		const auto lock = std::lock_guard{m_writeMutex};
+		publish(std::make_unique<T>(std::move(next)));
+	}
+
+	//! Number of replaced versions which have not been deleted yet
+	std::size_t retiredVersions() const
+	{
+		const auto lock = std::lock_guard{m_writeMutex};
+		return m_retired.size();
+	}
+
+private:
+	struct Retired
+	{
+		const T* version;
+		std::uint64_t stamp;
+	} ;
+
+	void publish(std::unique_ptr<T> next)
+	{
+		const T* old = m_current.exchange(next.release(), std::memory_order_seq_cst);
+
+		const auto expired = std::stable_partition(m_retired.begin(), m_retired.end(),
+			[this](const Retired& r) { return !m_domain.expired(r.stamp); });
+		std::for_each(expired, m_retired.end(), [](const Retired& r) { delete r.version; });
+		m_retired.erase(expired, m_retired.end());
+
+		m_retired.push_back({old, m_domain.stamp()});
+	}
+
+	const RcuDomain& m_domain;
+	std::atomic<const T*> m_current;
+	std::vector<Retired> m_retired;
+	mutable std::mutex m_writeMutex;
+} ;
+
+
+} // namespace lmms
+
+#endif // LMMS_RCU_SNAPSHOT_H
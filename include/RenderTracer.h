@@ -0,0 +1,114 @@
+/*
+ * RenderTracer.h - timeline of the render loop in Chrome trace format
+ *
+ * This file is part of LMMS - https://lmms.io
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this program (see COPYING); if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301 USA.
+ *
+ */
+
+#ifndef LMMS_RENDER_TRACER_H
+#define LMMS_RENDER_TRACER_H
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <typeinfo>
+
+#include "lmms_export.h"
+
+class QString;
+
+namespace lmms
+{
+
+/**
+	Records what every thread of the render loop does and when, so periods
+	can be inspected in a timeline viewer like chrome://tracing or Perfetto.
+
+	Events are written into a preallocated lock-free ring by the real-time
+	threads and formatted into a Chrome trace event JSON file by a separate
+	thread. If that thread falls behind, new events are dropped instead of
+	blocking. While tracing is inactive, recording costs a single relaxed
+	atomic load.
+
+	Names and categories of events are not copied, so they must be string
+	literals or otherwise outlive the tracer.
+*/
+class LMMS_EXPORT RenderTracer
+{
+public:
+	using Clock = std::chrono::steady_clock;
+
+	static constexpr std::size_t DefaultCapacity = 1 << 16;
+
+	//! Start recording into @p fileName. Fails if the file can't be opened
+	//! or tracing is already active.
+	static bool start(const QString& fileName, std::size_t capacity = DefaultCapacity);
+
+	//! Write all remaining events and close the file. Must not be called
+	//! while the render loop is running.
+	static void stop();
+
+	static bool isActive()
+	{
+		return s_active.load(std::memory_order_relaxed);
+	}
+
+	//! Label the calling thread in the timeline
+	static void setThreadName(const char* name);
+
+	static void record(const char* name, const char* category,
+		Clock::time_point begin, Clock::time_point end);
+
+	//! Record a job, which is labelled with the name of its dynamic type
+	static void recordJob(const std::type_info& type,
+		Clock::time_point begin, Clock::time_point end);
+
+	//! Records the time between its construction and destruction
+	class Scope
+	{
+	public:
+		Scope(const char* name, const char* category) :
+			m_name(name),
+			m_category(category),
+			m_active(isActive())
+		{
+			if (m_active) { m_begin = Clock::now(); }
+		}
+
+		~Scope()
+		{
+			if (m_active) { record(m_name, m_category, m_begin, Clock::now()); }
+		}
+
+		Scope(const Scope&) = delete;
+		Scope& operator=(const Scope&) = delete;
+
+	private:
+		const char* m_name;
+		const char* m_category;
+		const bool m_active;
+		Clock::time_point m_begin;
+	};
+
+private:
+	static std::atomic<bool> s_active;
+} ;
+
+} // namespace lmms
+
+#endif // LMMS_RENDER_TRACER_H
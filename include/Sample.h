@@ -27,12 +27,15 @@
 
 #include <cmath>
 #include <memory>
+#include <vector>
 
 #include "AudioResampler.h"
 #include "Note.h"
 #include "SampleBuffer.h"
 #include "lmms_export.h"
 
+class SampleTest;
+
 namespace lmms {
 class LMMS_EXPORT Sample
 {
@@ -70,9 +73,16 @@ public:
 
 	private:
 		AudioResampler m_resampler;
+		//! Raw frames fed to the resampler, reused so that playing does not allocate
+		std::vector<SampleFrame> m_playBuffer;
 		int m_frameIndex = 0;
 		bool m_varyingPitch = false;
 		bool m_backwards = false;
+		//! Set once the resampler was used, which then keeps being used since it buffers input
+		bool m_resampling = false;
+		//! Frames of a streamed buffer that were last requested from disk
+		std::size_t m_readAheadBegin = 0;
+		std::size_t m_readAheadEnd = 0;
 		friend class Sample;
 	};
 
@@ -118,7 +128,15 @@ public:
 
 private:
 	void playRaw(SampleFrame* dst, size_t numFrames, const PlaybackState* state, Loop loopMode) const;
+	void copyRaw(SampleFrame* dst, size_t numFrames, PlaybackState* state, Loop loopMode) const;
 	void advance(PlaybackState* state, size_t advanceAmount, Loop loopMode) const;
+	void readAhead(PlaybackState* state) const;
+
+	//! How far ahead frames of streamed buffers are loaded from disk
+	static constexpr std::size_t s_readAheadSeconds = 2;
+
+	//! Compares copyRaw() to playRaw() and advance()
+	friend class ::SampleTest;
 
 private:
 	std::shared_ptr<const SampleBuffer> m_buffer = SampleBuffer::emptyBuffer();
@@ -27,6 +27,8 @@
 
 #include <QByteArray>
 #include <QString>
+#include <cstddef>
+#include <iterator>
 #include <memory>
 #include <optional>
 #include <samplerate.h>
@@ -34,6 +36,7 @@
 
 #include "AudioEngine.h"
 #include "Engine.h"
+#include "SampleStream.h"
 #include "lmms_basics.h"
 #include "lmms_export.h"
 
@@ -42,14 +45,14 @@ class LMMS_EXPORT SampleBuffer
 {
 public:
 	using value_type = SampleFrame;
-	using reference = SampleFrame&;
+	using reference = const SampleFrame&;
 	using const_reference = const SampleFrame&;
-	using iterator = std::vector<SampleFrame>::iterator;
-	using const_iterator = std::vector<SampleFrame>::const_iterator;
-	using difference_type = std::vector<SampleFrame>::difference_type;
-	using size_type = std::vector<SampleFrame>::size_type;
-	using reverse_iterator = std::vector<SampleFrame>::reverse_iterator;
-	using const_reverse_iterator = std::vector<SampleFrame>::const_reverse_iterator;
+	using iterator = const SampleFrame*;
+	using const_iterator = const SampleFrame*;
+	using difference_type = std::ptrdiff_t;
+	using size_type = std::size_t;
+	using reverse_iterator = std::reverse_iterator<iterator>;
+	using const_reverse_iterator = std::reverse_iterator<const_iterator>;
 
 	SampleBuffer() = default;
 	explicit SampleBuffer(const QString& audioFile);
@@ -64,32 +67,30 @@ public:
 	auto audioFile() const -> const QString& { return m_audioFile; }
 	auto sampleRate() const -> sample_rate_t { return m_sampleRate; }
 
-	auto begin() -> iterator { return m_data.begin(); }
-	auto end() -> iterator { return m_data.end(); }
+	auto begin() const -> const_iterator { return data(); }
+	auto end() const -> const_iterator { return data() + size(); }
 
-	auto begin() const -> const_iterator { return m_data.begin(); }
-	auto end() const -> const_iterator { return m_data.end(); }
+	auto cbegin() const -> const_iterator { return begin(); }
+	auto cend() const -> const_iterator { return end(); }
 
-	auto cbegin() const -> const_iterator { return m_data.cbegin(); }
-	auto cend() const -> const_iterator { return m_data.cend(); }
+	auto rbegin() const -> const_reverse_iterator { return const_reverse_iterator{end()}; }
+	auto rend() const -> const_reverse_iterator { return const_reverse_iterator{begin()}; }
 
-	auto rbegin() -> reverse_iterator { return m_data.rbegin(); }
-	auto rend() -> reverse_iterator { return m_data.rend(); }
+	auto crbegin() const -> const_reverse_iterator { return rbegin(); }
+	auto crend() const -> const_reverse_iterator { return rend(); }
 
-	auto rbegin() const -> const_reverse_iterator { return m_data.rbegin(); }
-	auto rend() const -> const_reverse_iterator { return m_data.rend(); }
+	auto data() const -> const SampleFrame* { return m_stream ? m_stream->data() : m_data.data(); }
+	auto size() const -> size_type { return m_stream ? m_stream->size() : m_data.size(); }
+	auto empty() const -> bool { return size() == 0; }
 
-	auto crbegin() const -> const_reverse_iterator { return m_data.crbegin(); }
-	auto crend() const -> const_reverse_iterator { return m_data.crend(); }
-
-	auto data() const -> const SampleFrame* { return m_data.data(); }
-	auto size() const -> size_type { return m_data.size(); }
-	auto empty() const -> bool { return m_data.empty(); }
+	//! The memory-mapped frames of a long audio file, or nullptr if the frames are in memory
+	auto stream() const -> const SampleStream* { return m_stream.get(); }
 
 	static auto emptyBuffer() -> std::shared_ptr<const SampleBuffer>;
 
 private:
 	std::vector<SampleFrame> m_data;
+	std::shared_ptr<const SampleStream> m_stream;
 	QString m_audioFile;
 	sample_rate_t m_sampleRate = Engine::audioEngine()->outputSampleRate();
 };
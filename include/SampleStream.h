@@ -0,0 +1,89 @@
+/*
+ * SampleStream.h - sample data that is memory-mapped from disk
+ *
+ * This file is part of LMMS - https://lmms.io
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this program (see COPYING); if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301 USA.
+ *
+ */
+
+#ifndef LMMS_SAMPLE_STREAM_H
+#define LMMS_SAMPLE_STREAM_H
+
+#include <QtGlobal>
+#include <cstddef>
+#include <memory>
+
+#include "SampleFrame.h"
+#include "lmms_export.h"
+
+class QFile;
+class QString;
+
+namespace lmms {
+
+/**
+	Decoded frames of an audio file that stay on disk and are memory-mapped
+	read-only, so that long recordings do not have to be held in memory.
+
+	Files are decoded in chunks into a file in ConfigManager::cacheDir(), which
+	is reused while the audio file does not change. The audio file itself is
+	never mapped, so it can be changed or removed while it is being played.
+	The least recently used decoded files are removed once the cache exceeds
+	the "samplecachesize" setting in MiB.
+
+	Pages are loaded on first access. Players call readAhead() for the frames
+	they are about to play, which lets a background thread load them before
+	the audio thread gets there.
+*/
+class LMMS_EXPORT SampleStream
+{
+public:
+	//! Files with fewer decoded bytes than this are loaded into memory instead
+	static constexpr std::size_t DefaultMinSize = std::size_t{64} << 20;
+
+	//! Whether long samples are streamed at all, which is the "streamsamples" setting
+	static auto isEnabled() -> bool;
+
+	//! Maps the decoded frames of \a audioFile. Returns nullptr if the file is shorter than
+	//! \a minSize bytes of decoded frames, or if it cannot be mapped or decoded.
+	static auto open(const QString& audioFile, std::size_t minSize = DefaultMinSize) -> std::unique_ptr<SampleStream>;
+
+	SampleStream(const SampleStream&) = delete;
+	SampleStream& operator=(const SampleStream&) = delete;
+	//! The mapping is released by the background thread, after pending read-aheads
+	~SampleStream();
+
+	auto data() const -> const SampleFrame* { return m_data; }
+	auto size() const -> std::size_t { return m_size; }
+	auto sampleRate() const -> int { return m_sampleRate; }
+
+	//! Makes the background thread load frames [first, first + count) from disk.
+	//! Real-time safe.
+	void readAhead(std::size_t first, std::size_t count) const;
+
+private:
+	SampleStream(std::unique_ptr<QFile> file, const uchar* data, std::size_t size, int sampleRate);
+
+	QFile* m_file = nullptr;
+	const SampleFrame* m_data = nullptr;
+	std::size_t m_size = 0;
+	int m_sampleRate = 0;
+};
+
+} // namespace lmms
+
+#endif // LMMS_SAMPLE_STREAM_H
@@ -27,6 +27,7 @@
 
 #include <array>
 #include <memory>
+#include <vector>
 
 #include <QHash>
 #include <QString>
@@ -293,8 +294,10 @@ public:
 		return m_globalAutomationTrack;
 	}
 
-	//TODO: Add Q_DECL_OVERRIDE when Qt4 is dropped
-	AutomatedValueMap automatedValuesAt(TimePos time, int clipNum = -1) const override;
+	AutomationSourceMap automationSourcesAt(TimePos time, int clipNum = -1) const override;
+	//! Forgets the automation of the current tick, which a period that starts mid-tick
+	//! would continue. Must be called whenever a clip, track or automated model is removed.
+	void clearAutomationSources();
 
 	// file management
 	void createNewProject();
@@ -451,6 +454,10 @@ private:
 	void restoreKeymapStates(const QDomElement &element);
 
 	void processAutomations(const TrackList& tracks, TimePos timeStart, fpp_t frames);
+	//! Writes the automation of the current tick into the value buffers of
+	//! the automated models, from @p offset to the end of the period, with
+	//! @p offset being @p tickOffset ticks after the start of the tick
+	void processAutomationBuffers(f_cnt_t offset, double tickOffset);
 	void processMetronome(size_t bufferOffset);
 
 	void setModified(bool value);
@@ -516,6 +523,9 @@ private:
 	std::shared_ptr<Keymap> m_keymaps[MaxKeymapCount];
 
 	AutomatedValueMap m_oldAutomatedValues;
+	//! The automation of the current tick, excluding recorded models
+	AutomationSourceMap m_automationSources;
+	std::vector<float> m_automationValues;
 
 	Metronome m_metronome;
 
@@ -26,6 +26,8 @@
 #define LMMS_THREADABLE_JOB_H
 
 #include "lmms_basics.h"
+#include "CpuTimeCounter.h"
+#include "RenderTracer.h"
 
 #include <atomic>
 
@@ -74,11 +76,29 @@ public:
 		auto expected = ProcessingState::Queued;
 		if (m_state.compare_exchange_strong(expected, ProcessingState::InProgress))
 		{
-			doProcessing();
+			if (m_cpuTime || RenderTracer::isActive())
+			{
+				const auto begin = RenderTracer::Clock::now();
+				doProcessing();
+				const auto end = RenderTracer::Clock::now();
+				if (m_cpuTime) { m_cpuTime->add(end - begin); }
+				RenderTracer::recordJob(typeid(*this), begin, end);
+			}
+			else
+			{
+				doProcessing();
+			}
 			m_state = ProcessingState::Done;
 		}
 	}
 
+	//! Account the time spent processing this job to @p counter, e.g. the
+	//! counter of the object this job works for. May be nullptr.
+	inline void setCpuTimeCounter(CpuTimeCounter* counter)
+	{
+		m_cpuTime = counter;
+	}
+
 	virtual bool requiresProcessing() const = 0;
 
 
@@ -86,6 +106,9 @@ protected:
 	virtual void doProcessing() = 0;
 
 	std::atomic<ProcessingState> m_state;
+
+private:
+	CpuTimeCounter* m_cpuTime = nullptr;
 } ;
 
 } // namespace lmms
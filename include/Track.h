@@ -25,6 +25,7 @@
 #ifndef LMMS_TRACK_H
 #define LMMS_TRACK_H
 
+#include <atomic>
 #include <vector>
 
 #include <QColor>
@@ -121,6 +122,11 @@ public:
 	// -- for usage by Clip only ---------------
 	Clip * addClip( Clip * clip );
 	void removeClip( Clip * clip );
+	//! Must be called when the position or length of a Clip has changed
+	void invalidateClipIndex()
+	{
+		m_clipIndexValid = false;
+	}
 	// -------------------------------------------------------
 	void deleteClips();
 
@@ -132,6 +138,8 @@ public:
 	{
 		return m_clips;
 	}
+	//! Adds all clips overlapping [@p start, @p end] to @p clipV, which
+	//! is kept sorted by start position
 	void getClipsInRange( clipVector & clipV, const TimePos & start,
 							const TimePos & end );
 	void swapPositionOfClips( int clipNum1, int clipNum2 );
@@ -226,6 +234,21 @@ private:
 
 	clipVector m_clips;
 
+	//! The clips sorted by start position, for getClipsInRange()
+	struct IndexedClip
+	{
+		int start;
+		int end;
+		//! The maximum end of this and all previous clips
+		int maxEnd;
+		Clip* clip;
+	};
+	void updateClipIndex();
+
+	std::vector<IndexedClip> m_clipIndex;
+	std::atomic<bool> m_clipIndexValid = false;
+	QMutex m_clipIndexMutex;
+
 	QMutex m_processingLock;
 	
 	std::optional<QColor> m_color;
@@ -27,6 +27,7 @@
 #define LMMS_TRACK_CONTAINER_H
 
 #include <QReadWriteLock>
+#include <limits>
 
 #include "Track.h"
 #include "JournallingObject.h"
@@ -45,6 +46,19 @@ class TrackContainerView;
 }
 
 
+//! The automation clip which sets the value of a model at some time
+struct AutomationSource
+{
+	const AutomationClip* clip;
+	//! The time relative to the clip
+	TimePos time;
+	//! The clip is not played beyond this time, but keeps its value there
+	int end = std::numeric_limits<int>::max();
+};
+
+using AutomationSourceMap = QMap<AutomatableModel*, AutomationSource>;
+
+
 class LMMS_EXPORT TrackContainer : public Model, public JournallingObject
 {
 	Q_OBJECT
@@ -95,13 +109,14 @@ public:
 		return m_TrackContainerType;
 	}
 
-	virtual AutomatedValueMap automatedValuesAt(TimePos time, int clipNum = -1) const;
+	AutomatedValueMap automatedValuesAt(TimePos time, int clipNum = -1) const;
+	virtual AutomationSourceMap automationSourcesAt(TimePos time, int clipNum = -1) const;
 
 signals:
 	void trackAdded( lmms::Track * _track );
 
 protected:
-	static AutomatedValueMap automatedValuesFromTracks(const TrackList &tracks, TimePos timeStart, int clipNum = -1);
+	static AutomationSourceMap automationSourcesFromTracks(const TrackList &tracks, TimePos timeStart, int clipNum = -1);
 
 	mutable QReadWriteLock m_tracksMutex;
 
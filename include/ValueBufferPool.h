@@ -0,0 +1,65 @@
+/*
+ * ValueBufferPool.h - shared pool of period-sized ValueBuffers
+ *
+ * This file is part of LMMS - https://lmms.io
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this program (see COPYING); if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301 USA.
+ *
+ */
+
+#ifndef LMMS_VALUE_BUFFER_POOL_H
+#define LMMS_VALUE_BUFFER_POOL_H
+
+#include <cstddef>
+
+#include "lmms_basics.h"
+#include "lmms_export.h"
+
+namespace lmms
+{
+
+class ValueBuffer;
+
+/**
+	Real-time safe pool of ValueBuffers with framesPerPeriod values each.
+
+	Models and controllers only hold a buffer while they produce sample-exact
+	data, so a project needs as many buffers as it has sample-exact sources
+	rather than one per model. acquire() and release() are lock-free and only
+	allocate when the pool is exhausted. The contents of an acquired buffer
+	are unspecified.
+*/
+class LMMS_EXPORT ValueBufferPool
+{
+public:
+	struct Statistics
+	{
+		std::size_t capacity;   //!< number of buffers owned by the pool
+		std::size_t inUse;      //!< number of buffers currently acquired
+		std::size_t poolMisses; //!< acquisitions that had to allocate
+	};
+
+	static void init(fpp_t fpp);
+	static ValueBuffer* acquire();
+	static void release(ValueBuffer* buf);
+
+	static Statistics statistics();
+};
+
+
+} // namespace lmms
+
+#endif // LMMS_VALUE_BUFFER_POOL_H
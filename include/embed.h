@@ -65,7 +65,7 @@ public:
 
 	virtual ~PixmapLoader() = default;
 
-	auto pixmap(int width = -1, int height = -1) const -> QPixmap
+	virtual auto pixmap(int width = -1, int height = -1) const -> QPixmap
 	{
 		return embed::getIconPixmap(m_name, width, height, m_xpm);
 	}
@@ -26,6 +26,7 @@
 
 #include <QVarLengthArray>
 #include <QMessageBox>
+#include <algorithm>
 
 #include "LadspaEffect.h"
 #include "DataFile.h"
@@ -35,6 +36,7 @@
 #include "LadspaBase.h"
 #include "LadspaControl.h"
 #include "LadspaSubPluginFeatures.h"
+#include "PlanarBuffer.h"
 #include "AutomationClip.h"
 #include "ValueBuffer.h"
 #include "Song.h"
@@ -151,6 +153,78 @@ Effect::ProcessStatus LadspaEffect::processImpl(SampleFrame* buf, const fpp_t fr
 				Engine::audioEngine()->outputSampleRate();
 	}
 
+	copyToPorts(outFrames, [buf](LADSPA_Data* portBuffer, ch_cnt_t channel, fpp_t frames)
+	{
+		for (fpp_t frame = 0; frame < frames; ++frame)
+		{
+			portBuffer[frame] = buf[frame][channel];
+		}
+	});
+
+	runPlugins(outFrames);
+
+	const float d = dryLevel();
+	const float w = wetLevel();
+	mixFromPorts(outFrames, [buf, d, w](const LADSPA_Data* portBuffer, ch_cnt_t channel, fpp_t frames)
+	{
+		for (fpp_t frame = 0; frame < frames; ++frame)
+		{
+			buf[frame][channel] = d * buf[frame][channel] + w * portBuffer[frame];
+		}
+	});
+
+	if (outBuf != nullptr)
+	{
+		sampleBack(buf, outBuf, m_maxSampleRate);
+	}
+
+	m_pluginMutex.unlock();
+
+	return ProcessStatus::ContinueIfNotQuiet;
+}
+
+
+
+
+Effect::ProcessStatus LadspaEffect::processPlanarImpl(PlanarBuffer& buf, const fpp_t frames)
+{
+	m_pluginMutex.lock();
+	if (!isOkay() || dontRun() || !isEnabled() || !isRunning())
+	{
+		m_pluginMutex.unlock();
+		return ProcessStatus::Sleep;
+	}
+
+	// the channels are contiguous, so the copies below are vectorized
+	copyToPorts(frames, [&buf](LADSPA_Data* portBuffer, ch_cnt_t channel, fpp_t frames)
+	{
+		std::copy_n(buf.channel(channel), frames, portBuffer);
+	});
+
+	runPlugins(frames);
+
+	const float d = dryLevel();
+	const float w = wetLevel();
+	mixFromPorts(frames, [&buf, d, w](const LADSPA_Data* portBuffer, ch_cnt_t channel, fpp_t frames)
+	{
+		sample_t* samples = buf.channel(channel);
+		for (fpp_t frame = 0; frame < frames; ++frame)
+		{
+			samples[frame] = d * samples[frame] + w * portBuffer[frame];
+		}
+	});
+
+	m_pluginMutex.unlock();
+
+	return ProcessStatus::ContinueIfNotQuiet;
+}
+
+
+
+
+template<typename CopyChannel>
+void LadspaEffect::copyToPorts(fpp_t frames, CopyChannel copyChannel)
+{
 	// Copy the LMMS audio buffer to the LADSPA input buffer and initialize
 	// the control ports.
 	ch_cnt_t channel = 0;
@@ -162,10 +236,7 @@ Effect::ProcessStatus LadspaEffect::processImpl(SampleFrame* buf, const fpp_t fr
 			switch( pp->rate )
 			{
 				case BufferRate::ChannelIn:
-					for (fpp_t frame = 0; frame < outFrames; ++frame)
-					{
-						pp->buffer[frame] = buf[frame][channel];
-					}
+					copyChannel(pp->buffer, channel, frames);
 					++channel;
 					break;
 				case BufferRate::AudioRateInput:
@@ -173,7 +244,7 @@ Effect::ProcessStatus LadspaEffect::processImpl(SampleFrame* buf, const fpp_t fr
 					ValueBuffer * vb = pp->control->valueBuffer();
 					if( vb )
 					{
-						memcpy(pp->buffer, vb->values(), outFrames * sizeof(float));
+						memcpy(pp->buffer, vb->values(), frames * sizeof(float));
 					}
 					else
 					{
@@ -182,7 +253,7 @@ Effect::ProcessStatus LadspaEffect::processImpl(SampleFrame* buf, const fpp_t fr
 						// This only supports control rate ports, so the audio rates are
 						// treated as though they were control rate by setting the
 						// port buffer to all the same value.
-						for (fpp_t frame = 0; frame < outFrames; ++frame)
+						for (fpp_t frame = 0; frame < frames; ++frame)
 						{
 							pp->buffer[frame] = pp->value;
 						}
@@ -208,18 +279,28 @@ Effect::ProcessStatus LadspaEffect::processImpl(SampleFrame* buf, const fpp_t fr
 			}
 		}
 	}
+}
 
 
+
+
+void LadspaEffect::runPlugins(fpp_t frames)
+{
 	// Process the buffers.
 	for( ch_cnt_t proc = 0; proc < processorCount(); ++proc )
 	{
-		(m_descriptor->run)(m_handles[proc], outFrames);
+		(m_descriptor->run)(m_handles[proc], frames);
 	}
+}
 
+
+
+
+template<typename MixChannel>
+void LadspaEffect::mixFromPorts(fpp_t frames, MixChannel mixChannel)
+{
 	// Copy the LADSPA output buffers to the LMMS buffer.
-	channel = 0;
-	const float d = dryLevel();
-	const float w = wetLevel();
+	ch_cnt_t channel = 0;
 	for( ch_cnt_t proc = 0; proc < processorCount(); ++proc )
 	{
 		for( int port = 0; port < m_portCount; ++port )
@@ -232,10 +313,7 @@ Effect::ProcessStatus LadspaEffect::processImpl(SampleFrame* buf, const fpp_t fr
 				case BufferRate::ControlRateInput:
 					break;
 				case BufferRate::ChannelOut:
-					for (fpp_t frame = 0; frame < outFrames; ++frame)
-					{
-						buf[frame][channel] = d * buf[frame][channel] + w * pp->buffer[frame];
-					}
+					mixChannel(pp->buffer, channel, frames);
 					++channel;
 					break;
 				case BufferRate::AudioRateOutput:
@@ -246,15 +324,6 @@ Effect::ProcessStatus LadspaEffect::processImpl(SampleFrame* buf, const fpp_t fr
 			}
 		}
 	}
-
-	if (outBuf != nullptr)
-	{
-		sampleBack(buf, outBuf, m_maxSampleRate);
-	}
-
-	m_pluginMutex.unlock();
-
-	return ProcessStatus::ContinueIfNotQuiet;
 }
 
 
@@ -286,6 +355,9 @@ void LadspaEffect::pluginInstantiation()
 	// get inPlaceBroken property
 	m_inPlaceBroken = manager->isInplaceBroken( m_key );
 
+	// plugins run at a lower sample rate need interleaved buffers for resampling
+	setPlanar( m_maxSampleRate >= Engine::audioEngine()->outputSampleRate() );
+
 	// Categorize the ports, and create the buffers.
 	m_portCount = manager->getPortCount( m_key );
 
@@ -48,6 +48,7 @@ public:
 	~LadspaEffect() override;
 
 	ProcessStatus processImpl(SampleFrame* buf, const fpp_t frames) override;
+	ProcessStatus processPlanarImpl(PlanarBuffer& buf, const fpp_t frames) override;
 
 	void setControl( int _control, LADSPA_Data _data );
 
@@ -70,6 +71,16 @@ private:
 	void pluginInstantiation();
 	void pluginDestruction();
 
+	//! Fill the input ports, @p copyChannel(portBuffer, channel, frames)
+	//! copies the audio input of one channel
+	template<typename CopyChannel>
+	void copyToPorts(fpp_t frames, CopyChannel copyChannel);
+	void runPlugins(fpp_t frames);
+	//! @p mixChannel(portBuffer, channel, frames) mixes one audio output
+	//! into the signal
+	template<typename MixChannel>
+	void mixFromPorts(fpp_t frames, MixChannel mixChannel);
+
 	static sample_rate_t maxSamplerate( const QString & _name );
 
 
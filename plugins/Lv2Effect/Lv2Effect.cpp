@@ -61,8 +61,11 @@ Plugin::Descriptor PLUGIN_EXPORT lv2effect_plugin_descriptor =
 Lv2Effect::Lv2Effect(Model* parent, const Descriptor::SubPluginFeatures::Key *key) :
 	Effect(&lv2effect_plugin_descriptor, parent, key),
 	m_controls(this, key->attributes["uri"]),
-	m_tmpOutputSmps(Engine::audioEngine()->framesPerPeriod())
+	m_tmpOutputSmps(Engine::audioEngine()->framesPerPeriod()),
+	m_tmpOutputPlanar(Engine::audioEngine()->framesPerPeriod())
 {
+	// LV2 ports are planar, so this saves the conversion
+	setPlanar(true);
 }
 
 
@@ -97,6 +100,37 @@ Effect::ProcessStatus Lv2Effect::processImpl(SampleFrame* buf, const fpp_t frame
 
 
 
+Effect::ProcessStatus Lv2Effect::processPlanarImpl(PlanarBuffer& buf, const fpp_t frames)
+{
+	Q_ASSERT(frames <= m_tmpOutputPlanar.capacity());
+
+	m_controls.copyBuffersFromLmms(buf, frames);
+	m_controls.copyModelsFromLmms();
+
+	m_controls.run(frames);
+
+	m_controls.copyModelsToLmms();
+	m_controls.copyBuffersToLmms(m_tmpOutputPlanar, frames);
+
+	bool corrupt = wetLevel() < 0; // #3261 - if w < 0, bash w := 0, d := 1
+	const float d = corrupt ? 1 : dryLevel();
+	const float w = corrupt ? 0 : wetLevel();
+	for (ch_cnt_t ch = 0; ch < DEFAULT_CHANNELS; ++ch)
+	{
+		sample_t* samples = buf.channel(ch);
+		const sample_t* wet = m_tmpOutputPlanar.channel(ch);
+		for (fpp_t f = 0; f < frames; ++f)
+		{
+			samples[f] = d * samples[f] + w * wet[f];
+		}
+	}
+
+	return ProcessStatus::ContinueIfNotQuiet;
+}
+
+
+
+
 extern "C"
 {
 
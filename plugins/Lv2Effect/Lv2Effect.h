@@ -27,6 +27,7 @@
 
 #include "Effect.h"
 #include "Lv2FxControls.h"
+#include "PlanarBuffer.h"
 
 namespace lmms
 {
@@ -43,6 +44,7 @@ public:
 	Lv2Effect(Model* parent, const Descriptor::SubPluginFeatures::Key* _key);
 
 	ProcessStatus processImpl(SampleFrame* buf, const fpp_t frames) override;
+	ProcessStatus processPlanarImpl(PlanarBuffer& buf, const fpp_t frames) override;
 
 	EffectControls* controls() override { return &m_controls; }
 
@@ -52,6 +54,7 @@ public:
 private:
 	Lv2FxControls m_controls;
 	std::vector<SampleFrame> m_tmpOutputSmps;
+	PlanarBuffer m_tmpOutputPlanar;
 };
 
 
@@ -26,6 +26,9 @@
 #include <QDomElement>
 #include <QFileInfo>
 
+#include <array>
+#include <optional>
+
 #include "TripleOscillator.h"
 #include "AudioEngine.h"
 #include "AutomatableButton.h"
@@ -33,6 +36,7 @@
 #include "Engine.h"
 #include "InstrumentTrack.h"
 #include "Knob.h"
+#include "LocklessPool.h"
 #include "NotePlayHandle.h"
 #include "Oscillator.h"
 #include "PathUtil.h"
@@ -306,79 +310,85 @@ QString TripleOscillator::nodeName() const
 
 
 
+//! The oscillators of one note, allocated in one piece
+struct TripleOscillator::Voice
+{
+	// each oscillator is modulated by the next one
+	std::array<std::optional<Oscillator>, NUM_OF_OSCILLATORS> left;
+	std::array<std::optional<Oscillator>, NUM_OF_OSCILLATORS> right;
+} ;
+
+
+static constexpr std::uint32_t INITIAL_VOICES = 64;
+static constexpr std::uint32_t VOICE_REFILL_WATERMARK = 16;
+static constexpr std::uint32_t VOICE_REFILL_STEP = 64;
+static constexpr std::uint32_t MAX_POOLED_VOICES = 4096;
+
+
+//! Shared by all instances, so note-on doesn't hit the system allocator
+LocklessPoolT<TripleOscillator::Voice>& TripleOscillator::voicePool()
+{
+	static LocklessPoolT<Voice> pool(INITIAL_VOICES, VOICE_REFILL_WATERMARK,
+		VOICE_REFILL_STEP, MAX_POOLED_VOICES);
+	return pool;
+}
+
+
+
+
 void TripleOscillator::playNote( NotePlayHandle * _n,
 						SampleFrame* _working_buffer )
 {
 	if (!_n->m_pluginData)
 	{
-		auto oscs_l = std::array<Oscillator*, NUM_OF_OSCILLATORS>{};
-		auto oscs_r = std::array<Oscillator*, NUM_OF_OSCILLATORS>{};
+		auto voice = new (voicePool().alloc()) Voice;
 
 		for( int i = NUM_OF_OSCILLATORS - 1; i >= 0; --i )
 		{
-
 			// the last oscs needs no sub-oscs...
-			if( i == NUM_OF_OSCILLATORS - 1 )
+			Oscillator* subLeft = nullptr;
+			Oscillator* subRight = nullptr;
+			if( i < NUM_OF_OSCILLATORS - 1 )
 			{
-				oscs_l[i] = new Oscillator(
-						&m_osc[i]->m_waveShapeModel,
-						&m_osc[i]->m_modulationAlgoModel,
-						_n->frequency(),
-						m_osc[i]->m_detuningLeft,
-						m_osc[i]->m_phaseOffsetLeft,
-						m_osc[i]->m_volumeLeft );
-				oscs_l[i]->setUseWaveTable(m_osc[i]->m_useWaveTable);
-				oscs_r[i] = new Oscillator(
-						&m_osc[i]->m_waveShapeModel,
-						&m_osc[i]->m_modulationAlgoModel,
-						_n->frequency(),
-						m_osc[i]->m_detuningRight,
-						m_osc[i]->m_phaseOffsetRight,
-						m_osc[i]->m_volumeRight );
-				oscs_r[i]->setUseWaveTable(m_osc[i]->m_useWaveTable);
+				subLeft = &*voice->left[i + 1];
+				subRight = &*voice->right[i + 1];
 			}
-			else
+
+			Oscillator& oscLeft = voice->left[i].emplace(
+					&m_osc[i]->m_waveShapeModel,
+					&m_osc[i]->m_modulationAlgoModel,
+					_n->frequency(),
+					m_osc[i]->m_detuningLeft,
+					m_osc[i]->m_phaseOffsetLeft,
+					m_osc[i]->m_volumeLeft,
+					subLeft, false );
+			Oscillator& oscRight = voice->right[i].emplace(
+					&m_osc[i]->m_waveShapeModel,
+					&m_osc[i]->m_modulationAlgoModel,
+					_n->frequency(),
+					m_osc[i]->m_detuningRight,
+					m_osc[i]->m_phaseOffsetRight,
+					m_osc[i]->m_volumeRight,
+					subRight, false );
+
+			for (Oscillator* osc : {&oscLeft, &oscRight})
 			{
-				oscs_l[i] = new Oscillator(
-						&m_osc[i]->m_waveShapeModel,
-						&m_osc[i]->m_modulationAlgoModel,
-						_n->frequency(),
-						m_osc[i]->m_detuningLeft,
-						m_osc[i]->m_phaseOffsetLeft,
-						m_osc[i]->m_volumeLeft,
-						oscs_l[i + 1] );
-				oscs_l[i]->setUseWaveTable(m_osc[i]->m_useWaveTable);
-				oscs_r[i] = new Oscillator(
-						&m_osc[i]->m_waveShapeModel,
-						&m_osc[i]->m_modulationAlgoModel,
-						_n->frequency(),
-						m_osc[i]->m_detuningRight,
-						m_osc[i]->m_phaseOffsetRight,
-						m_osc[i]->m_volumeRight,
-						oscs_r[i + 1] );
-				oscs_r[i]->setUseWaveTable(m_osc[i]->m_useWaveTable);
+				osc->setUseWaveTable(m_osc[i]->m_useWaveTable);
+				osc->setUserWave(m_osc[i]->m_sampleBuffer);
+				osc->setUserAntiAliasWaveTable(m_osc[i]->m_userAntiAliasWaveTable);
 			}
-
-			oscs_l[i]->setUserWave( m_osc[i]->m_sampleBuffer );
-			oscs_r[i]->setUserWave( m_osc[i]->m_sampleBuffer );
-			oscs_l[i]->setUserAntiAliasWaveTable(m_osc[i]->m_userAntiAliasWaveTable);
-			oscs_r[i]->setUserAntiAliasWaveTable(m_osc[i]->m_userAntiAliasWaveTable);
 		}
 
-		_n->m_pluginData = new oscPtr;
-		static_cast<oscPtr *>( _n->m_pluginData )->oscLeft = oscs_l[0];
-		static_cast< oscPtr *>( _n->m_pluginData )->oscRight =
-								oscs_r[0];
+		_n->m_pluginData = voice;
 	}
 
-	Oscillator * osc_l = static_cast<oscPtr *>( _n->m_pluginData )->oscLeft;
-	Oscillator * osc_r = static_cast<oscPtr *>( _n->m_pluginData )->oscRight;
+	auto voice = static_cast<Voice*>(_n->m_pluginData);
 
 	const fpp_t frames = _n->framesLeftForCurrentPeriod();
 	const f_cnt_t offset = _n->noteOffset();
 
-	osc_l->update( _working_buffer + offset, frames, 0 );
-	osc_r->update( _working_buffer + offset, frames, 1 );
+	voice->left[0]->update( _working_buffer + offset, frames, 0 );
+	voice->right[0]->update( _working_buffer + offset, frames, 1 );
 
 	applyFadeIn(_working_buffer, _n);
 	applyRelease( _working_buffer, _n );
@@ -389,11 +399,9 @@ void TripleOscillator::playNote( NotePlayHandle * _n,
 
 void TripleOscillator::deleteNotePluginData( NotePlayHandle * _n )
 {
-	delete static_cast<Oscillator *>( static_cast<oscPtr *>(
-						_n->m_pluginData )->oscLeft );
-	delete static_cast<Oscillator *>( static_cast<oscPtr *>(
-						_n->m_pluginData )->oscRight );
-	delete static_cast<oscPtr *>( _n->m_pluginData );
+	auto voice = static_cast<Voice*>(_n->m_pluginData);
+	voice->~Voice();
+	voicePool().free(voice);
 }
 
 
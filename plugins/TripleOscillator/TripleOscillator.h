@@ -41,6 +41,7 @@ namespace lmms
 class NotePlayHandle;
 class SampleBuffer;
 class Oscillator;
+template<typename T> class LocklessPoolT;
 
 
 namespace gui
@@ -136,11 +137,8 @@ protected slots:
 private:
 	OscillatorObject * m_osc[NUM_OF_OSCILLATORS];
 
-	struct oscPtr
-	{
-		Oscillator * oscLeft;
-		Oscillator * oscRight;
-	} ;
+	struct Voice;
+	static LocklessPoolT<Voice>& voicePool();
 
 
 	friend class gui::TripleOscillatorView;
@@ -60,6 +60,8 @@
 #include "MidiDummy.h"
 
 #include "BufferManager.h"
+#include "RenderTracer.h"
+#include "ValueBufferPool.h"
 
 namespace lmms
 {
@@ -73,6 +75,7 @@ static thread_local bool s_renderingThread = false;
 
 AudioEngine::AudioEngine( bool renderOnly ) :
 	m_renderOnly( renderOnly ),
+	m_audioPorts( m_rcuDomain ),
 	m_framesPerPeriod( DEFAULT_BUFFER_SIZE ),
 	m_baseSampleRate(std::max(ConfigManager::inst()->value("audioengine", "samplerate").toInt(), 44100)),
 	m_inputBufferRead( 0 ),
@@ -82,6 +85,7 @@ AudioEngine::AudioEngine( bool renderOnly ) :
 	m_workers(),
 	m_numWorkers( QThread::idealThreadCount()-1 ),
 	m_newPlayHandles( PlayHandle::MaxNumber ),
+	m_playHandlesToRemove( PlayHandle::MaxNumber ),
 	m_qualitySettings(qualitySettings::Interpolation::Linear),
 	m_masterGain( 1.0f ),
 	m_audioDev( nullptr ),
@@ -129,11 +133,12 @@ AudioEngine::AudioEngine( bool renderOnly ) :
 		}
 	}
 
-	// allocte the FIFO from the determined size
-	m_fifo = new Fifo( fifoSize );
+	// allocate the FIFO from the determined size
+	m_fifo = new Fifo( fifoSize, m_framesPerPeriod );
 
-	// now that framesPerPeriod is fixed initialize global BufferManager
+	// now that framesPerPeriod is fixed initialize the global buffer pools
 	BufferManager::init( m_framesPerPeriod );
+	ValueBufferPool::init(m_framesPerPeriod);
 
 	m_outputBufferRead = std::make_unique<SampleFrame[]>(m_framesPerPeriod);
 	m_outputBufferWrite = std::make_unique<SampleFrame[]>(m_framesPerPeriod);
@@ -167,10 +172,6 @@ AudioEngine::~AudioEngine()
 		m_workers[w]->wait( 500 );
 	}
 
-	while( m_fifo->available() )
-	{
-		delete[] m_fifo->read();
-	}
 	delete m_fifo;
 
 	delete m_midiClient;
@@ -292,10 +293,9 @@ void AudioEngine::renderStageNoteSetup()
 	// remove all play-handles that have to be deleted and delete
 	// them if they still exist...
 	// maybe this algorithm could be optimized...
-	ConstPlayHandleList::Iterator it_rem = m_playHandlesToRemove.begin();
-	while( it_rem != m_playHandlesToRemove.end() )
+	for( LocklessListElement * e = m_playHandlesToRemove.popList(); e; )
 	{
-		PlayHandleList::Iterator it = std::find( m_playHandles.begin(), m_playHandles.end(), *it_rem );
+		PlayHandleList::Iterator it = std::find( m_playHandles.begin(), m_playHandles.end(), e->value );
 
 		if( it != m_playHandles.end() )
 		{
@@ -308,7 +308,9 @@ void AudioEngine::renderStageNoteSetup()
 			m_playHandles.erase( it );
 		}
 
-		it_rem = m_playHandlesToRemove.erase( it_rem );
+		LocklessListElement * next = e->next;
+		m_playHandlesToRemove.free( e );
+		e = next;
 	}
 
 	swapBuffers();
@@ -347,7 +349,7 @@ void AudioEngine::renderStageEffects()
 	AudioEngineProfiler::Probe profilerProbe(m_profiler, AudioEngineProfiler::DetailType::Effects);
 
 	// STAGE 2: process effects of all instrument- and sampletracks
-	AudioEngineWorkerThread::fillJobQueue(m_audioPorts);
+	AudioEngineWorkerThread::fillJobQueue(m_audioPorts.read());
 	AudioEngineWorkerThread::startAndWaitForJobs();
 
 	// removed all play handles which are done
@@ -401,8 +403,10 @@ void AudioEngine::renderStageMix()
 const SampleFrame* AudioEngine::renderNextBuffer()
 {
 	const auto lock = std::lock_guard{m_changeMutex};
+	RenderTracer::Scope traceScope("Period", "render");
 
 	m_profiler.startPeriod();
+	m_rcuDomain.beginRead();
 	s_renderingThread = true;
 
 	renderStageNoteSetup();     // STAGE 0: clear old play handles and buffers, setup new play handles
@@ -411,6 +415,7 @@ const SampleFrame* AudioEngine::renderNextBuffer()
 	renderStageMix();           // STAGE 3: do master mix in mixer
 
 	s_renderingThread = false;
+	m_rcuDomain.endRead();
 	m_profiler.finishPeriod(outputSampleRate(), m_framesPerPeriod);
 
 	return m_outputBufferRead.get();
@@ -460,7 +465,7 @@ void AudioEngine::clearInternal()
 	{
 		if (ph->type() != PlayHandle::Type::InstrumentPlayHandle)
 		{
-			m_playHandlesToRemove.push_back(ph);
+			m_playHandlesToRemove.push(ph);
 		}
 	}
 }
@@ -558,14 +563,17 @@ void AudioEngine::restoreAudioDevice()
 
 void AudioEngine::removeAudioPort(AudioPort * port)
 {
-	requestChangeInModel();
-
-	auto it = std::find(m_audioPorts.begin(), m_audioPorts.end(), port);
-	if (it != m_audioPorts.end())
+	m_audioPorts.update([port](auto& ports)
 	{
-		m_audioPorts.erase(it);
-	}
-	doneChangeInModel();
+		auto it = std::find(ports.begin(), ports.end(), port);
+		if (it != ports.end())
+		{
+			ports.erase(it);
+		}
+	});
+
+	// the caller is going to destroy the port
+	synchronizeSnapshots();
 }
 
 
@@ -593,11 +601,11 @@ bool AudioEngine::addPlayHandle( PlayHandle* handle )
 
 void AudioEngine::removePlayHandle(PlayHandle * ph)
 {
-	requestChangeInModel();
 	// check thread affinity as we must not delete play-handles
 	// which were created in a thread different than the audio engine thread
 	if (ph->affinityMatters() && ph->affinity() == QThread::currentThread())
 	{
+		requestChangeInModel();
 		ph->audioPort()->removePlayHandle(ph);
 		bool removedFromList = false;
 		// Check m_newPlayHandles first because doing it the other way around
@@ -638,12 +646,13 @@ void AudioEngine::removePlayHandle(PlayHandle * ph)
 			}
 			else { delete ph; }
 		}
+		doneChangeInModel();
 	}
 	else
 	{
-		m_playHandlesToRemove.push_back(ph);
+		// deferred to the audio thread, which doesn't need to be stalled
+		m_playHandlesToRemove.push(ph);
 	}
-	doneChangeInModel();
 }
 
 
@@ -688,6 +697,12 @@ void AudioEngine::doneChangeInModel()
 	m_changeMutex.unlock();
 }
 
+void AudioEngine::synchronizeSnapshots()
+{
+	if (s_renderingThread) { return; }
+	m_rcuDomain.synchronize();
+}
+
 bool AudioEngine::isAudioDevNameValid(QString name)
 {
 #ifdef LMMS_HAVE_SDL
@@ -1103,18 +1118,19 @@ void AudioEngine::fifoWriter::finish()
 void AudioEngine::fifoWriter::run()
 {
 	disable_denormals();
+	RenderTracer::setThreadName("FIFO writer");
 
 	const fpp_t frames = m_audioEngine->framesPerPeriod();
 	while( m_writing )
 	{
-		auto buffer = new SampleFrame[frames];
 		const SampleFrame* b = m_audioEngine->renderNextBuffer();
+		SampleFrame* buffer = m_fifo->beginWrite();
 		memcpy(buffer, b, frames * sizeof(SampleFrame));
-		m_fifo->write(buffer);
+		m_fifo->endWrite();
 	}
 
 	// Let audio backend stop processing
-	m_fifo->write(nullptr);
+	m_fifo->writeEndOfStream();
 	m_fifo->waitUntilRead();
 }
 
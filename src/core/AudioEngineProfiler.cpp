@@ -32,12 +32,20 @@ namespace lmms
 AudioEngineProfiler::AudioEngineProfiler() :
 	m_periodTimer(),
 	m_cpuLoad( 0 ),
+	m_renderedNanoseconds( 0 ),
 	m_outputFile()
 {
 }
 
 
 
+AudioEngineProfiler::~AudioEngineProfiler()
+{
+	RenderTracer::stop();
+}
+
+
+
 void AudioEngineProfiler::finishPeriod( sample_rate_t sampleRate, fpp_t framesPerPeriod )
 {
 	// Time taken to process all data and fill the audio buffer.
@@ -45,6 +53,9 @@ void AudioEngineProfiler::finishPeriod( sample_rate_t sampleRate, fpp_t framesPe
 	// Maximum time the processing can take before causing buffer underflow. Convert to us.
 	const uint64_t timeLimit = static_cast<uint64_t>(1000000) * framesPerPeriod / sampleRate;
 
+	m_renderedNanoseconds.fetch_add(static_cast<uint64_t>(1000000000) * framesPerPeriod / sampleRate,
+		std::memory_order_relaxed);
+
 	// Compute new overall CPU load and apply exponential averaging.
 	// The result is used for overload detection in AudioEngine::criticalXRuns()
 	// → the weight of a new sample must be high enough to allow relatively fast changes!
@@ -67,6 +78,33 @@ void AudioEngineProfiler::finishPeriod( sample_rate_t sampleRate, fpp_t framesPe
 
 
 
+int AudioEngineProfiler::LoadMeter::update(const AudioEngineProfiler& profiler, const CpuTimeCounter& counter)
+{
+	const auto cpuTime = counter.nanoseconds();
+	const auto renderedTime = profiler.renderedNanoseconds();
+
+	// If no period has been rendered since the last call (e.g. while the audio engine
+	// is stopped), keep the load. The time of a period that is still being rendered
+	// then counts towards the next one instead of getting lost.
+	if (m_started && renderedTime == m_lastRenderedTime) { return load(); }
+
+	// nothing to compare against on the first call
+	if (m_started)
+	{
+		// both only ever grow, so the differences can't wrap around
+		const auto newLoad = 100.f * (cpuTime - m_lastCpuTime) / (renderedTime - m_lastRenderedTime);
+		m_load = newLoad * 0.25f + m_load * 0.75f;
+	}
+
+	m_lastCpuTime = cpuTime;
+	m_lastRenderedTime = renderedTime;
+	m_started = true;
+
+	return load();
+}
+
+
+
 void AudioEngineProfiler::setOutputFile( const QString& outputFile )
 {
 	m_outputFile.close();
@@ -74,4 +112,11 @@ void AudioEngineProfiler::setOutputFile( const QString& outputFile )
 	m_outputFile.open( QFile::WriteOnly | QFile::Truncate );
 }
 
+
+
+bool AudioEngineProfiler::setTraceFile(const QString& traceFile)
+{
+	return RenderTracer::start(traceFile);
+}
+
 } // namespace lmms
@@ -25,11 +25,12 @@
 #include "AudioEngineWorkerThread.h"
 
 #include <QDebug>
-#include <QMutex>
-#include <QWaitCondition>
+#include <thread>
 
 #include "denormals.h"
 #include "AudioEngine.h"
+#include "LmmsSemaphore.h"
+#include "RenderTracer.h"
 #include "ThreadableJob.h"
 
 #if __SSE__
@@ -40,13 +41,125 @@ namespace lmms
 {
 
 AudioEngineWorkerThread::JobQueue AudioEngineWorkerThread::globalJobQueue;
-QWaitCondition * AudioEngineWorkerThread::queueReadyWaitCond = nullptr;
+Semaphore * AudioEngineWorkerThread::queueReadySemaphore = nullptr;
+std::atomic_int AudioEngineWorkerThread::parkedWorkers = 0;
 QList<AudioEngineWorkerThread *> AudioEngineWorkerThread::workerThreads;
 
+// index of the deque owned by the calling thread - threads which are not
+// worker threads (i.e. the thread running AudioEngine::renderNextBuffer())
+// use the deque of the inline worker, which is always the last one
+static thread_local int s_workerIndex = -1;
+
+
+static inline void cpuRelax()
+{
+#ifdef __SSE__
+	_mm_pause();
+#endif
+}
+
+
+
+
+// implementation of the work-stealing deque
+AudioEngineWorkerThread::JobQueue::Deque::Deque() :
+	m_top( 0 ),
+	m_bottom( 0 ),
+	m_items( new std::atomic<ThreadableJob*>[JOB_QUEUE_SIZE] )
+{
+	static_assert( ( JOB_QUEUE_SIZE & ( JOB_QUEUE_SIZE - 1 ) ) == 0,
+					"JOB_QUEUE_SIZE must be a power of two" );
+	std::fill( m_items.get(), m_items.get() + JOB_QUEUE_SIZE, nullptr );
+}
+
+
+
+
+bool AudioEngineWorkerThread::JobQueue::Deque::push( ThreadableJob * _job )
+{
+	const auto b = m_bottom.load( std::memory_order_relaxed );
+	const auto t = m_top.load( std::memory_order_acquire );
+	if( b - t >= static_cast<std::int64_t>( JOB_QUEUE_SIZE ) )
+	{
+		return false;
+	}
+	m_items[b & ( JOB_QUEUE_SIZE - 1 )].store( _job, std::memory_order_relaxed );
+	// publish the job to thieves
+	m_bottom.store( b + 1, std::memory_order_release );
+	return true;
+}
+
+
+
+
+ThreadableJob * AudioEngineWorkerThread::JobQueue::Deque::pop()
+{
+	const auto b = m_bottom.load( std::memory_order_relaxed ) - 1;
+	m_bottom.store( b, std::memory_order_relaxed );
+	std::atomic_thread_fence( std::memory_order_seq_cst );
+	auto t = m_top.load( std::memory_order_relaxed );
+
+	if( t > b )
+	{
+		// deque was empty
+		m_bottom.store( b + 1, std::memory_order_relaxed );
+		return nullptr;
+	}
+
+	ThreadableJob * job = m_items[b & ( JOB_QUEUE_SIZE - 1 )].load( std::memory_order_relaxed );
+	if( t == b )
+	{
+		// last item - race against thieves
+		if( !m_top.compare_exchange_strong( t, t + 1,
+				std::memory_order_seq_cst, std::memory_order_relaxed ) )
+		{
+			job = nullptr;
+		}
+		m_bottom.store( b + 1, std::memory_order_relaxed );
+	}
+	return job;
+}
+
+
+
+
+ThreadableJob * AudioEngineWorkerThread::JobQueue::Deque::steal()
+{
+	auto t = m_top.load( std::memory_order_acquire );
+	std::atomic_thread_fence( std::memory_order_seq_cst );
+	const auto b = m_bottom.load( std::memory_order_acquire );
+
+	if( t >= b )
+	{
+		return nullptr;
+	}
+
+	ThreadableJob * job = m_items[t & ( JOB_QUEUE_SIZE - 1 )].load( std::memory_order_relaxed );
+	if( !m_top.compare_exchange_strong( t, t + 1,
+			std::memory_order_seq_cst, std::memory_order_relaxed ) )
+	{
+		// lost the race against the owner or another thief
+		return nullptr;
+	}
+	return job;
+}
+
+
+
+
 // implementation of internal JobQueue
+int AudioEngineWorkerThread::JobQueue::addWorker()
+{
+	m_deques.push_back( std::make_unique<Deque>() );
+	return static_cast<int>( m_deques.size() ) - 1;
+}
+
+
+
+
 void AudioEngineWorkerThread::JobQueue::reset( OperationMode _opMode )
 {
-	m_writeIndex = 0;
+	m_itemsAdded = 0;
 	m_itemsDone = 0;
 	m_opMode = _opMode;
 }
@@ -60,11 +173,11 @@ void AudioEngineWorkerThread::JobQueue::addJob( ThreadableJob * _job )
 	{
 		// update job state
 		_job->queue();
-		// actually queue the job via atomic operations
-		auto index = m_writeIndex++;
-		if (index < JOB_QUEUE_SIZE) {
-			m_items[index] = _job;
-		} else {
+		// account for the job before publishing it, so m_itemsDone can never
+		// catch up with m_itemsAdded while a job is still in flight
+		++m_itemsAdded;
+		if( !ownDeque().push( _job ) )
+		{
 			qWarning() << "Job queue is full!";
 			++m_itemsDone;
 		}
@@ -73,24 +186,58 @@ void AudioEngineWorkerThread::JobQueue::addJob( ThreadableJob * _job )
 
 
 
+
+auto AudioEngineWorkerThread::JobQueue::ownDeque() -> Deque &
+{
+	return s_workerIndex < 0 ? *m_deques.back() : *m_deques[s_workerIndex];
+}
+
+
+
+
+ThreadableJob * AudioEngineWorkerThread::JobQueue::findJob()
+{
+	if( ThreadableJob * job = ownDeque().pop() )
+	{
+		return job;
+	}
+
+	// our own deque is empty - try to steal from the other workers, starting
+	// with our right neighbour so thieves spread across the victims
+	const int numDeques = static_cast<int>( m_deques.size() );
+	const int self = s_workerIndex < 0 ? numDeques - 1 : s_workerIndex;
+	for( int i = 1; i < numDeques; ++i )
+	{
+		if( ThreadableJob * job = m_deques[( self + i ) % numDeques]->steal() )
+		{
+			return job;
+		}
+	}
+	return nullptr;
+}
+
+
+
+
 void AudioEngineWorkerThread::JobQueue::run()
 {
-	bool processedJob = true;
-	while (processedJob && m_itemsDone < m_writeIndex)
+	while( m_itemsDone < m_itemsAdded )
 	{
-		processedJob = false;
-		for (auto i = std::size_t{0}; i < m_writeIndex && i < JOB_QUEUE_SIZE; ++i)
+		if( ThreadableJob * job = findJob() )
+		{
+			job->process();
+			++m_itemsDone;
+		}
+		else if( m_opMode == OperationMode::Dynamic )
 		{
-			ThreadableJob * job = m_items[i].exchange(nullptr);
-			if( job )
-			{
-				job->process();
-				processedJob = true;
-				++m_itemsDone;
-			}
+			// jobs in progress may still add new jobs
+			cpuRelax();
+		}
+		else
+		{
+			// nothing left to steal and no new jobs will be added
+			break;
 		}
-		// always exit loop if we're not in dynamic mode
-		processedJob = processedJob && ( m_opMode == OperationMode::Dynamic );
 	}
 }
 
@@ -99,11 +246,18 @@ void AudioEngineWorkerThread::JobQueue::run()
 
 void AudioEngineWorkerThread::JobQueue::wait()
 {
-	while (m_itemsDone < m_writeIndex)
+	// the remaining jobs are being processed by other workers right now, so
+	// they are about to finish - spin shortly before yielding the CPU
+	for( int spins = 0; m_itemsDone < m_itemsAdded; ++spins )
 	{
-#ifdef __SSE__
-		_mm_pause();
-#endif
+		if( spins < 1024 )
+		{
+			cpuRelax();
+		}
+		else
+		{
+			std::this_thread::yield();
+		}
 	}
 }
 
@@ -115,12 +269,13 @@ void AudioEngineWorkerThread::JobQueue::wait()
 
 AudioEngineWorkerThread::AudioEngineWorkerThread( AudioEngine* audioEngine ) :
 	QThread( audioEngine ),
+	m_index( globalJobQueue.addWorker() ),
 	m_quit( false )
 {
 	// initialize global static data
-	if( queueReadyWaitCond == nullptr )
+	if( queueReadySemaphore == nullptr )
 	{
-		queueReadyWaitCond = new QWaitCondition;
+		queueReadySemaphore = new Semaphore( 0 );
 	}
 
 	// keep track of all instantiated worker threads - this is used for
@@ -146,6 +301,30 @@ void AudioEngineWorkerThread::quit()
 {
 	m_quit = true;
 	resetJobQueue();
+	// make sure every parked worker leaves the parking lot, even if it gets
+	// woken up before its own quit() has been called
+	for( int i = 0; i < workerThreads.size(); ++i )
+	{
+		queueReadySemaphore->post();
+	}
+}
+
+
+
+
+void AudioEngineWorkerThread::wakeWorkers( size_t count )
+{
+	// only wake as many workers as there is work for instead of waking
+	// everyone; workers that are still busy will pick up work on their own
+	auto parked = parkedWorkers.load( std::memory_order_acquire );
+	while( count > 0 && parked > 0 )
+	{
+		if( parkedWorkers.compare_exchange_weak( parked, parked - 1 ) )
+		{
+			queueReadySemaphore->post();
+			--count;
+		}
+	}
 }
 
 
@@ -153,7 +332,18 @@ void AudioEngineWorkerThread::quit()
 
 void AudioEngineWorkerThread::startAndWaitForJobs()
 {
-	queueReadyWaitCond->wakeAll();
+	// The calling thread acts as an additional worker, so in static mode one
+	// job less needs a helper. In dynamic mode processed jobs may add more
+	// jobs, so wake everyone available.
+	const size_t pending = globalJobQueue.pending();
+	if( globalJobQueue.opMode() == JobQueue::OperationMode::Dynamic )
+	{
+		wakeWorkers( workerThreads.size() );
+	}
+	else if( pending > 1 )
+	{
+		wakeWorkers( pending - 1 );
+	}
 	// The last worker-thread is never started. Instead it's processed "inline"
 	// i.e. within the global AudioEngine thread. This way we can reduce latencies
 	// that otherwise would be caused by synchronizing with another thread.
@@ -167,14 +357,21 @@ void AudioEngineWorkerThread::startAndWaitForJobs()
 void AudioEngineWorkerThread::run()
 {
 	disable_denormals();
+	RenderTracer::setThreadName("Audio worker");
+
+	s_workerIndex = m_index;
 
-	QMutex m;
 	while( m_quit == false )
 	{
-		m.lock();
-		queueReadyWaitCond->wait( &m );
+		// park until there is work for us - wakeWorkers() already took
+		// us off the parked count when posting
+		++parkedWorkers;
+		queueReadySemaphore->wait();
+		if( m_quit )
+		{
+			break;
+		}
 		globalJobQueue.run();
-		m.unlock();
 	}
 }
 
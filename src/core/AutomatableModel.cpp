@@ -24,6 +24,9 @@
 
 #include "AutomatableModel.h"
 
+#include <algorithm>
+#include <thread>
+
 #include "lmms_math.h"
 
 #include "AudioEngine.h"
@@ -32,6 +35,7 @@
 #include "LocaleHelper.h"
 #include "ProjectJournal.h"
 #include "Song.h"
+#include "ValueBufferPool.h"
 
 namespace lmms
 {
@@ -54,9 +58,11 @@ AutomatableModel::AutomatableModel(
 	m_setValueDepth( 0 ),
 	m_hasStrictStepSize( false ),
 	m_controllerConnection( nullptr ),
-	m_valueBuffer( static_cast<int>( Engine::audioEngine()->framesPerPeriod() ) ),
+	m_valueBuffer(nullptr),
 	m_lastUpdatedPeriod( -1 ),
+	m_claimedPeriod( -1 ),
 	m_hasSampleExactData(false),
+	m_valueBufferIdle(false),
 	m_useControllerValue(true)
 
 {
@@ -80,7 +86,7 @@ AutomatableModel::~AutomatableModel()
 		delete m_controllerConnection;
 	}
 
-	m_valueBuffer.clear();
+	releaseValueBuffer();
 
 	emit destroyed( id() );
 }
@@ -301,6 +307,8 @@ void AutomatableModel::setValue( const float value )
 	m_value = fittedValue( value );
 	if( old_val != m_value )
 	{
+		markValueBufferChanged();
+
 		// add changes to history so user can undo it
 		addJournalCheckPoint();
 
@@ -374,6 +382,8 @@ void AutomatableModel::setAutomatedValue( const float value )
 
 	if( oldValue != m_value )
 	{
+		markValueBufferChanged();
+
 		// notify linked models
 		for (const auto& linkedModel : m_linkedModels)
 		{
@@ -392,6 +402,33 @@ void AutomatableModel::setAutomatedValue( const float value )
 
 
 
+void AutomatableModel::setAutomatedValueBuffer(const float* values, fpp_t offset)
+{
+	// only called by the song before the value buffers are used in a period
+	float* nvalues = acquireValueBuffer()->values();
+	const auto length = static_cast<fpp_t>(m_valueBuffer->length());
+	if (m_lastUpdatedPeriod.load(std::memory_order_acquire) != s_periodCounter || !m_hasSampleExactData)
+	{
+		// the automation only starts within this period
+		std::fill_n(nvalues, std::min(offset, length), m_oldValue);
+	}
+	for (fpp_t f = offset; f < length; ++f)
+	{
+		nvalues[f] = fittedValue(scaledValue(values[f - offset]));
+	}
+
+	// setAutomatedValue() has been called for this tick already, so the
+	// value does not need to be ramped to in the next period
+	m_oldValue = m_value;
+	m_hasSampleExactData = true;
+	markValueBufferChanged();
+	m_claimedPeriod.store(s_periodCounter, std::memory_order_relaxed);
+	m_lastUpdatedPeriod.store(s_periodCounter, std::memory_order_release);
+}
+
+
+
+
 void AutomatableModel::setRange( const float min, const float max,
 							const float step )
 {
@@ -464,6 +501,7 @@ void AutomatableModel::linkModel( AutomatableModel* model )
 	if (!containsModel && model != this)
 	{
 		m_linkedModels.push_back( model );
+		markValueBufferChanged();
 
 		if( !model->hasLinkedModels() )
 		{
@@ -538,6 +576,7 @@ void AutomatableModel::unlinkAllModels()
 void AutomatableModel::setControllerConnection( ControllerConnection* c )
 {
 	m_controllerConnection = c;
+	markValueBufferChanged();
 	if( c )
 	{
 		QObject::connect( m_controllerConnection, SIGNAL(valueChanged()),
@@ -589,15 +628,44 @@ float AutomatableModel::controllerValue( int frameOffset ) const
 
 ValueBuffer * AutomatableModel::valueBuffer()
 {
-	QMutexLocker m( &m_valueBufferMutex );
-	// if we've already calculated the valuebuffer this period, return the cached buffer
-	if( m_lastUpdatedPeriod == s_periodCounter )
+	// nothing changed since the last time we found no sample-exact data
+	if (m_valueBufferIdle.load(std::memory_order_acquire))
 	{
-		return m_hasSampleExactData
-			? &m_valueBuffer
-			: nullptr;
+		return nullptr;
 	}
 
+	// The first caller of a period computes the buffer, concurrent callers
+	// wait until it is published, later callers use the published buffer
+	const long period = s_periodCounter;
+	if (m_lastUpdatedPeriod.load(std::memory_order_acquire) != period)
+	{
+		long claimed = m_claimedPeriod.load(std::memory_order_relaxed);
+		if (claimed != period
+			&& m_claimedPeriod.compare_exchange_strong(claimed, period, std::memory_order_acq_rel))
+		{
+			m_hasSampleExactData = updateValueBuffer();
+			m_lastUpdatedPeriod.store(period, std::memory_order_release);
+		}
+		else
+		{
+			while (m_lastUpdatedPeriod.load(std::memory_order_acquire) != period)
+			{
+				std::this_thread::yield();
+			}
+		}
+	}
+
+	return m_hasSampleExactData
+		? m_valueBuffer
+		: nullptr;
+}
+
+
+
+
+bool AutomatableModel::updateValueBuffer()
+{
+	const unsigned version = m_valueVersion.load();
 	float val = m_value; // make sure our m_value doesn't change midway
 
 	if (m_controllerConnection && m_useControllerValue && m_controllerConnection->getController()->isSampleExact())
@@ -606,17 +674,17 @@ ValueBuffer * AutomatableModel::valueBuffer()
 		if( vb )
 		{
 			float * values = vb->values();
-			float * nvalues = m_valueBuffer.values();
+			float * nvalues = acquireValueBuffer()->values();
 			switch( m_scaleType )
 			{
 			case ScaleType::Linear:
-				for( int i = 0; i < m_valueBuffer.length(); i++ )
+				for( int i = 0; i < m_valueBuffer->length(); i++ )
 				{
 					nvalues[i] = minValue<float>() + ( range() * values[i] );
 				}
 				break;
 			case ScaleType::Logarithmic:
-				for( int i = 0; i < m_valueBuffer.length(); i++ )
+				for( int i = 0; i < m_valueBuffer->length(); i++ )
 				{
 					nvalues[i] = logToLinearScale( values[i] );
 				}
@@ -626,9 +694,7 @@ ValueBuffer * AutomatableModel::valueBuffer()
 					"lacks implementation for a scale type");
 				break;
 			}
-			m_lastUpdatedPeriod = s_periodCounter;
-			m_hasSampleExactData = true;
-			return &m_valueBuffer;
+			return true;
 		}
 	}
 
@@ -644,31 +710,60 @@ ValueBuffer * AutomatableModel::valueBuffer()
 		{
 			auto vb = lm->valueBuffer();
 			float * values = vb->values();
-			float * nvalues = m_valueBuffer.values();
+			float * nvalues = acquireValueBuffer()->values();
 			for (int i = 0; i < vb->length(); i++)
 			{
 				nvalues[i] = fittedValue(values[i]);
 			}
-			m_lastUpdatedPeriod = s_periodCounter;
-			m_hasSampleExactData = true;
-			return &m_valueBuffer;
+			return true;
 		}
 	}
 
 	if( m_oldValue != val )
 	{
-		m_valueBuffer.interpolate( m_oldValue, val );
+		acquireValueBuffer()->interpolate( m_oldValue, val );
 		m_oldValue = val;
-		m_lastUpdatedPeriod = s_periodCounter;
-		m_hasSampleExactData = true;
-		return &m_valueBuffer;
+		return true;
+	}
+
+	// give the buffer back until there is sample-exact data again
+	releaseValueBuffer();
+
+	// Nothing to do until something changes. If it changed meanwhile, the
+	// version differs or markValueBufferChanged() stores false afterwards.
+	if (!m_controllerConnection && !hasLinkedModels())
+	{
+		m_valueBufferIdle.store(true);
+		if (m_valueVersion.load() != version)
+		{
+			m_valueBufferIdle.store(false);
+		}
 	}
 
 	// if we have no sample-exact source for a ValueBuffer, return NULL to signify that no data is available at the moment
 	// in which case the recipient knows to use the static value() instead
-	m_lastUpdatedPeriod = s_periodCounter;
-	m_hasSampleExactData = false;
-	return nullptr;
+	return false;
+}
+
+
+
+
+ValueBuffer* AutomatableModel::acquireValueBuffer()
+{
+	if (!m_valueBuffer)
+	{
+		m_valueBuffer = ValueBufferPool::acquire();
+	}
+	return m_valueBuffer;
+}
+
+
+
+
+void AutomatableModel::releaseValueBuffer()
+{
+	ValueBufferPool::release(m_valueBuffer);
+	m_valueBuffer = nullptr;
 }
 
 
@@ -35,7 +35,9 @@
 #include "ProjectJournal.h"
 #include "Song.h"
 
+#include <algorithm>
 #include <cmath>
+#include <limits>
 
 namespace lmms
 {
@@ -156,6 +158,7 @@ void AutomationClip::setProgressionType(
 		_new_progression_type == ProgressionType::CubicHermite )
 	{
 		m_progressionType = _new_progression_type;
+		invalidateSegments();
 		emit dataChanged();
 	}
 }
@@ -173,6 +176,7 @@ void AutomationClip::setTension( QString _new_tension )
 	if( ok && nt > -0.01 && nt < 1.01 )
 	{
 		m_tension = nt;
+		invalidateSegments();
 	}
 }
 
@@ -577,34 +581,66 @@ float AutomationClip::valueAt( const TimePos & _time ) const
 {
 	QMutexLocker m(&m_clipMutex);
 
-	if( m_timeMap.isEmpty() )
+	updateSegments();
+	const int s = segmentAt(_time.getTicks());
+	if (s < 0)
 	{
 		return 0;
 	}
 
-	// If we have a node at that time, just return its value
-	if (m_timeMap.contains(_time))
-	{
-		// When the time is exactly the node's time, we want the inValue
-		return m_timeMap[_time].getInValue();
-	}
+	const Segment& segment = m_segments[s];
+	const int offset = _time - segment.pos;
+	// When the time is exactly the node's time, we want the inValue
+	return offset == 0 ? segment.inValue : segment.valueAt(offset);
+}
 
-	// lowerBound returns next value with equal or greater key. Since we already
-	// checked if the key contains a node, we know the returned node has a greater
-	// key than _time. Therefore we take the previous element to calculate the current value
-	timeMap::const_iterator v = m_timeMap.lowerBound(_time);
 
-	if( v == m_timeMap.begin() )
-	{
-		return 0;
-	}
-	if( v == m_timeMap.end() )
+
+
+void AutomationClip::valuesAt(double time, double step, float* values, int count) const
+{
+	QMutexLocker m(&m_clipMutex);
+
+	updateSegments();
+	int i = 0;
+	while (i < count)
 	{
-		// When the time is after the last node, we want the outValue of it
-		return OUTVAL(v - 1);
-	}
+		const double t = time + i * step;
+		const int s = segmentAt(t);
+
+		// the number of values up to the next node
+		int n = count - i;
+		const double next = s + 1 < static_cast<int>(m_segments.size())
+			? m_segments[s + 1].pos
+			: std::numeric_limits<double>::infinity();
+		if (step > 0 && next != std::numeric_limits<double>::infinity())
+		{
+			n = static_cast<int>(std::clamp(std::ceil((next - t) / step), 1.0, static_cast<double>(n)));
+		}
 
-	return valueAt(v - 1, _time - POS(v - 1));
+		if (s < 0)
+		{
+			std::fill_n(values + i, n, 0.f);
+			i += n;
+			continue;
+		}
+
+		// one pass over the polynomial of this segment
+		const Segment& segment = m_segments[s];
+		const auto offset = static_cast<float>(t - segment.pos);
+		const auto offsetStep = static_cast<float>(step);
+		float* out = values + i;
+		int j = 0;
+		if (offset == 0.f)
+		{
+			out[j++] = segment.inValue;
+		}
+		for (; j < n; ++j)
+		{
+			out[j] = segment.valueAt(offset + j * offsetStep);
+		}
+		i += n;
+	}
 }
 
 
@@ -659,6 +695,72 @@ float AutomationClip::valueAt( timeMap::const_iterator v, int offset ) const
 
 
 
+void AutomationClip::updateSegments() const
+{
+	if (m_segmentsValid.exchange(true)) { return; }
+
+	m_segments.clear();
+	for (auto it = m_timeMap.begin(); it != m_timeMap.end(); ++it)
+	{
+		// discrete steps and the time after the last node only use the outValue
+		auto segment = Segment{POS(it), INVAL(it), OUTVAL(it), 0.f, 0.f, 0.f};
+		if (it + 1 == m_timeMap.end())
+		{
+			m_segments.push_back(segment);
+			break;
+		}
+
+		if (m_progressionType == ProgressionType::Linear)
+		{
+			segment.c1 = (INVAL(it + 1) - OUTVAL(it)) / (POS(it + 1) - POS(it));
+		}
+		else if (m_progressionType == ProgressionType::CubicHermite)
+		{
+			// The Cubic Hermite spline of valueAt(timeMap::const_iterator, int),
+			// expanded into a polynomial of t, with t = offset / numValues
+			const float numValues = POS(it + 1) - POS(it);
+			const float m1 = OUTTAN(it) * numValues * m_tension;
+			const float m2 = INTAN(it + 1) * numValues * m_tension;
+			const float p0 = OUTVAL(it);
+			const float p1 = INVAL(it + 1);
+			segment.c1 = m1 / numValues;
+			segment.c2 = (3 * (p1 - p0) - 2 * m1 - m2) / (numValues * numValues);
+			segment.c3 = (2 * (p0 - p1) + m1 + m2) / (numValues * numValues * numValues);
+		}
+		m_segments.push_back(segment);
+	}
+}
+
+
+
+
+int AutomationClip::segmentAt(double time) const
+{
+	const int size = static_cast<int>(m_segments.size());
+	if (size == 0 || time < m_segments[0].pos)
+	{
+		return -1;
+	}
+
+	// continue from the previous segment unless we jumped back or ahead
+	int s = std::min(m_segmentCursor, size - 1);
+	if (m_segments[s].pos > time || (s + 2 < size && m_segments[s + 2].pos <= time))
+	{
+		s = static_cast<int>(std::upper_bound(m_segments.begin(), m_segments.end(), time,
+			[](double t, const Segment& segment) { return t < segment.pos; }) - m_segments.begin()) - 1;
+	}
+	while (s + 1 < size && m_segments[s + 1].pos <= time)
+	{
+		++s;
+	}
+
+	m_segmentCursor = s;
+	return s;
+}
+
+
+
+
 float *AutomationClip::valuesAfter( const TimePos & _time ) const
 {
 	QMutexLocker m(&m_clipMutex);
@@ -1120,6 +1222,7 @@ void AutomationClip::clear()
 	QMutexLocker m(&m_clipMutex);
 
 	m_timeMap.clear();
+	invalidateSegments();
 
 	emit dataChanged();
 }
@@ -1129,6 +1232,12 @@ void AutomationClip::clear()
 
 void AutomationClip::objectDestroyed( jo_id_t _id )
 {
+	// the song may still continue the automation of the destroyed object
+	if( Engine::getSong() )
+	{
+		Engine::getSong()->clearAutomationSources();
+	}
+
 	QMutexLocker m(&m_clipMutex);
 
 	// TODO: distict between temporary removal (e.g. LADSPA controls
@@ -1190,6 +1299,9 @@ void AutomationClip::generateTangents(timeMap::iterator it, int numToGenerate)
 {
 	QMutexLocker m(&m_clipMutex);
 
+	// every change of the nodes ends up here
+	invalidateSegments();
+
 	for (int i = 0; i < numToGenerate && it != m_timeMap.end(); ++i, ++it)
 	{
 		// Skip the node if it has locked tangents (were manually edited)
@@ -114,4 +114,16 @@ void AutomationNode::resetOutValue()
 	setOutValue(m_inValue);
 }
 
+void AutomationNode::setInTangent(float tangent)
+{
+	m_inTangent = tangent;
+	if (m_clip) { m_clip->invalidateSegments(); }
+}
+
+void AutomationNode::setOutTangent(float tangent)
+{
+	m_outTangent = tangent;
+	if (m_clip) { m_clip->invalidateSegments(); }
+}
+
 } // namespace lmms
\ No newline at end of file
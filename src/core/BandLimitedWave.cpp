@@ -26,11 +26,49 @@
 #include "BandLimitedWave.h"
 
 #include <QDataStream>
+#include <QDateTime>
+#include <QFileInfo>
+
+#include "MappedCache.h"
 
 namespace lmms
 {
 
-std::array<WaveMipMap, BandLimitedWave::NumWaveforms> BandLimitedWave::s_waveforms = {  };
+namespace
+{
+
+const auto WaveformsCacheFile = QStringLiteral("bandlimited-waves.bin");
+//! Bump this whenever the generators change
+constexpr std::uint32_t WaveformsCacheVersion = 1;
+
+//! What the waves are generated from, which is checked when mapping them
+struct WaveformsParameters
+{
+	std::int32_t maxLength = MAXLEN;
+	std::int32_t maxTable = MAXTBL;
+	std::int32_t waveforms = static_cast<std::int32_t>( BandLimitedWave::NumWaveforms );
+	std::int32_t sampleSize = sizeof( sample_t );
+	//! Size and modification time of each wave file, which an update may replace
+	std::array<std::int64_t, 8> waveFiles = {};
+};
+
+WaveformsParameters waveformsParameters( const QString& wavetableDir )
+{
+	auto parameters = WaveformsParameters{};
+	auto field = parameters.waveFiles.begin();
+	for( const auto* name : { "saw.bin", "sqr.bin", "tri.bin", "moog.bin" } )
+	{
+		const auto info = QFileInfo( wavetableDir + name );
+		*field++ = info.exists() ? info.size() : -1;
+		*field++ = info.exists() ? info.lastModified().toMSecsSinceEpoch() : 0;
+	}
+	return parameters;
+}
+
+} // namespace
+
+const BandLimitedWave::Waveforms* BandLimitedWave::s_waveforms = nullptr;
+std::unique_ptr<BandLimitedWave::Waveforms> BandLimitedWave::s_generatedWaveforms;
 bool BandLimitedWave::s_wavesGenerated = false;
 QString BandLimitedWave::s_wavetableDir = "";
 
@@ -67,10 +105,21 @@ void BandLimitedWave::generateWaves()
 // don't generate if they already exist
 	if( s_wavesGenerated ) return;
 
-
 	// set wavetable directory
 	s_wavetableDir = "data:wavetables/";
 
+// use the waves from the previous run if they are cached, which saves parsing the files
+	const auto parameters = waveformsParameters( s_wavetableDir );
+	s_waveforms = MappedCache::map<Waveforms>( WaveformsCacheFile, WaveformsCacheVersion, parameters );
+	if( s_waveforms )
+	{
+		s_wavesGenerated = true;
+		return;
+	}
+
+	auto generated = std::make_unique<Waveforms>();
+	auto& waveforms = *generated;
+
 // set wavetable files
 	QFile saw_file( s_wavetableDir + "saw.bin" );
 	QFile sqr_file( s_wavetableDir + "sqr.bin" );
@@ -83,7 +132,7 @@ void BandLimitedWave::generateWaves()
 	{
 		saw_file.open( QIODevice::ReadOnly );
 		QDataStream in( &saw_file );
-		in >> s_waveforms[static_cast<std::size_t>(BandLimitedWave::Waveform::BLSaw)];
+		in >> waveforms[static_cast<std::size_t>(BandLimitedWave::Waveform::BLSaw)];
 		saw_file.close();
 	}
 	else
@@ -107,14 +156,14 @@ void BandLimitedWave::generateWaves()
 					s += amp * /*a2 **/sin( static_cast<double>( ph * harm ) / static_cast<double>( len ) * F_2PI );
 					harm++;
 				} while( hlen > 2.0 );
-				s_waveforms[static_cast<std::size_t>(BandLimitedWave::Waveform::BLSaw)].setSampleAt( i, ph, s );
+				waveforms[static_cast<std::size_t>(BandLimitedWave::Waveform::BLSaw)].setSampleAt( i, ph, s );
 				max = std::max(max, std::abs(s));
 			}
 			// normalize
 			for( int ph = 0; ph < len; ph++ )
 			{
-				sample_t s = s_waveforms[static_cast<std::size_t>(BandLimitedWave::Waveform::BLSaw)].sampleAt( i, ph ) / max;
-				s_waveforms[static_cast<std::size_t>(BandLimitedWave::Waveform::BLSaw)].setSampleAt( i, ph, s );
+				sample_t s = waveforms[static_cast<std::size_t>(BandLimitedWave::Waveform::BLSaw)].sampleAt( i, ph ) / max;
+				waveforms[static_cast<std::size_t>(BandLimitedWave::Waveform::BLSaw)].setSampleAt( i, ph, s );
 			}
 		}
 	}
@@ -125,7 +174,7 @@ void BandLimitedWave::generateWaves()
 	{
 		sqr_file.open( QIODevice::ReadOnly );
 		QDataStream in( &sqr_file );
-		in >> s_waveforms[static_cast<std::size_t>(BandLimitedWave::Waveform::BLSquare)];
+		in >> waveforms[static_cast<std::size_t>(BandLimitedWave::Waveform::BLSquare)];
 		sqr_file.close();
 	}
 	else
@@ -149,14 +198,14 @@ void BandLimitedWave::generateWaves()
 					s += amp * /*a2 **/ sin( static_cast<double>( ph * harm ) / static_cast<double>( len ) * F_2PI );
 					harm += 2;
 				} while( hlen > 2.0 );
-				s_waveforms[static_cast<std::size_t>(BandLimitedWave::Waveform::BLSquare)].setSampleAt( i, ph, s );
+				waveforms[static_cast<std::size_t>(BandLimitedWave::Waveform::BLSquare)].setSampleAt( i, ph, s );
 				max = std::max(max, std::abs(s));
 			}
 			// normalize
 			for( int ph = 0; ph < len; ph++ )
 			{
-				sample_t s = s_waveforms[static_cast<std::size_t>(BandLimitedWave::Waveform::BLSquare)].sampleAt( i, ph ) / max;
-				s_waveforms[static_cast<std::size_t>(BandLimitedWave::Waveform::BLSquare)].setSampleAt( i, ph, s );
+				sample_t s = waveforms[static_cast<std::size_t>(BandLimitedWave::Waveform::BLSquare)].sampleAt( i, ph ) / max;
+				waveforms[static_cast<std::size_t>(BandLimitedWave::Waveform::BLSquare)].setSampleAt( i, ph, s );
 			}
 		}
 	}
@@ -166,7 +215,7 @@ void BandLimitedWave::generateWaves()
 	{
 		tri_file.open( QIODevice::ReadOnly );
 		QDataStream in( &tri_file );
-		in >> s_waveforms[static_cast<std::size_t>(BandLimitedWave::Waveform::BLTriangle)];
+		in >> waveforms[static_cast<std::size_t>(BandLimitedWave::Waveform::BLTriangle)];
 		tri_file.close();
 	}
 	else
@@ -191,14 +240,14 @@ void BandLimitedWave::generateWaves()
 							( ( harm + 1 ) % 4 == 0 ? 0.5 : 0.0 ) ) * F_2PI );
 					harm += 2;
 				} while( hlen > 2.0 );
-				s_waveforms[static_cast<std::size_t>(BandLimitedWave::Waveform::BLTriangle)].setSampleAt( i, ph, s );
+				waveforms[static_cast<std::size_t>(BandLimitedWave::Waveform::BLTriangle)].setSampleAt( i, ph, s );
 				max = std::max(max, std::abs(s));
 			}
 			// normalize
 			for( int ph = 0; ph < len; ph++ )
 			{
-				sample_t s = s_waveforms[static_cast<std::size_t>(BandLimitedWave::Waveform::BLTriangle)].sampleAt( i, ph ) / max;
-				s_waveforms[static_cast<std::size_t>(BandLimitedWave::Waveform::BLTriangle)].setSampleAt( i, ph, s );
+				sample_t s = waveforms[static_cast<std::size_t>(BandLimitedWave::Waveform::BLTriangle)].sampleAt( i, ph ) / max;
+				waveforms[static_cast<std::size_t>(BandLimitedWave::Waveform::BLTriangle)].setSampleAt( i, ph, s );
 			}
 		}
 	}
@@ -209,7 +258,7 @@ void BandLimitedWave::generateWaves()
 	{
 		moog_file.open( QIODevice::ReadOnly );
 		QDataStream in( &moog_file );
-		in >> s_waveforms[static_cast<std::size_t>(BandLimitedWave::Waveform::BLMoog)];
+		in >> waveforms[static_cast<std::size_t>(BandLimitedWave::Waveform::BLMoog)];
 		moog_file.close();
 	}
 	else
@@ -221,13 +270,24 @@ void BandLimitedWave::generateWaves()
 			for( int ph = 0; ph < len; ph++ )
 			{
 				const int sawph = ( ph + static_cast<int>( len * 0.75 ) ) % len;
-				const sample_t saw = s_waveforms[static_cast<std::size_t>(BandLimitedWave::Waveform::BLSaw)].sampleAt( i, sawph );
-				const sample_t tri = s_waveforms[static_cast<std::size_t>(BandLimitedWave::Waveform::BLTriangle)].sampleAt( i, ph );
-				s_waveforms[static_cast<std::size_t>(BandLimitedWave::Waveform::BLMoog)].setSampleAt( i, ph, ( saw + tri ) * 0.5f );
+				const sample_t saw = waveforms[static_cast<std::size_t>(BandLimitedWave::Waveform::BLSaw)].sampleAt( i, sawph );
+				const sample_t tri = waveforms[static_cast<std::size_t>(BandLimitedWave::Waveform::BLTriangle)].sampleAt( i, ph );
+				waveforms[static_cast<std::size_t>(BandLimitedWave::Waveform::BLMoog)].setSampleAt( i, ph, ( saw + tri ) * 0.5f );
 			}
 		}
 	}
 
+// cache them and map the cache file, so the pages are shared with other instances
+	if( MappedCache::store( WaveformsCacheFile, WaveformsCacheVersion, waveforms, parameters ) )
+	{
+		s_waveforms = MappedCache::map<Waveforms>( WaveformsCacheFile, WaveformsCacheVersion, parameters );
+	}
+	if( !s_waveforms )
+	{
+		s_generatedWaveforms = std::move( generated );
+		s_waveforms = s_generatedWaveforms.get();
+	}
+
 // set the generated flag so we don't load/generate them again needlessly
 	s_wavesGenerated = true;
 
@@ -251,22 +311,22 @@ QFile moogfile( "path-to-wavetables/moog.bin" );
 
 sawfile.open( QIODevice::WriteOnly );
 QDataStream sawout( &sawfile );
-sawout << s_waveforms[static_cast<std::size_t>(BandLimitedWave::Waveform::BLSaw)];
+sawout << waveforms[static_cast<std::size_t>(BandLimitedWave::Waveform::BLSaw)];
 sawfile.close();
 
 sqrfile.open( QIODevice::WriteOnly );
 QDataStream sqrout( &sqrfile );
-sqrout << s_waveforms[static_cast<std::size_t>(BandLimitedWave::Waveform::BLSquare)];
+sqrout << waveforms[static_cast<std::size_t>(BandLimitedWave::Waveform::BLSquare)];
 sqrfile.close();
 
 trifile.open( QIODevice::WriteOnly );
 QDataStream triout( &trifile );
-triout << s_waveforms[static_cast<std::size_t>(BandLimitedWave::Waveform::BLTriangle)];
+triout << waveforms[static_cast<std::size_t>(BandLimitedWave::Waveform::BLTriangle)];
 trifile.close();
 
 moogfile.open( QIODevice::WriteOnly );
 QDataStream moogout( &moogfile );
-moogout << s_waveforms[static_cast<std::size_t>(BandLimitedWave::Waveform::BLMoog)];
+moogout << waveforms[static_cast<std::size_t>(BandLimitedWave::Waveform::BLMoog)];
 moogfile.close();
 
 */
@@ -26,32 +26,57 @@
 
 #include "BufferManager.h"
 
-#include "SampleFrame.h"
+#include <memory>
 
-#include <cstring>
+#include "SampleFrame.h"
 
 
 namespace lmms
 {
 
+static constexpr std::uint32_t INITIAL_BUFFERS = 256;
+static constexpr std::uint32_t BUFFER_REFILL_WATERMARK = 64;
+static constexpr std::uint32_t BUFFER_REFILL_STEP = 256;
+static constexpr std::uint32_t MAX_POOLED_BUFFERS = 16384;
+
+static std::unique_ptr<LocklessPool> s_pool;
+
 fpp_t BufferManager::s_framesPerPeriod;
 
 void BufferManager::init( fpp_t fpp )
 {
 	s_framesPerPeriod = fpp;
+	s_pool = std::make_unique<LocklessPool>(fpp * sizeof(SampleFrame), INITIAL_BUFFERS,
+		BUFFER_REFILL_WATERMARK, BUFFER_REFILL_STEP, MAX_POOLED_BUFFERS);
 }
 
 
 SampleFrame* BufferManager::acquire()
 {
-	return new SampleFrame[s_framesPerPeriod];
+	auto buf = static_cast<SampleFrame*>(s_pool->alloc());
+	std::uninitialized_value_construct_n(buf, s_framesPerPeriod);
+	return buf;
 }
 
 
 
 void BufferManager::release( SampleFrame* buf )
 {
-	delete[] buf;
+	if (buf) { s_pool->free(buf); }
+}
+
+
+
+auto BufferManager::statistics() -> Statistics
+{
+	return s_pool->statistics();
+}
+
+
+
+void BufferManager::resetHighWaterMark()
+{
+	s_pool->resetHighWaterMark();
 }
 
 } // namespace lmms
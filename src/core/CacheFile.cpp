@@ -0,0 +1,77 @@
+/*
+ * CacheFile.cpp - versioned data streams in the cache directory
+ *
+ * This file is part of LMMS - https://lmms.io
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this program (see COPYING); if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301 USA.
+ *
+ */
+
+#include "CacheFile.h"
+
+#include <QDataStream>
+#include <QDir>
+#include <QFile>
+#include <QSaveFile>
+
+#include "ConfigManager.h"
+
+namespace lmms::CacheFile
+{
+
+namespace
+{
+
+constexpr quint32 Magic = 0x4c4d4d43;
+constexpr auto StreamVersion = QDataStream::Qt_5_0;
+
+} // namespace
+
+
+bool read(const QString& name, quint32 version, const std::function<void(QDataStream&)>& read)
+{
+	auto file = QFile{ConfigManager::inst()->cacheDir() + name};
+	if (!file.open(QIODevice::ReadOnly)) { return false; }
+
+	auto in = QDataStream{&file};
+	in.setVersion(StreamVersion);
+	auto magic = quint32{0};
+	auto fileVersion = quint32{0};
+	in >> magic >> fileVersion;
+	if (in.status() != QDataStream::Ok || magic != Magic || fileVersion != version) { return false; }
+
+	read(in);
+	return in.status() == QDataStream::Ok;
+}
+
+
+bool write(const QString& name, quint32 version, const std::function<void(QDataStream&)>& write)
+{
+	const auto dir = ConfigManager::inst()->cacheDir();
+	if (!QDir{}.mkpath(dir)) { return false; }
+
+	auto file = QSaveFile{dir + name};
+	if (!file.open(QIODevice::WriteOnly)) { return false; }
+
+	auto out = QDataStream{&file};
+	out.setVersion(StreamVersion);
+	out << Magic << version;
+	write(out);
+	return out.status() == QDataStream::Ok && file.commit();
+}
+
+
+} // namespace lmms::CacheFile
@@ -95,6 +95,7 @@ void Clip::movePosition( const TimePos & pos )
 	{
 		Engine::audioEngine()->requestChangeInModel();
 		m_startPosition = newPos;
+		if (getTrack()) { getTrack()->invalidateClipIndex(); }
 		Engine::audioEngine()->doneChangeInModel();
 		Engine::getSong()->updateLength();
 		emit positionChanged();
@@ -114,6 +115,7 @@ void Clip::movePosition( const TimePos & pos )
 void Clip::changeLength( const TimePos & length )
 {
 	m_length = length;
+	if (getTrack()) { getTrack()->invalidateClipIndex(); }
 	Engine::getSong()->updateLength();
 	emit lengthChanged();
 }
@@ -225,6 +225,11 @@ bool ConfigManager::hasWorkingDir() const
 	return QDir(m_workingDir).exists();
 }
 
+QString ConfigManager::cacheDir() const
+{
+	return QStandardPaths::writableLocation(QStandardPaths::GenericCacheLocation) + "/lmms/";
+}
+
 
 void ConfigManager::setWorkingDir(const QString & workingDir)
 {
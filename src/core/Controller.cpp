@@ -34,6 +34,7 @@
 #include "LfoController.h"
 #include "MidiController.h"
 #include "PeakController.h"
+#include "ValueBufferPool.h"
 
 namespace lmms
 {
@@ -48,7 +49,9 @@ Controller::Controller( ControllerType _type, Model * _parent,
 					const QString & _display_name ) :
 	Model( _parent, _display_name ),
 	JournallingObject(),
-	m_valueBuffer( Engine::audioEngine()->framesPerPeriod() ),
+	// acquired up front: valueBuffer() is called from both the GUI and
+	// the audio threads, which must not race to acquire it
+	m_valueBuffer( ValueBufferPool::acquire() ),
 	m_bufferLastUpdated( -1 ),
 	m_connectionCount( 0 ),
 	m_type( _type )
@@ -79,7 +82,6 @@ Controller::Controller( ControllerType _type, Model * _parent,
 			}
 		}
 	}
-	updateValueBuffer();
 }
 
 
@@ -92,7 +94,7 @@ Controller::~Controller()
 		s_controllers.erase(it);
 	}
 
-	m_valueBuffer.clear();
+	ValueBufferPool::release( m_valueBuffer );
 	// Remove connections by destroyed signal
 }
 
@@ -113,11 +115,7 @@ float Controller::currentValue( int _offset )
 
 float Controller::value( int offset )
 {
-	if( m_bufferLastUpdated != s_periods )
-	{
-		updateValueBuffer();
-	}
-	return m_valueBuffer.values()[ offset ];
+	return valueBuffer()->values()[ offset ];
 }
 	
 
@@ -127,13 +125,13 @@ ValueBuffer * Controller::valueBuffer()
 	{
 		updateValueBuffer();
 	}
-	return &m_valueBuffer;
+	return m_valueBuffer;
 }
 
 
 void Controller::updateValueBuffer()
 {
-	m_valueBuffer.fill(0.5f);
+	m_valueBuffer->fill(0.5f);
 	m_bufferLastUpdated = s_periods;
 }
 
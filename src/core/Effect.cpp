@@ -24,6 +24,7 @@
  */
 
 #include <QDomElement>
+#include <cassert>
 
 #include "Effect.h"
 #include "EffectChain.h"
@@ -31,6 +32,7 @@
 #include "EffectView.h"
 
 #include "ConfigManager.h"
+#include "PlanarBuffer.h"
 #include "SampleFrame.h"
 #include "lmms_constants.h"
 
@@ -47,6 +49,7 @@ Effect::Effect( const Plugin::Descriptor * _desc,
 	m_okay( true ),
 	m_noRun( false ),
 	m_running( false ),
+	m_planar( false ),
 	m_bufferCount( 0 ),
 	m_enabledModel( true, this, tr( "Effect enabled" ) ),
 	m_wetDryModel( 1.0f, -1.0f, 1.0f, 0.01f, this, tr( "Wet/Dry mix" ) ),
@@ -130,6 +133,7 @@ bool Effect::processAudioBuffer(SampleFrame* buf, const fpp_t frames)
 		return false;
 	}
 
+	const auto cpuTimeScope = CpuTimeCounter::Scope{m_cpuTime};
 	const auto status = processImpl(buf, frames);
 	switch (status)
 	{
@@ -158,6 +162,48 @@ bool Effect::processAudioBuffer(SampleFrame* buf, const fpp_t frames)
 
 
 
+bool Effect::processAudioBuffer(PlanarBuffer& buf, const fpp_t frames)
+{
+	assert(isPlanar());
+	if (!isOkay() || dontRun() || !isEnabled() || !isRunning())
+	{
+		processBypassedImpl();
+		return false;
+	}
+
+	const auto cpuTimeScope = CpuTimeCounter::Scope{m_cpuTime};
+	const auto status = processPlanarImpl(buf, frames);
+	switch (status)
+	{
+		case ProcessStatus::Continue:
+			break;
+		case ProcessStatus::ContinueIfNotQuiet:
+		{
+			double outSum = 0.0;
+			for (ch_cnt_t ch = 0; ch < DEFAULT_CHANNELS; ++ch)
+			{
+				const sample_t* samples = buf.channel(ch);
+				for (std::size_t idx = 0; idx < frames; ++idx)
+				{
+					outSum += samples[idx] * samples[idx];
+				}
+			}
+
+			checkGate(outSum / frames);
+			break;
+		}
+		case ProcessStatus::Sleep:
+			return false;
+		default:
+			break;
+	}
+
+	return isRunning();
+}
+
+
+
+
 Effect * Effect::instantiate( const QString& pluginName,
 				Model * _parent,
 				Descriptor::SubPluginFeatures::Key * _key )
@@ -39,7 +39,8 @@ namespace lmms
 EffectChain::EffectChain( Model * _parent ) :
 	Model( _parent ),
 	SerializingObject(),
-	m_enabledModel( false, nullptr, tr( "Effects enabled" ) )
+	m_enabledModel( false, nullptr, tr( "Effects enabled" ) ),
+	m_planarBuffer( Engine::audioEngine()->framesPerPeriod() )
 {
 }
 
@@ -193,16 +194,40 @@ bool EffectChain::processAudioBuffer( SampleFrame* _buf, const fpp_t _frames, bo
 
 	MixHelpers::sanitize( _buf, _frames );
 
+	// the signal is only converted where planar and interleaved effects meet
+	bool planar = false;
 	bool moreEffects = false;
 	for (const auto& effect : m_effects)
 	{
-		if (hasInputNoise || effect->isRunning())
+		if (!hasInputNoise && !effect->isRunning()) { continue; }
+
+		if (effect->isPlanar())
+		{
+			if (!planar)
+			{
+				m_planarBuffer.deinterleave(_buf, _frames);
+				planar = true;
+			}
+			moreEffects |= effect->processAudioBuffer(m_planarBuffer, _frames);
+			MixHelpers::sanitize(m_planarBuffer, _frames);
+		}
+		else
 		{
+			if (planar)
+			{
+				m_planarBuffer.interleave(_buf, _frames);
+				planar = false;
+			}
 			moreEffects |= effect->processAudioBuffer(_buf, _frames);
 			MixHelpers::sanitize(_buf, _frames);
 		}
 	}
 
+	if (planar)
+	{
+		m_planarBuffer.interleave(_buf, _frames);
+	}
+
 	return moreEffects;
 }
 
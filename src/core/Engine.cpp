@@ -24,18 +24,28 @@
 
 
 #include "Engine.h"
+
+#include <cstdlib>
+#include <functional>
+#include <future>
+#include <optional>
+#include <vector>
+
 #include "AudioEngine.h"
 #include "ConfigManager.h"
 #include "Mixer.h"
 #include "Ladspa2LMMS.h"
 #include "Lv2Manager.h"
 #include "PatternStore.h"
+#include "PerfLog.h"
 #include "Plugin.h"
+#include "PluginFactory.h"
 #include "PresetPreviewPlayHandle.h"
 #include "ProjectJournal.h"
 #include "Song.h"
 #include "BandLimitedWave.h"
 #include "Oscillator.h"
+#include "ThreadPool.h"
 
 namespace lmms
 {
@@ -59,11 +69,36 @@ void Engine::init( bool renderOnly )
 {
 	Engine *engine = inst();
 
+	// Timing the start-up is only of interest when working on it
+	const char* perfLogStr = std::getenv("LMMS_STARTUP_PERFLOG");
+	const bool perfLog = perfLogStr && *perfLogStr;
+	auto startupTimer = std::optional<PerfLogTimer>{};
+	if (perfLog) { startupTimer.emplace("Engine startup"); }
+
+	// The independent parts of the start-up run on the thread pool. A task is always
+	// enqueued after the tasks it depends on, so waiting for them can not starve the pool.
+	using Task = std::shared_future<void>;
+	auto startTask = [perfLog](const char* name, std::function<void()> fn, std::vector<Task> dependencies = {})
+	{
+		return ThreadPool::instance().enqueue([perfLog, name, fn, dependencies]
+		{
+			for (const auto& dependency : dependencies) { dependency.wait(); }
+			auto timer = std::optional<PerfLogTimer>{};
+			if (perfLog) { timer.emplace(name); }
+			fn();
+		}).share();
+	};
+
+	// The tasks read the configuration, so it must not be created lazily by one of them
+	ConfigManager::inst();
+
 	emit engine->initProgress(tr("Generating wavetables"));
 	// generate (load from file) bandlimited wavetables
-	BandLimitedWave::generateWaves();
+	const auto bandLimitedWaves = startTask("Band-limited waves", &BandLimitedWave::generateWaves);
 	//initilize oscillators
-	Oscillator::waveTableInit();
+	const auto waveTables = startTask("Oscillator wavetables", &Oscillator::waveTableInit);
+	auto pluginManagers = std::vector<Task>{};
+	pluginManagers.push_back(startTask("LADSPA scan", [] { s_ladspaManager = new Ladspa2LMMS; }));
 
 	emit engine->initProgress(tr("Initializing data structures"));
 	s_projectJournal = new ProjectJournal;
@@ -73,16 +108,24 @@ void Engine::init( bool renderOnly )
 	s_patternStore = new PatternStore;
 
 #ifdef LMMS_HAVE_LV2
-	s_lv2Manager = new Lv2Manager;
-	s_lv2Manager->initPlugins();
+	// Lv2Manager reads the period size from the audio engine
+	pluginManagers.push_back(startTask("LV2 world", []
+	{
+		s_lv2Manager = new Lv2Manager;
+		s_lv2Manager->initPlugins();
+	}));
 #endif
-	s_ladspaManager = new Ladspa2LMMS;
+	// Plugins with sub-plugins list them from the LADSPA and LV2 managers
+	const auto plugins = startTask("Plugin discovery", [] { PluginFactory::instance(); }, pluginManagers);
 
 	s_projectJournal->setJournalling( true );
 
 	emit engine->initProgress(tr("Opening audio and midi devices"));
 	s_audioEngine->initDevices();
 
+	emit engine->initProgress(tr("Loading plugins"));
+	for (const auto& task : {bandLimitedWaves, waveTables, plugins}) { task.wait(); }
+
 	PresetPreviewPlayHandle::init();
 
 	emit engine->initProgress(tr("Launching audio engine threads"));
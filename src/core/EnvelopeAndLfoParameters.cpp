@@ -27,6 +27,9 @@
 #include <QDomElement>
 #include <QFileInfo>
 
+#include <array>
+#include <thread>
+
 #include "AudioEngine.h"
 #include "Engine.h"
 #include "Oscillator.h"
@@ -43,19 +46,17 @@ extern const float SECS_PER_ENV_SEGMENT = 5.0f;
 extern const float SECS_PER_LFO_OSCILLATION = 20.0f;
 // minimum number of frames for ENV/LFO stages that mustn't be '0'
 const f_cnt_t minimumFrames = 1;
+// envelope levels are computed in chunks of this many frames on the stack
+constexpr fpp_t EnvelopeChunkFrames = 256;
 
 
-EnvelopeAndLfoParameters::LfoInstances * EnvelopeAndLfoParameters::s_lfoInstances = nullptr;
+EnvelopeAndLfoParameters::LfoInstances EnvelopeAndLfoParameters::s_lfoInstances;
 
 
 void EnvelopeAndLfoParameters::LfoInstances::trigger()
 {
-	QMutexLocker m( &m_lfoListMutex );
-	for (const auto& lfo : m_lfos)
-	{
-		lfo->m_lfoFrame += Engine::audioEngine()->framesPerPeriod();
-		lfo->m_bad_lfoShapeData = true;
-	}
+	m_frame.fetch_add(Engine::audioEngine()->framesPerPeriod(), std::memory_order_relaxed);
+	m_period.fetch_add(1, std::memory_order_relaxed);
 }
 
 
@@ -63,30 +64,9 @@ void EnvelopeAndLfoParameters::LfoInstances::trigger()
 
 void EnvelopeAndLfoParameters::LfoInstances::reset()
 {
-	QMutexLocker m( &m_lfoListMutex );
-	for (const auto& lfo : m_lfos)
-	{
-		lfo->m_lfoFrame = 0;
-		lfo->m_bad_lfoShapeData = true;
-	}
-}
-
-
-
-
-void EnvelopeAndLfoParameters::LfoInstances::add( EnvelopeAndLfoParameters * lfo )
-{
-	QMutexLocker m( &m_lfoListMutex );
-	m_lfos.append( lfo );
-}
-
-
-
-
-void EnvelopeAndLfoParameters::LfoInstances::remove( EnvelopeAndLfoParameters * lfo )
-{
-	QMutexLocker m( &m_lfoListMutex );
-	m_lfos.removeAll( lfo );
+	// LFOs started before this use an offset of 0 from now on
+	m_frame.store(0, std::memory_order_relaxed);
+	m_resets.fetch_add(1, std::memory_order_relaxed);
 }
 
 
@@ -107,10 +87,6 @@ EnvelopeAndLfoParameters::EnvelopeAndLfoParameters(
 	m_valueForZeroAmount( _value_for_zero_amount ),
 	m_pahdFrames( 0 ),
 	m_rFrames( 0 ),
-	m_pahdEnv( nullptr ),
-	m_rEnv( nullptr ),
-	m_pahdBufSize( 0 ),
-	m_rBufSize( 0 ),
 	m_lfoPredelayModel(0.f, 0.f, 1.f, 0.001f, this, tr("LFO pre-delay")),
 	m_lfoAttackModel(0.f, 0.f, 1.f, 0.001f, this, tr("LFO attack")),
 	m_lfoSpeedModel(0.1f, 0.001f, 1.f, 0.0001f,
@@ -120,20 +96,17 @@ EnvelopeAndLfoParameters::EnvelopeAndLfoParameters(
 	m_lfoWaveModel( static_cast<int>(LfoShape::SineWave), 0, NumLfoShapes, this, tr( "LFO wave shape" ) ),
 	m_x100Model( false, this, tr( "LFO frequency x 100" ) ),
 	m_controlEnvAmountModel( false, this, tr( "Modulate env amount" ) ),
-	m_lfoFrame( 0 ),
-	m_lfoAmountIsZero( false ),
-	m_lfoShapeData(nullptr)
+	m_levels(Engine::audioEngine()->rcuDomain()),
+	m_lfoFrameOffset(instances()->frame()),
+	m_lfoResets(instances()->resets()),
+	m_lfoShapeData(Engine::audioEngine()->framesPerPeriod()),
+	m_lfoShapePeriod(-1),
+	m_lfoShapeClaimedPeriod(-1),
+	m_random(0.f)
 {
 	m_amountModel.setCenterValue( 0 );
 	m_lfoAmountModel.setCenterValue( 0 );
 
-	if( s_lfoInstances == nullptr )
-	{
-		s_lfoInstances = new LfoInstances();
-	}
-
-	instances()->add( this );
-
 	connect( &m_predelayModel, SIGNAL(dataChanged()),
 			this, SLOT(updateSampleVars()), Qt::DirectConnection );
 	connect( &m_attackModel, SIGNAL(dataChanged()),
@@ -161,14 +134,12 @@ EnvelopeAndLfoParameters::EnvelopeAndLfoParameters(
 			this, SLOT(updateSampleVars()), Qt::DirectConnection );
 	connect( &m_x100Model, SIGNAL(dataChanged()),
 			this, SLOT(updateSampleVars()), Qt::DirectConnection );
+	connect( &m_controlEnvAmountModel, SIGNAL(dataChanged()),
+			this, SLOT(updateSampleVars()), Qt::DirectConnection );
 
 	connect( Engine::audioEngine(), SIGNAL(sampleRateChanged()),
 				this, SLOT(updateSampleVars()));
 
-
-	m_lfoShapeData =
-		new sample_t[Engine::audioEngine()->framesPerPeriod()];
-
 	updateSampleVars();
 }
 
@@ -190,103 +161,172 @@ EnvelopeAndLfoParameters::~EnvelopeAndLfoParameters()
 	m_lfoAmountModel.disconnect( this );
 	m_lfoWaveModel.disconnect( this );
 	m_x100Model.disconnect( this );
+	m_controlEnvAmountModel.disconnect( this );
+}
 
-	delete[] m_pahdEnv;
-	delete[] m_rEnv;
-	delete[] m_lfoShapeData;
 
-	instances()->remove( this );
 
-	if( instances()->isEmpty() )
+
+float EnvelopeAndLfoParameters::Levels::envelopeLevel(f_cnt_t frame) const
+{
+	f_cnt_t begin = 0;
+	for (const auto& segment : pahd)
 	{
-		delete instances();
-		s_lfoInstances = nullptr;
+		if (frame < segment.end)
+		{
+			return static_cast<float>(frame - begin) * segment.slope + segment.base;
+		}
+		begin = segment.end;
 	}
+	return sustainLevel;
 }
 
 
 
 
-inline sample_t EnvelopeAndLfoParameters::lfoShapeSample( fpp_t _frame_offset )
+void EnvelopeAndLfoParameters::updateLfoShapeData(const Levels& levels)
 {
-	f_cnt_t frame = ( m_lfoFrame + _frame_offset ) % m_lfoOscillationFrames;
-	const float phase = frame / static_cast<float>(
-						m_lfoOscillationFrames );
-	sample_t shape_sample;
-	switch( static_cast<LfoShape>(m_lfoWaveModel.value())  )
+	const auto& lfos = *instances();
+	const f_cnt_t lfoFrame = lfos.frame() - (lfos.resets() == m_lfoResets ? m_lfoFrameOffset : 0);
+	const f_cnt_t oscillationFrames = levels.lfoOscillationFrames;
+	const float amount = levels.lfoAmount;
+
+	// the wave shape is chosen once per period, not per sample
+	const auto fill = [&](auto shapeSample)
+	{
+		f_cnt_t frame = lfoFrame % oscillationFrames;
+		for (auto& sample : m_lfoShapeData)
+		{
+			sample = shapeSample(frame, frame / static_cast<float>(oscillationFrames)) * amount;
+			if (++frame == oscillationFrames) { frame = 0; }
+		}
+	};
+
+	switch (levels.lfoShape)
 	{
 		case LfoShape::TriangleWave:
-			shape_sample = Oscillator::triangleSample( phase );
+			fill([](f_cnt_t, float phase) { return Oscillator::triangleSample(phase); });
 			break;
 		case LfoShape::SquareWave:
-			shape_sample = Oscillator::squareSample( phase );
+			fill([](f_cnt_t, float phase) { return Oscillator::squareSample(phase); });
 			break;
 		case LfoShape::SawWave:
-			shape_sample = Oscillator::sawSample( phase );
+			fill([](f_cnt_t, float phase) { return Oscillator::sawSample(phase); });
 			break;
 		case LfoShape::UserDefinedWave:
-			shape_sample = Oscillator::userWaveSample(m_userWave.get(), phase);
+			fill([wave = levels.userWave.get()](f_cnt_t, float phase) {
+				return Oscillator::userWaveSample(wave, phase);
+			});
 			break;
 		case LfoShape::RandomWave:
-			if( frame == 0 )
-			{
-				m_random = Oscillator::noiseSample( 0.0f );
-			}
-			shape_sample = m_random;
+			fill([this](f_cnt_t frame, float) {
+				if (frame == 0) { m_random = Oscillator::noiseSample(0.0f); }
+				return m_random;
+			});
 			break;
 		case LfoShape::SineWave:
 		default:
-			shape_sample = Oscillator::sinSample( phase );
+			fill([](f_cnt_t, float phase) { return Oscillator::sinSample(phase); });
 			break;
 	}
-	return shape_sample * m_lfoAmount;
 }
 
 
 
 
-void EnvelopeAndLfoParameters::updateLfoShapeData()
+const sample_t* EnvelopeAndLfoParameters::lfoShapeData(const Levels& levels)
 {
-	const fpp_t frames = Engine::audioEngine()->framesPerPeriod();
-	for( fpp_t offset = 0; offset < frames; ++offset )
+	const long period = instances()->period();
+	if (m_lfoShapePeriod.load(std::memory_order_acquire) != period)
 	{
-		m_lfoShapeData[offset] = lfoShapeSample( offset );
+		long claimed = m_lfoShapeClaimedPeriod.load(std::memory_order_relaxed);
+		if (claimed != period
+			&& m_lfoShapeClaimedPeriod.compare_exchange_strong(claimed, period, std::memory_order_acq_rel))
+		{
+			updateLfoShapeData(levels);
+			m_lfoShapePeriod.store(period, std::memory_order_release);
+		}
+		else
+		{
+			while (m_lfoShapePeriod.load(std::memory_order_acquire) != period)
+			{
+				std::this_thread::yield();
+			}
+		}
 	}
-	m_bad_lfoShapeData = false;
+	return m_lfoShapeData.data();
 }
 
 
 
 
-inline void EnvelopeAndLfoParameters::fillLfoLevel( float * _buf,
-							f_cnt_t _frame,
-							const fpp_t _frames )
+void EnvelopeAndLfoParameters::fillLfoLevel(const Levels& levels, float* buf,
+	f_cnt_t frame, const fpp_t frames)
 {
-	if( m_lfoAmountIsZero || _frame <= m_lfoPredelayFrames )
+	if (levels.lfoAmountIsZero || frame <= levels.lfoPredelayFrames)
 	{
-		for( fpp_t offset = 0; offset < _frames; ++offset )
-		{
-			*_buf++ = 0.0f;
-		}
+		std::fill_n(buf, frames, 0.0f);
 		return;
 	}
-	_frame -= m_lfoPredelayFrames;
+	frame -= levels.lfoPredelayFrames;
+
+	const sample_t* shape = lfoShapeData(levels);
 
-	if( m_bad_lfoShapeData )
+	const auto attack = frame < levels.lfoAttackFrames
+		? static_cast<int>(std::min<f_cnt_t>(frames, levels.lfoAttackFrames - frame))
+		: 0;
+	const float lafI = 1.0f / std::max(minimumFrames, levels.lfoAttackFrames);
+	const auto attackFrame = static_cast<int>(frame);
+	for (int offset = 0; offset < attack; ++offset)
 	{
-		updateLfoShapeData();
+		buf[offset] = shape[offset] * static_cast<float>(attackFrame + offset) * lafI;
 	}
+	std::copy(shape + attack, shape + frames, buf + attack);
+}
+
+
 
+
+void EnvelopeAndLfoParameters::fillEnvelopeLevel(const Levels& levels, float* buf,
+	f_cnt_t frame, const f_cnt_t releaseBegin, const fpp_t frames) const
+{
+	// fill each linear piece of the envelope in one go, so the loops vectorize
 	fpp_t offset = 0;
-	const float lafI = 1.0f / std::max(minimumFrames, m_lfoAttackFrames);
-	for( ; offset < _frames && _frame < m_lfoAttackFrames; ++offset,
-								++_frame )
+	const auto piece = [&](f_cnt_t end) -> int
+	{
+		return frame < end ? static_cast<int>(std::min<f_cnt_t>(frames - offset, end - frame)) : 0;
+	};
+
+	f_cnt_t begin = 0;
+	for (const auto& segment : levels.pahd)
 	{
-		*_buf++ = m_lfoShapeData[offset] * _frame * lafI;
+		const int count = piece(std::min(segment.end, releaseBegin));
+		const auto start = static_cast<int>(frame - begin);
+		for (int i = 0; i < count; ++i)
+		{
+			buf[offset + i] = static_cast<float>(start + i) * segment.slope + segment.base;
+		}
+		offset += count;
+		frame += count;
+		begin = segment.end;
 	}
-	for( ; offset < _frames; ++offset )
+
+	const int sustain = piece(releaseBegin);
+	std::fill_n(buf + offset, sustain, levels.sustainLevel);
+	offset += sustain;
+	frame += sustain;
+
+	if (offset < frames)
 	{
-		*_buf++ = m_lfoShapeData[offset];
+		const float releaseLevel = levels.envelopeLevel(releaseBegin);
+		const int count = piece(releaseBegin + levels.releaseFrames);
+		const auto remaining = static_cast<int>(releaseBegin + levels.releaseFrames - frame);
+		for (int i = 0; i < count; ++i)
+		{
+			buf[offset + i] = static_cast<float>(remaining - i) * levels.releaseSlope * releaseLevel;
+		}
+		offset += count;
+		std::fill_n(buf + offset, frames - offset, 0.0f);
 	}
 }
 
@@ -297,39 +337,33 @@ void EnvelopeAndLfoParameters::fillLevel( float * _buf, f_cnt_t _frame,
 						const f_cnt_t _release_begin,
 						const fpp_t _frames )
 {
-	QMutexLocker m(&m_paramMutex);
+	const Levels& levels = m_levels.read();
 
-	fillLfoLevel( _buf, _frame, _frames );
+	fillLfoLevel(levels, _buf, _frame, _frames);
 
-	for( fpp_t offset = 0; offset < _frames; ++offset, ++_buf, ++_frame )
+	// at this point, _buf is LFO level, which is combined with the envelope
+	// in chunks, so any period length works without allocating
+	std::array<float, EnvelopeChunkFrames> envBuffer;
+	for (fpp_t chunkBegin = 0; chunkBegin < _frames; chunkBegin += EnvelopeChunkFrames)
 	{
-		float env_level;
-		if( _frame < _release_begin )
+		const fpp_t chunk = std::min(_frames - chunkBegin, EnvelopeChunkFrames);
+		float* buf = _buf + chunkBegin;
+		fillEnvelopeLevel(levels, envBuffer.data(), _frame + chunkBegin, _release_begin, chunk);
+
+		if (levels.controlEnvAmount)
 		{
-			if( _frame < m_pahdFrames )
+			for (fpp_t offset = 0; offset < chunk; ++offset)
 			{
-				env_level = m_pahdEnv[_frame];
+				buf[offset] = envBuffer[offset] * (0.5f + buf[offset]);
 			}
-			else
-			{
-				env_level = m_sustainLevel;
-			}
-		}
-		else if( ( _frame - _release_begin ) < m_rFrames )
-		{
-			env_level = m_rEnv[_frame - _release_begin] *
-				( ( _release_begin < m_pahdFrames ) ?
-				m_pahdEnv[_release_begin] : m_sustainLevel );
 		}
 		else
 		{
-			env_level = 0.0f;
+			for (fpp_t offset = 0; offset < chunk; ++offset)
+			{
+				buf[offset] = envBuffer[offset] + buf[offset];
+			}
 		}
-
-		// at this point, *_buf is LFO level
-		*_buf = m_controlEnvAmountModel.value() ?
-			env_level * ( 0.5f + *_buf ) :
-			env_level + *_buf;
 	}
 }
 
@@ -402,146 +436,88 @@ void EnvelopeAndLfoParameters::loadSettings( const QDomElement & _this )
 
 void EnvelopeAndLfoParameters::updateSampleVars()
 {
-	QMutexLocker m(&m_paramMutex);
-
-	const float frames_per_env_seg = SECS_PER_ENV_SEGMENT *
-				Engine::audioEngine()->outputSampleRate();
-
-	// TODO: Remove the expKnobVals, time should be linear
-	const auto predelay_frames = static_cast<f_cnt_t>(frames_per_env_seg * expKnobVal(m_predelayModel.value()));
-
-	const f_cnt_t attack_frames = std::max(minimumFrames,
-					static_cast<f_cnt_t>(frames_per_env_seg *
-					expKnobVal(m_attackModel.value())));
-
-	const auto hold_frames = static_cast<f_cnt_t>(frames_per_env_seg * expKnobVal(m_holdModel.value()));
-
-	const f_cnt_t decay_frames = std::max(minimumFrames,
-					static_cast<f_cnt_t>(frames_per_env_seg *
-					expKnobVal(m_decayModel.value() *
-					(1 - m_sustainModel.value()))));
-
-	m_sustainLevel = m_sustainModel.value();
-	m_amount = m_amountModel.value();
-	if( m_amount >= 0 )
+	m_levels.update([this](Levels& levels)
 	{
-		m_amountAdd = ( 1.0f - m_amount ) * m_valueForZeroAmount;
-	}
-	else
-	{
-		m_amountAdd = m_valueForZeroAmount;
-	}
+		const float frames_per_env_seg = SECS_PER_ENV_SEGMENT *
+					Engine::audioEngine()->outputSampleRate();
 
-	m_pahdFrames = predelay_frames + attack_frames + hold_frames +
-								decay_frames;
-	m_rFrames = static_cast<f_cnt_t>( frames_per_env_seg *
-					expKnobVal( m_releaseModel.value() ) );
-	m_rFrames = std::max(minimumFrames, m_rFrames);
+		// TODO: Remove the expKnobVals, time should be linear
+		const auto predelay_frames = static_cast<f_cnt_t>(frames_per_env_seg * expKnobVal(m_predelayModel.value()));
 
-	if( static_cast<int>( floorf( m_amount * 1000.0f ) ) == 0 )
-	{
-		m_rFrames = minimumFrames;
-	}
+		const f_cnt_t attack_frames = std::max(minimumFrames,
+						static_cast<f_cnt_t>(frames_per_env_seg *
+						expKnobVal(m_attackModel.value())));
 
-	// if the buffers are too small, make bigger ones - so we only alloc new memory when necessary
-	if( m_pahdBufSize < m_pahdFrames )
-	{
-		sample_t * tmp = m_pahdEnv;
-		m_pahdEnv = new sample_t[m_pahdFrames];
-		delete[] tmp;
-		m_pahdBufSize = m_pahdFrames;
-	}
-	if( m_rBufSize < m_rFrames )
-	{
-		sample_t * tmp = m_rEnv;
-		m_rEnv = new sample_t[m_rFrames];
-		delete[] tmp;
-		m_rBufSize = m_rFrames;
-	}
+		const auto hold_frames = static_cast<f_cnt_t>(frames_per_env_seg * expKnobVal(m_holdModel.value()));
 
-	const float aa = m_amountAdd;
-	for( f_cnt_t i = 0; i < predelay_frames; ++i )
-	{
-		m_pahdEnv[i] = aa;
-	}
+		const f_cnt_t decay_frames = std::max(minimumFrames,
+						static_cast<f_cnt_t>(frames_per_env_seg *
+						expKnobVal(m_decayModel.value() *
+						(1 - m_sustainModel.value()))));
 
-	f_cnt_t add = predelay_frames;
-
-	const float afI = ( 1.0f / attack_frames ) * m_amount;
-	for( f_cnt_t i = 0; i < attack_frames; ++i )
-	{
-		m_pahdEnv[add+i] = i * afI + aa;
-	}
-
-	add += attack_frames;
-	const float amsum = m_amount + m_amountAdd;
-	for( f_cnt_t i = 0; i < hold_frames; ++i )
-	{
-		m_pahdEnv[add + i] = amsum;
-	}
-
-	add += hold_frames;
-	const float dfI = ( 1.0 / decay_frames ) * ( m_sustainLevel -1 ) * m_amount;
-	for( f_cnt_t i = 0; i < decay_frames; ++i )
-	{
-/*
-		m_pahdEnv[add + i] = ( m_sustainLevel + ( 1.0f -
-						(float)i / decay_frames ) *
-						( 1.0f - m_sustainLevel ) ) *
-							m_amount + m_amountAdd;
-*/
-		m_pahdEnv[add + i] = amsum + i*dfI;
-	}
-
-	const float rfI = ( 1.0f / m_rFrames ) * m_amount;
-	for( f_cnt_t i = 0; i < m_rFrames; ++i )
-	{
-		m_rEnv[i] = (float)( m_rFrames - i ) * rfI;
-	}
-
-	// save this calculation in real-time-part
-	m_sustainLevel = m_sustainLevel * m_amount + m_amountAdd;
+		const float sustainLevel = m_sustainModel.value();
+		const float amount = m_amountModel.value();
+		const float amountAdd = amount >= 0
+			? (1.0f - amount) * m_valueForZeroAmount
+			: m_valueForZeroAmount;
 
+		m_pahdFrames = predelay_frames + attack_frames + hold_frames +
+									decay_frames;
+		m_rFrames = static_cast<f_cnt_t>( frames_per_env_seg *
+						expKnobVal( m_releaseModel.value() ) );
+		m_rFrames = std::max(minimumFrames, m_rFrames);
 
-	const float frames_per_lfo_oscillation = SECS_PER_LFO_OSCILLATION *
-				Engine::audioEngine()->outputSampleRate();
-	m_lfoPredelayFrames = static_cast<f_cnt_t>( frames_per_lfo_oscillation *
-				expKnobVal( m_lfoPredelayModel.value() ) );
-	m_lfoAttackFrames = static_cast<f_cnt_t>( frames_per_lfo_oscillation *
-				expKnobVal( m_lfoAttackModel.value() ) );
-	m_lfoOscillationFrames = static_cast<f_cnt_t>(
-						frames_per_lfo_oscillation *
-						m_lfoSpeedModel.value() );
-	if( m_x100Model.value() )
-	{
-		m_lfoOscillationFrames /= 100;
-	}
-	m_lfoAmount = m_lfoAmountModel.value() * 0.5f;
+		if( static_cast<int>( floorf( amount * 1000.0f ) ) == 0 )
+		{
+			m_rFrames = minimumFrames;
+		}
 
-	m_used = true;
-	if( static_cast<int>( floorf( m_lfoAmount * 1000.0f ) ) == 0 )
-	{
-		m_lfoAmountIsZero = true;
-		if( static_cast<int>( floorf( m_amount * 1000.0f ) ) == 0 )
+		const float amsum = amount + amountAdd;
+		f_cnt_t end = predelay_frames;
+		levels.pahd[0] = {end, amountAdd, 0.0f};
+		end += attack_frames;
+		levels.pahd[1] = {end, amountAdd, (1.0f / attack_frames) * amount};
+		end += hold_frames;
+		levels.pahd[2] = {end, amsum, 0.0f};
+		end += decay_frames;
+		levels.pahd[3] = {end, amsum, static_cast<float>((1.0 / decay_frames) * (sustainLevel - 1) * amount)};
+
+		// save this calculation in real-time-part
+		levels.sustainLevel = sustainLevel * amount + amountAdd;
+		levels.releaseFrames = m_rFrames;
+		levels.releaseSlope = (1.0f / m_rFrames) * amount;
+		levels.controlEnvAmount = m_controlEnvAmountModel.value();
+
+
+		const float frames_per_lfo_oscillation = SECS_PER_LFO_OSCILLATION *
+					Engine::audioEngine()->outputSampleRate();
+		m_lfoPredelayFrames = static_cast<f_cnt_t>( frames_per_lfo_oscillation *
+					expKnobVal( m_lfoPredelayModel.value() ) );
+		m_lfoAttackFrames = static_cast<f_cnt_t>( frames_per_lfo_oscillation *
+					expKnobVal( m_lfoAttackModel.value() ) );
+		m_lfoOscillationFrames = static_cast<f_cnt_t>(
+							frames_per_lfo_oscillation *
+							m_lfoSpeedModel.value() );
+		if( m_x100Model.value() )
 		{
-			m_used = false;
+			m_lfoOscillationFrames /= 100;
 		}
-	}
-	else
-	{
-		m_lfoAmountIsZero = false;
-	}
 
-	m_bad_lfoShapeData = true;
+		levels.lfoPredelayFrames = m_lfoPredelayFrames;
+		levels.lfoAttackFrames = m_lfoAttackFrames;
+		levels.lfoOscillationFrames = m_lfoOscillationFrames;
+		levels.lfoAmount = m_lfoAmountModel.value() * 0.5f;
+		levels.lfoAmountIsZero = static_cast<int>(floorf(levels.lfoAmount * 1000.0f)) == 0;
+		levels.lfoShape = static_cast<LfoShape>(m_lfoWaveModel.value());
+		levels.userWave = m_userWave;
 
-	emit dataChanged();
+		m_used = !levels.lfoAmountIsZero || static_cast<int>(floorf(amount * 1000.0f)) != 0;
+	});
 
+	emit dataChanged();
 }
 
 
 
 
-
-
-
 } // namespace lmms
@@ -38,6 +38,7 @@ InstrumentPlayHandle::InstrumentPlayHandle(Instrument * instrument, InstrumentTr
 	m_instrument(instrument)
 {
 	setAudioPort(instrumentTrack->audioPort());
+	setCpuTimeCounter(&instrumentTrack->cpuTime());
 }
 
 void InstrumentPlayHandle::play(SampleFrame* working_buffer)
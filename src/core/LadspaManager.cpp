@@ -25,12 +25,18 @@
  */
 
 #include <QCoreApplication>
+#include <QDataStream>
+#include <QDateTime>
 #include <QDebug>
 #include <QDir>
+#include <QFileInfo>
+#include <QHash>
 #include <QLibrary>
 
 #include <cmath>
+#include <vector>
 
+#include "CacheFile.h"
 #include "ConfigManager.h"
 #include "LadspaManager.h"
 #include "PluginFactory.h"
@@ -40,6 +46,159 @@ namespace lmms
 {
 
 
+namespace
+{
+
+const auto CatalogFile = QStringLiteral("ladspa-catalog.dat");
+//! Bump this whenever the catalog format changes
+constexpr quint32 CatalogVersion = 1;
+
+} // namespace
+
+
+//! Everything the manager reads from a LADSPA_Descriptor without running the plugin
+struct LadspaCatalogEntry
+{
+	LadspaCatalogEntry( quint32 _index, const LADSPA_Descriptor & _descriptor ) :
+		index( _index ),
+		properties( _descriptor.Properties ),
+		label( _descriptor.Label ),
+		name( _descriptor.Name ),
+		maker( _descriptor.Maker ),
+		copyright( _descriptor.Copyright ),
+		portDescriptors( _descriptor.PortDescriptors,
+					_descriptor.PortDescriptors + _descriptor.PortCount ),
+		portRangeHints( _descriptor.PortRangeHints,
+					_descriptor.PortRangeHints + _descriptor.PortCount )
+	{
+		for( unsigned long port = 0; port < _descriptor.PortCount; ++port )
+		{
+			portNames.push_back( _descriptor.PortNames[port] );
+		}
+		updateDescriptor();
+	}
+
+	explicit LadspaCatalogEntry( QDataStream & _in )
+	{
+		auto portCount = quint32{0};
+		_in >> index >> properties >> label >> name >> maker >> copyright >> portCount;
+		for( quint32 port = 0; port < portCount && _in.status() == QDataStream::Ok; ++port )
+		{
+			QByteArray portName;
+			LADSPA_PortRangeHint hint;
+			auto portDescriptor = qint32{0};
+			auto hintDescriptor = qint32{0};
+			_in >> portDescriptor >> portName >> hintDescriptor
+				>> hint.LowerBound >> hint.UpperBound;
+			hint.HintDescriptor = hintDescriptor;
+			portDescriptors.push_back( portDescriptor );
+			portNames.push_back( portName );
+			portRangeHints.push_back( hint );
+		}
+		updateDescriptor();
+	}
+
+	LadspaCatalogEntry( const LadspaCatalogEntry & ) = delete;
+	LadspaCatalogEntry & operator=( const LadspaCatalogEntry & ) = delete;
+
+	void save( QDataStream & _out ) const
+	{
+		_out << index << properties << label << name << maker << copyright
+			<< static_cast<quint32>( portDescriptors.size() );
+		for( std::size_t port = 0; port < portDescriptors.size(); ++port )
+		{
+			_out << static_cast<qint32>( portDescriptors[port] ) << portNames[port]
+				<< static_cast<qint32>( portRangeHints[port].HintDescriptor )
+				<< portRangeHints[port].LowerBound << portRangeHints[port].UpperBound;
+		}
+	}
+
+	quint32 index = 0;
+	qint32 properties = 0;
+	QByteArray label;
+	QByteArray name;
+	QByteArray maker;
+	QByteArray copyright;
+	std::vector<LADSPA_PortDescriptor> portDescriptors;
+	std::vector<QByteArray> portNames;
+	std::vector<LADSPA_PortRangeHint> portRangeHints;
+
+	//! Points to the members above, all function pointers are null
+	LADSPA_Descriptor descriptor = {};
+
+private:
+	void updateDescriptor()
+	{
+		for( const auto & portName : portNames )
+		{
+			m_portNamePointers.push_back( portName.constData() );
+		}
+		descriptor.Label = label.constData();
+		descriptor.Properties = properties;
+		descriptor.Name = name.constData();
+		descriptor.Maker = maker.constData();
+		descriptor.Copyright = copyright.constData();
+		descriptor.PortCount = portDescriptors.size();
+		descriptor.PortDescriptors = portDescriptors.data();
+		descriptor.PortNames = m_portNamePointers.data();
+		descriptor.PortRangeHints = portRangeHints.data();
+	}
+
+	std::vector<const char *> m_portNamePointers;
+};
+
+
+
+
+namespace
+{
+
+//! What the catalog records about a library
+struct LibraryRecord
+{
+	qint64 size = -1;
+	qint64 lastModified = 0;
+	LadspaCatalogEntries plugins;
+
+	bool matches( const QFileInfo & _file ) const
+	{
+		return size == _file.size() &&
+			lastModified == _file.lastModified().toMSecsSinceEpoch();
+	}
+
+	bool operator==( const LibraryRecord & ) const = default;
+};
+
+using Catalog = QHash<QString, LibraryRecord>;
+
+QDataStream & operator<<( QDataStream & _out, const LibraryRecord & _record )
+{
+	_out << _record.size << _record.lastModified
+		<< static_cast<quint32>( _record.plugins.size() );
+	for( const auto & plugin : _record.plugins )
+	{
+		plugin->save( _out );
+	}
+	return _out;
+}
+
+QDataStream & operator>>( QDataStream & _in, LibraryRecord & _record )
+{
+	auto pluginCount = quint32{0};
+	_in >> _record.size >> _record.lastModified >> pluginCount;
+	_record.plugins.clear();
+	for( quint32 i = 0; i < pluginCount && _in.status() == QDataStream::Ok; ++i )
+	{
+		_record.plugins.push_back( std::make_shared<const LadspaCatalogEntry>( _in ) );
+	}
+	return _in;
+}
+
+} // namespace
+
+
+
+
 LadspaManager::LadspaManager()
 {
 	// Make sure plugin search paths are set up
@@ -59,6 +218,16 @@ LadspaManager::LadspaManager()
 	ladspaDirectories.push_back( "/Library/Audio/Plug-Ins/LADSPA" );
 #endif
 
+	// Libraries that did not change since they were recorded in the catalog
+	// are not loaded until one of their plugins is used
+	Catalog catalog;
+	if( !CacheFile::read( CatalogFile, CatalogVersion,
+			[&catalog]( QDataStream & _in ) { _in >> catalog; } ) )
+	{
+		catalog.clear();
+	}
+	Catalog updatedCatalog;
+
 	for (const auto& ladspaDirectory : ladspaDirectories)
 	{
 		// Skip empty entries as QDir will interpret it as the working directory
@@ -78,16 +247,32 @@ LadspaManager::LadspaManager()
 				continue;
 			}
 
+			LibraryRecord record = catalog.value( f.absoluteFilePath() );
+			if( record.matches( f ) )
+			{
+				addPlugins( record.plugins, f, nullptr );
+				updatedCatalog.insert( f.absoluteFilePath(), record );
+				continue;
+			}
+
 			QLibrary plugin_lib( f.absoluteFilePath() );
 
 			if( plugin_lib.load() == true )
 			{
+				record = LibraryRecord{};
+				record.size = f.size();
+				record.lastModified = f.lastModified().toMSecsSinceEpoch();
+
 				auto descriptorFunction = (LADSPA_Descriptor_Function)plugin_lib.resolve("ladspa_descriptor");
 				if( descriptorFunction != nullptr )
 				{
-					addPlugins( descriptorFunction,
-							f.fileName() );
+					for (long pluginIndex = 0; const auto descriptor = descriptorFunction(pluginIndex); ++pluginIndex)
+					{
+						record.plugins.push_back( std::make_shared<const LadspaCatalogEntry>( pluginIndex, *descriptor ) );
+					}
+					addPlugins( record.plugins, f, descriptorFunction );
 				}
+				updatedCatalog.insert( f.absoluteFilePath(), record );
 			}
 			else
 			{
@@ -95,6 +280,12 @@ LadspaManager::LadspaManager()
 			}
 		}
 	}
+
+	if( updatedCatalog != catalog )
+	{
+		CacheFile::write( CatalogFile, CatalogVersion,
+			[&updatedCatalog]( QDataStream & _out ) { _out << updatedCatalog; } );
+	}
 	
 	l_ladspa_key_t keys = m_ladspaManagerMap.keys();
 	for (const auto& key : keys)
@@ -129,13 +320,13 @@ LadspaManagerDescription * LadspaManager::getDescription(
 
 
 
-void LadspaManager::addPlugins(
-		LADSPA_Descriptor_Function _descriptor_func,
-						const QString & _file )
+void LadspaManager::addPlugins( const LadspaCatalogEntries & _plugins,
+						const QFileInfo & _file,
+				LADSPA_Descriptor_Function _descriptor_func )
 {
-	for (long pluginIndex = 0; const auto descriptor = _descriptor_func(pluginIndex); ++pluginIndex)
+	for( const auto & entry : _plugins )
 	{
-		ladspa_key_t key( _file, QString( descriptor->Label ) );
+		ladspa_key_t key( _file.fileName(), QString( entry->label ) );
 		if( m_ladspaManagerMap.contains( key ) )
 		{
 			continue;
@@ -143,9 +334,11 @@ void LadspaManager::addPlugins(
 
 		auto plugIn = new LadspaManagerDescription;
 		plugIn->descriptorFunction = _descriptor_func;
-		plugIn->index = pluginIndex;
-		plugIn->inputChannels = getPluginInputs( descriptor );
-		plugIn->outputChannels = getPluginOutputs( descriptor );
+		plugIn->index = entry->index;
+		plugIn->library = _file.absoluteFilePath();
+		plugIn->catalogEntry = entry;
+		plugIn->inputChannels = getPluginInputs( &entry->descriptor );
+		plugIn->outputChannels = getPluginOutputs( &entry->descriptor );
 
 		if( plugIn->inputChannels == 0 && plugIn->outputChannels > 0 )
 		{
@@ -224,7 +417,7 @@ uint16_t LadspaManager::getPluginOutputs(
 
 const LADSPA_PortDescriptor* LadspaManager::getPortDescriptor(const ladspa_key_t &_plugin, uint32_t _port)
 {
-	const LADSPA_Descriptor * descriptor = getDescriptor( _plugin );
+	const LADSPA_Descriptor * descriptor = getCatalogDescriptor( _plugin );
 	if( descriptor && _port < getPortCount( _plugin ) )
 	{
 		return( & descriptor->PortDescriptors[_port] );
@@ -234,7 +427,7 @@ const LADSPA_PortDescriptor* LadspaManager::getPortDescriptor(const ladspa_key_t
 
 const LADSPA_PortRangeHint *LadspaManager::getPortRangeHint(const ladspa_key_t &_plugin, uint32_t _port)
 {
-	const LADSPA_Descriptor * descriptor = getDescriptor( _plugin );
+	const LADSPA_Descriptor * descriptor = getCatalogDescriptor( _plugin );
 	if( descriptor && _port < getPortCount( _plugin ) )
 	{
 		return( & descriptor->PortRangeHints[_port] );
@@ -255,7 +448,7 @@ l_sortable_plugin_t LadspaManager::getSortedPlugins()
 
 QString LadspaManager::getLabel( const ladspa_key_t & _plugin )
 {
-	const LADSPA_Descriptor * descriptor = getDescriptor( _plugin );
+	const LADSPA_Descriptor * descriptor = getCatalogDescriptor( _plugin );
 	return( descriptor ? descriptor->Label : "" );
 }
 
@@ -265,7 +458,7 @@ QString LadspaManager::getLabel( const ladspa_key_t & _plugin )
 bool LadspaManager::hasRealTimeDependency(
 					const ladspa_key_t &  _plugin )
 {
-	const LADSPA_Descriptor * descriptor = getDescriptor( _plugin );
+	const LADSPA_Descriptor * descriptor = getCatalogDescriptor( _plugin );
 	return( descriptor ? LADSPA_IS_REALTIME( descriptor->Properties )
 					   : false );
 }
@@ -275,7 +468,7 @@ bool LadspaManager::hasRealTimeDependency(
 
 bool LadspaManager::isInplaceBroken( const ladspa_key_t &  _plugin )
 {
-	const LADSPA_Descriptor * descriptor = getDescriptor( _plugin );
+	const LADSPA_Descriptor * descriptor = getCatalogDescriptor( _plugin );
 	return( descriptor ? LADSPA_IS_INPLACE_BROKEN( descriptor->Properties )
 					   : false );
 }
@@ -286,7 +479,7 @@ bool LadspaManager::isInplaceBroken( const ladspa_key_t &  _plugin )
 bool LadspaManager::isRealTimeCapable(
 					const ladspa_key_t &  _plugin )
 {
-	const LADSPA_Descriptor * descriptor = getDescriptor( _plugin );
+	const LADSPA_Descriptor * descriptor = getCatalogDescriptor( _plugin );
 	return( descriptor ? LADSPA_IS_HARD_RT_CAPABLE( descriptor->Properties )
 					   : false );
 }
@@ -296,7 +489,7 @@ bool LadspaManager::isRealTimeCapable(
 
 QString LadspaManager::getName( const ladspa_key_t & _plugin )
 {
-	const LADSPA_Descriptor * descriptor = getDescriptor( _plugin );
+	const LADSPA_Descriptor * descriptor = getCatalogDescriptor( _plugin );
 	return( descriptor ? descriptor->Name : "" );
 }
 
@@ -305,7 +498,7 @@ QString LadspaManager::getName( const ladspa_key_t & _plugin )
 
 QString LadspaManager::getMaker( const ladspa_key_t & _plugin )
 {
-	const LADSPA_Descriptor * descriptor = getDescriptor( _plugin );
+	const LADSPA_Descriptor * descriptor = getCatalogDescriptor( _plugin );
 	return( descriptor ? descriptor->Maker : "" );
 }
 
@@ -314,7 +507,7 @@ QString LadspaManager::getMaker( const ladspa_key_t & _plugin )
 
 QString LadspaManager::getCopyright( const ladspa_key_t & _plugin )
 {
-	const LADSPA_Descriptor * descriptor = getDescriptor( _plugin );
+	const LADSPA_Descriptor * descriptor = getCatalogDescriptor( _plugin );
 	return( descriptor ? descriptor->Copyright : "" );
 }
 
@@ -323,7 +516,7 @@ QString LadspaManager::getCopyright( const ladspa_key_t & _plugin )
 
 uint32_t LadspaManager::getPortCount( const ladspa_key_t & _plugin )
 {
-	const LADSPA_Descriptor * descriptor = getDescriptor( _plugin );
+	const LADSPA_Descriptor * descriptor = getCatalogDescriptor( _plugin );
 	return( descriptor ? descriptor->PortCount : 0 );
 }
 
@@ -513,7 +706,7 @@ bool LadspaManager::isInteger( const ladspa_key_t & _plugin,
 
 bool LadspaManager::isEnum( const ladspa_key_t & _plugin, uint32_t _port )
 {
-	auto const * desc = getDescriptor(_plugin);
+	auto const * desc = getCatalogDescriptor(_plugin);
 	if (desc && _port < desc->PortCount)
 	{
 		LADSPA_PortRangeHintDescriptor hintDescriptor =
@@ -531,7 +724,7 @@ bool LadspaManager::isEnum( const ladspa_key_t & _plugin, uint32_t _port )
 QString LadspaManager::getPortName( const ladspa_key_t & _plugin,
 								uint32_t _port )
 {
-	const LADSPA_Descriptor * descriptor = getDescriptor( _plugin );
+	const LADSPA_Descriptor * descriptor = getCatalogDescriptor( _plugin );
 	return( descriptor ? descriptor->PortNames[_port] : QString( "" ) );
 }
 
@@ -555,10 +748,8 @@ const LADSPA_Descriptor * LadspaManager::getDescriptor(const ladspa_key_t & _plu
 	{
 		auto const plugin = *it;
 
-		LADSPA_Descriptor_Function descriptorFunction = plugin->descriptorFunction;
-		const LADSPA_Descriptor* descriptor = descriptorFunction(plugin->index);
-
-		return descriptor;
+		LADSPA_Descriptor_Function descriptorFunction = loadDescriptorFunction(*plugin);
+		return descriptorFunction ? descriptorFunction(plugin->index) : nullptr;
 	}
 
 	return nullptr;
@@ -567,6 +758,51 @@ const LADSPA_Descriptor * LadspaManager::getDescriptor(const ladspa_key_t & _plu
 
 
 
+const LADSPA_Descriptor * LadspaManager::getCatalogDescriptor(const ladspa_key_t & _plugin)
+{
+	auto const it = m_ladspaManagerMap.find(_plugin);
+	return it != m_ladspaManagerMap.end() ? &(*it)->catalogEntry->descriptor : nullptr;
+}
+
+
+
+
+LADSPA_Descriptor_Function LadspaManager::loadDescriptorFunction(LadspaManagerDescription & _plugin)
+{
+	if (const auto descriptorFunction = _plugin.descriptorFunction.load(std::memory_order_acquire))
+	{
+		return descriptorFunction;
+	}
+
+	const auto lock = std::lock_guard{m_loadMutex};
+	if (const auto descriptorFunction = _plugin.descriptorFunction.load(std::memory_order_relaxed))
+	{
+		return descriptorFunction;
+	}
+
+	QLibrary library(_plugin.library);
+	if (!library.load())
+	{
+		qWarning() << library.errorString();
+		return nullptr;
+	}
+
+	auto descriptorFunction = (LADSPA_Descriptor_Function)library.resolve("ladspa_descriptor");
+	// the library may have been replaced without changing its size and time stamp
+	const LADSPA_Descriptor* descriptor = descriptorFunction ? descriptorFunction(_plugin.index) : nullptr;
+	if (descriptor == nullptr || _plugin.catalogEntry->label != descriptor->Label)
+	{
+		qWarning() << "LADSPA plugin" << _plugin.catalogEntry->label << "not found in" << _plugin.library;
+		return nullptr;
+	}
+
+	_plugin.descriptorFunction.store(descriptorFunction, std::memory_order_release);
+	return descriptorFunction;
+}
+
+
+
+
 LADSPA_Handle LadspaManager::instantiate(
 					const ladspa_key_t & _plugin, 
 							uint32_t _sample_rate )
@@ -0,0 +1,235 @@
+/*
+ * LocklessPool.cpp - growable object pool with lockless alloc and free
+ *
+ * This file is part of LMMS - https://lmms.io
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this program (see COPYING); if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301 USA.
+ *
+ */
+
+#include "LocklessPool.h"
+
+#include <QDebug>
+#include <algorithm>
+#include <new>
+
+#include "LmmsSemaphore.h"
+
+namespace lmms
+{
+
+static constexpr std::size_t CACHE_LINE_SIZE = 64;
+
+// every block is preceded by a header holding its slot in the pool, padded
+// to a full cache line so the block itself stays aligned
+static constexpr std::size_t HEADER_SIZE = CACHE_LINE_SIZE;
+
+// slot of blocks allocated after the pool reached its maximum size
+static constexpr std::uint32_t UNPOOLED = LocklessIndexStack::Empty;
+
+
+static std::uint32_t* slotOf(void* ptr)
+{
+	return reinterpret_cast<std::uint32_t*>(static_cast<std::byte*>(ptr) - HEADER_SIZE);
+}
+
+
+
+
+LocklessPool::LocklessPool(std::size_t blockSize, std::uint32_t initialBlocks,
+		std::uint32_t refillWatermark, std::uint32_t refillStep,
+		std::uint32_t maxBlocks) :
+	m_blockSize(blockSize),
+	m_refillWatermark(refillWatermark),
+	m_refillStep(refillStep),
+	m_maxBlocks(maxBlocks),
+	m_freeSlots(maxBlocks),
+	m_slots(std::make_unique<void*[]>(maxBlocks)),
+	m_numSlots(0),
+	m_inUse(0),
+	m_highWaterMark(0),
+	m_poolMisses(0),
+	m_refillRequested(false),
+	m_refillSemaphore(std::make_unique<Semaphore>(0)),
+	m_quit(false)
+{
+	grow(initialBlocks);
+	m_refillThread = std::thread([this] { refillLoop(); });
+}
+
+
+
+
+LocklessPool::~LocklessPool()
+{
+	m_quit = true;
+	m_refillSemaphore->post();
+	m_refillThread.join();
+
+	if (m_inUse != 0)
+	{
+		qWarning("LocklessPool: Destroying with blocks still allocated");
+	}
+
+	const auto numSlots = std::min(m_numSlots.load(), m_maxBlocks);
+	for (std::uint32_t slot = 0; slot < numSlots; ++slot)
+	{
+		freeBlock(m_slots[slot]);
+	}
+}
+
+
+
+
+void* LocklessPool::alloc()
+{
+	void* ptr = nullptr;
+	const auto slot = m_freeSlots.pop();
+	if (slot != LocklessIndexStack::Empty)
+	{
+		ptr = m_slots[slot];
+	}
+	else
+	{
+		// pool is exhausted - there's no way around allocating here
+		++m_poolMisses;
+		const auto newSlot = claimSlot();
+		ptr = allocateBlock(newSlot);
+		if (newSlot != UNPOOLED) { m_slots[newSlot] = ptr; }
+	}
+
+	const auto inUse = ++m_inUse;
+	auto highWaterMark = m_highWaterMark.load(std::memory_order_relaxed);
+	while (inUse > highWaterMark
+		&& !m_highWaterMark.compare_exchange_weak(highWaterMark, inUse, std::memory_order_relaxed))
+	{
+		// Empty loop (compare_exchange_weak updates highWaterMark)
+	}
+
+	if (m_freeSlots.size() < m_refillWatermark && m_numSlots < m_maxBlocks
+		&& !m_refillRequested.exchange(true))
+	{
+		// posting a semaphore is real-time safe
+		m_refillSemaphore->post();
+	}
+
+	return ptr;
+}
+
+
+
+
+void LocklessPool::free(void* ptr)
+{
+	const auto slot = *slotOf(ptr);
+	if (slot == UNPOOLED)
+	{
+		freeBlock(ptr);
+	}
+	else
+	{
+		m_freeSlots.push(slot);
+	}
+	--m_inUse;
+}
+
+
+
+
+auto LocklessPool::statistics() const -> Statistics
+{
+	return {
+		std::min(m_numSlots.load(), m_maxBlocks),
+		m_inUse.load(),
+		m_highWaterMark.load(),
+		m_poolMisses.load()
+	};
+}
+
+
+
+
+void LocklessPool::resetHighWaterMark()
+{
+	m_highWaterMark = m_inUse.load();
+}
+
+
+
+
+void LocklessPool::grow(std::uint32_t count)
+{
+	for (std::uint32_t i = 0; i < count; ++i)
+	{
+		const auto slot = claimSlot();
+		if (slot == UNPOOLED) { return; }
+
+		m_slots[slot] = allocateBlock(slot);
+		m_freeSlots.push(slot);
+	}
+}
+
+
+
+
+std::uint32_t LocklessPool::claimSlot()
+{
+	auto slot = m_numSlots.load();
+	do
+	{
+		if (slot >= m_maxBlocks) { return UNPOOLED; }
+	}
+	while (!m_numSlots.compare_exchange_weak(slot, slot + 1));
+	return slot;
+}
+
+
+
+
+void* LocklessPool::allocateBlock(std::uint32_t slot) const
+{
+	auto raw = static_cast<std::byte*>(::operator new(HEADER_SIZE + m_blockSize,
+		std::align_val_t{CACHE_LINE_SIZE}));
+	void* ptr = raw + HEADER_SIZE;
+	*slotOf(ptr) = slot;
+	return ptr;
+}
+
+
+
+
+void LocklessPool::freeBlock(void* ptr)
+{
+	::operator delete(static_cast<std::byte*>(ptr) - HEADER_SIZE, std::align_val_t{CACHE_LINE_SIZE});
+}
+
+
+
+
+void LocklessPool::refillLoop()
+{
+	while (true)
+	{
+		m_refillSemaphore->wait();
+		if (m_quit) { break; }
+
+		grow(m_refillStep);
+		m_refillRequested = false;
+	}
+}
+
+
+} // namespace lmms
@@ -0,0 +1,149 @@
+/*
+ * MappedCache.cpp - precomputed data cached on disk and memory-mapped read-only
+ *
+ * This file is part of LMMS - https://lmms.io
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this program (see COPYING); if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301 USA.
+ *
+ */
+
+#include "MappedCache.h"
+
+#include <QDir>
+#include <QFile>
+#include <QSaveFile>
+#include <algorithm>
+#include <array>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include "ConfigManager.h"
+
+namespace lmms
+{
+
+namespace
+{
+
+constexpr auto Magic = std::array<char, 8>{'L', 'M', 'M', 'S', 'C', 'A', 'C', 'H'};
+constexpr std::uint32_t ByteOrderMark = 0x01020304;
+
+//! The parameters start at this offset and the data at the next multiple of it
+//! after them, which keeps the data aligned for SIMD loads
+constexpr qint64 Alignment = 64;
+
+struct FileHeader
+{
+	std::array<char, 8> magic = Magic;
+	//! Rejects files copied from a host with a different byte order
+	std::uint32_t byteOrder = ByteOrderMark;
+	std::uint32_t version = 0;
+	std::uint64_t size = 0;
+	std::uint64_t parametersSize = 0;
+
+	bool matches(std::uint32_t expectedVersion, std::size_t expectedSize, std::size_t expectedParametersSize) const
+	{
+		return magic == Magic && byteOrder == ByteOrderMark && version == expectedVersion
+			&& size == expectedSize && parametersSize == expectedParametersSize;
+	}
+};
+
+static_assert(sizeof(FileHeader) <= Alignment);
+
+qint64 dataOffset(std::size_t parametersSize)
+{
+	return Alignment + (static_cast<qint64>(parametersSize) + Alignment - 1) / Alignment * Alignment;
+}
+
+//! Maps are removed when their QFile is destroyed, so the files are kept until exit
+std::mutex s_mappedFilesMutex;
+std::vector<std::unique_ptr<QFile>> s_mappedFiles;
+
+} // namespace
+
+
+
+
+const void* MappedCache::map(const QString& name, std::uint32_t version, std::size_t size,
+	const void* parameters, std::size_t parametersSize)
+{
+	auto file = std::make_unique<QFile>(ConfigManager::inst()->cacheDir() + name);
+	const auto offset = dataOffset(parametersSize);
+	if (file->size() != offset + static_cast<qint64>(size) || !file->open(QIODevice::ReadOnly))
+	{
+		return nullptr;
+	}
+
+	auto header = FileHeader{};
+	if (file->read(reinterpret_cast<char*>(&header), sizeof(header)) != sizeof(header)
+		|| !header.matches(version, size, parametersSize))
+	{
+		return nullptr;
+	}
+
+	// the data depends on the parameters it was generated from
+	if (parametersSize != 0)
+	{
+		const auto stored = file->seek(Alignment) ? file->read(static_cast<qint64>(parametersSize)) : QByteArray{};
+		if (static_cast<std::size_t>(stored.size()) != parametersSize
+			|| std::memcmp(stored.constData(), parameters, parametersSize) != 0)
+		{
+			return nullptr;
+		}
+	}
+
+	const uchar* data = file->map(offset, static_cast<qint64>(size));
+	if (data == nullptr) { return nullptr; }
+	// the mapping outlives the file descriptor
+	file->close();
+
+	const auto lock = std::lock_guard{s_mappedFilesMutex};
+	s_mappedFiles.push_back(std::move(file));
+	return data;
+}
+
+
+
+
+bool MappedCache::store(const QString& name, std::uint32_t version, const void* data, std::size_t size,
+	const void* parameters, std::size_t parametersSize)
+{
+	const auto dir = ConfigManager::inst()->cacheDir();
+	if (!QDir{}.mkpath(dir)) { return false; }
+
+	// QSaveFile writes to a temporary file and renames it on commit(), so concurrently
+	// starting instances either map the previous file or the complete new one
+	auto file = QSaveFile{dir + name};
+	if (!file.open(QIODevice::WriteOnly)) { return false; }
+
+	// the header and the parameters are padded up to the data
+	auto header = QByteArray(dataOffset(parametersSize), '\0');
+	const auto fields = FileHeader{Magic, ByteOrderMark, version, size, parametersSize};
+	std::copy_n(reinterpret_cast<const char*>(&fields), sizeof(fields), header.begin());
+	if (parametersSize != 0)
+	{
+		std::copy_n(static_cast<const char*>(parameters), parametersSize, header.begin() + Alignment);
+	}
+
+	file.write(header);
+	file.write(static_cast<const char*>(data), static_cast<qint64>(size));
+	return file.commit();
+}
+
+
+} // namespace lmms
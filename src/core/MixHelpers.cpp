@@ -28,12 +28,20 @@
 #include <cstdio>
 #endif
 
+#include <algorithm>
 #include <cmath>
 #include <QtGlobal>
 
+#include "MixHelpersSimd.h"
+#include "PlanarBuffer.h"
 #include "ValueBuffer.h"
 #include "SampleFrame.h"
 
+#if defined(LMMS_HAVE_MIX_HELPERS_SIMD) && defined(_MSC_VER)
+#include <immintrin.h>
+#include <intrin.h>
+#endif
+
 
 
 static bool s_NaNHandler;
@@ -65,7 +73,13 @@ static inline void run( SampleFrame* dst, const sample_t* srcLeft, const sample_
 
 
 
-bool isSilent( const SampleFrame* src, int frames )
+namespace
+{
+
+// Scalar implementations of the functions which have vectorized ones,
+// see MixHelpersSimd.h. They are used if the CPU supports none of those.
+
+bool isSilentScalar( const SampleFrame* src, int frames )
 {
 	const float silenceThreshold = 0.0000001f;
 
@@ -80,24 +94,8 @@ bool isSilent( const SampleFrame* src, int frames )
 	return true;
 }
 
-bool useNaNHandler()
-{
-	return s_NaNHandler;
-}
-
-void setNaNHandler( bool use )
-{
-	s_NaNHandler = use;
-}
-
-/*! \brief Function for sanitizing a buffer of infs/nans - returns true if those are found */
-bool sanitize( SampleFrame* src, int frames )
+bool sanitizeScalar( SampleFrame* src, int frames )
 {
-	if( !useNaNHandler() )
-	{
-		return false;
-	}
-
 	for (int f = 0; f < frames; ++f)
 	{
 		auto& currentFrame = src[f];
@@ -133,12 +131,20 @@ struct AddOp
 	}
 } ;
 
-void add( SampleFrame* dst, const SampleFrame* src, int frames )
+void addScalar( SampleFrame* dst, const SampleFrame* src, int frames )
 {
 	run<>( dst, src, frames, AddOp() );
 }
 
 
+void multiplyScalar(SampleFrame* dst, float coeff, int frames)
+{
+	for (int i = 0; i < frames; ++i)
+	{
+		dst[i] *= coeff;
+	}
+}
+
 
 struct AddMultipliedOp
 {
@@ -152,10 +158,228 @@ struct AddMultipliedOp
 	const float m_coeff;
 } ;
 
+void addMultipliedScalar( SampleFrame* dst, const SampleFrame* src, float coeffSrc, int frames )
+{
+	run<>( dst, src, frames, AddMultipliedOp(coeffSrc) );
+}
+
+
+struct AddSanitizedMultipliedOp
+{
+	AddSanitizedMultipliedOp( float coeff ) : m_coeff( coeff ) { }
+
+	void operator()( SampleFrame& dst, const SampleFrame& src ) const
+	{
+		dst[0] += ( std::isinf( src[0] ) || std::isnan( src[0] ) ) ? 0.0f : src[0] * m_coeff;
+		dst[1] += ( std::isinf( src[1] ) || std::isnan( src[1] ) ) ? 0.0f : src[1] * m_coeff;
+	}
+
+	const float m_coeff;
+};
+
+void addSanitizedMultipliedScalar( SampleFrame* dst, const SampleFrame* src, float coeffSrc, int frames )
+{
+	run<>( dst, src, frames, AddSanitizedMultipliedOp(coeffSrc) );
+}
+
+
+void addMultipliedByBuffersScalar( SampleFrame* dst, const SampleFrame* src, const float* coeffSrcBuf1, const float* coeffSrcBuf2, int frames )
+{
+	for( int f = 0; f < frames; ++f )
+	{
+		dst[f][0] += src[f][0] * coeffSrcBuf1[f] * coeffSrcBuf2[f];
+		dst[f][1] += src[f][1] * coeffSrcBuf1[f] * coeffSrcBuf2[f];
+	}
+}
+
+void addSanitizedMultipliedByBuffersScalar( SampleFrame* dst, const SampleFrame* src, const float* coeffSrcBuf1, const float* coeffSrcBuf2, int frames )
+{
+	for( int f = 0; f < frames; ++f )
+	{
+		dst[f][0] += ( std::isinf( src[f][0] ) || std::isnan( src[f][0] ) )
+			? 0.0f
+			: src[f][0] * coeffSrcBuf1[f] * coeffSrcBuf2[f];
+		dst[f][1] += ( std::isinf( src[f][1] ) || std::isnan( src[f][1] ) )
+			? 0.0f
+			: src[f][1] * coeffSrcBuf1[f] * coeffSrcBuf2[f];
+	}
+}
+
+
+constexpr Kernels s_scalarKernels = {
+	isSilentScalar,
+	sanitizeScalar,
+	addScalar,
+	multiplyScalar,
+	addMultipliedScalar,
+	addSanitizedMultipliedScalar,
+	addMultipliedByBuffersScalar,
+	addSanitizedMultipliedByBuffersScalar
+};
+
+
+SimdLevel detectSimdLevel()
+{
+#ifdef LMMS_HAVE_MIX_HELPERS_SIMD
+#if defined(__GNUC__)
+	// also checks whether the OS saves the wider registers
+	__builtin_cpu_init();
+	if (__builtin_cpu_supports("avx512f")) { return SimdLevel::Avx512; }
+	if (__builtin_cpu_supports("avx2")) { return SimdLevel::Avx2; }
+	if (__builtin_cpu_supports("sse2")) { return SimdLevel::Sse2; }
+#elif defined(_MSC_VER)
+	int info[4];
+	__cpuid(info, 0);
+	const int maxLeaf = info[0];
+
+	__cpuid(info, 1);
+	const bool sse2 = info[3] & (1 << 26);
+	const bool osxsave = info[2] & (1 << 27);
+	const bool avx = info[2] & (1 << 28);
+
+	// whether the OS saves the YMM (bits 1, 2) and ZMM registers (bits 5-7)
+	const auto xcr0 = osxsave ? _xgetbv(0) : 0;
+	const bool ymm = avx && (xcr0 & 0x06) == 0x06;
+	const bool zmm = ymm && (xcr0 & 0xe0) == 0xe0;
+
+	bool avx2 = false;
+	bool avx512f = false;
+	if (maxLeaf >= 7)
+	{
+		__cpuidex(info, 7, 0);
+		avx2 = info[1] & (1 << 5);
+		avx512f = info[1] & (1 << 16);
+	}
+
+	if (zmm && avx512f) { return SimdLevel::Avx512; }
+	if (ymm && avx2) { return SimdLevel::Avx2; }
+	if (sse2) { return SimdLevel::Sse2; }
+#endif
+#endif
+	return SimdLevel::None;
+}
+
+
+const Kernels* kernelsFor( SimdLevel level )
+{
+	switch( level )
+	{
+#ifdef LMMS_HAVE_MIX_HELPERS_SIMD
+		case SimdLevel::Avx512: return avx512Kernels();
+		case SimdLevel::Avx2: return avx2Kernels();
+		case SimdLevel::Sse2: return sse2Kernels();
+#endif
+		default: return &s_scalarKernels;
+	}
+}
+
+
+struct Dispatch
+{
+	SimdLevel level;
+	const Kernels* kernels;
+} ;
+
+Dispatch& dispatch()
+{
+	static auto s_dispatch = Dispatch{ supportedSimdLevel(), kernelsFor( supportedSimdLevel() ) };
+	return s_dispatch;
+}
+
+inline const Kernels& kernels()
+{
+	return *dispatch().kernels;
+}
+
+} // namespace
+
+
+
+SimdLevel supportedSimdLevel()
+{
+	static const auto s_supported = detectSimdLevel();
+	return s_supported;
+}
+
+SimdLevel simdLevel()
+{
+	return dispatch().level;
+}
+
+void setSimdLevel( SimdLevel level )
+{
+	level = std::min( level, supportedSimdLevel() );
+	dispatch() = Dispatch{ level, kernelsFor( level ) };
+}
+
+
+
+bool isSilent( const SampleFrame* src, int frames )
+{
+	return kernels().isSilent( src, frames );
+}
+
+bool useNaNHandler()
+{
+	return s_NaNHandler;
+}
+
+void setNaNHandler( bool use )
+{
+	s_NaNHandler = use;
+}
+
+/*! \brief Function for sanitizing a buffer of infs/nans - returns true if those are found */
+bool sanitize( SampleFrame* src, int frames )
+{
+	if( !useNaNHandler() )
+	{
+		return false;
+	}
+
+	return kernels().sanitize( src, frames );
+}
+
+bool sanitize( PlanarBuffer& buf, int frames )
+{
+	if( !useNaNHandler() )
+	{
+		return false;
+	}
+
+	// a channel is a sequence of frames / 2 stereo frames plus possibly one
+	// sample, which is enough for the interleaved implementation
+	bool bad = false;
+	for( ch_cnt_t ch = 0; ch < DEFAULT_CHANNELS; ++ch )
+	{
+		sample_t* samples = buf.channel( ch );
+		bad |= kernels().sanitize( reinterpret_cast<SampleFrame*>( samples ), frames / 2 );
+		if( frames % 2 )
+		{
+			sample_t& last = samples[frames - 1];
+			bad |= std::isinf( last ) || std::isnan( last );
+			last = std::clamp( last, sample_t( -1000.0 ), sample_t( 1000.0 ) );
+		}
+	}
+
+	// clear all channels like sanitize() does with all frames
+	if( bad )
+	{
+		buf.zero( frames );
+	}
+	return bad;
+}
+
+
+void add( SampleFrame* dst, const SampleFrame* src, int frames )
+{
+	kernels().add( dst, src, frames );
+}
+
 
 void addMultiplied( SampleFrame* dst, const SampleFrame* src, float coeffSrc, int frames )
 {
-	run<>( dst, src, frames, AddMultipliedOp(coeffSrc) );
+	kernels().addMultiplied( dst, src, coeffSrc, frames );
 }
 
 
@@ -174,10 +398,7 @@ struct AddSwappedMultipliedOp
 
 void multiply(SampleFrame* dst, float coeff, int frames)
 {
-	for (int i = 0; i < frames; ++i)
-	{
-		dst[i] *= coeff;
-	}
+	kernels().multiply(dst, coeff, frames);
 }
 
 void addSwappedMultiplied( SampleFrame* dst, const SampleFrame* src, float coeffSrc, int frames )
@@ -197,12 +418,7 @@ void addMultipliedByBuffer( SampleFrame* dst, const SampleFrame* src, float coef
 
 void addMultipliedByBuffers( SampleFrame* dst, const SampleFrame* src, ValueBuffer * coeffSrcBuf1, ValueBuffer * coeffSrcBuf2, int frames )
 {
-	for( int f = 0; f < frames; ++f )
-	{
-		dst[f][0] += src[f][0] * coeffSrcBuf1->values()[f] * coeffSrcBuf2->values()[f];
-		dst[f][1] += src[f][1] * coeffSrcBuf1->values()[f] * coeffSrcBuf2->values()[f];
-	}
-
+	kernels().addMultipliedByBuffers( dst, src, coeffSrcBuf1->values(), coeffSrcBuf2->values(), frames );
 }
 
 void addSanitizedMultipliedByBuffer( SampleFrame* dst, const SampleFrame* src, float coeffSrc, ValueBuffer * coeffSrcBuf, int frames )
@@ -230,32 +446,10 @@ void addSanitizedMultipliedByBuffers( SampleFrame* dst, const SampleFrame* src,
 		return;
 	}
 
-	for( int f = 0; f < frames; ++f )
-	{
-		dst[f][0] += ( std::isinf( src[f][0] ) || std::isnan( src[f][0] ) )
-			? 0.0f
-			: src[f][0] * coeffSrcBuf1->values()[f] * coeffSrcBuf2->values()[f];
-		dst[f][1] += ( std::isinf( src[f][1] ) || std::isnan( src[f][1] ) )
-			? 0.0f
-			: src[f][1] * coeffSrcBuf1->values()[f] * coeffSrcBuf2->values()[f];
-	}
-
+	kernels().addSanitizedMultipliedByBuffers( dst, src, coeffSrcBuf1->values(), coeffSrcBuf2->values(), frames );
 }
 
 
-struct AddSanitizedMultipliedOp
-{
-	AddSanitizedMultipliedOp( float coeff ) : m_coeff( coeff ) { }
-
-	void operator()( SampleFrame& dst, const SampleFrame& src ) const
-	{
-		dst[0] += ( std::isinf( src[0] ) || std::isnan( src[0] ) ) ? 0.0f : src[0] * m_coeff;
-		dst[1] += ( std::isinf( src[1] ) || std::isnan( src[1] ) ) ? 0.0f : src[1] * m_coeff;
-	}
-
-	const float m_coeff;
-};
-
 void addSanitizedMultiplied( SampleFrame* dst, const SampleFrame* src, float coeffSrc, int frames )
 {
 	if ( !useNaNHandler() )
@@ -264,7 +458,7 @@ void addSanitizedMultiplied( SampleFrame* dst, const SampleFrame* src, float coe
 		return;
 	}
 
-	run<>( dst, src, frames, AddSanitizedMultipliedOp(coeffSrc) );
+	kernels().addSanitizedMultiplied( dst, src, coeffSrc, frames );
 }
 
 
@@ -331,4 +525,3 @@ void multiplyAndAddMultipliedJoined( SampleFrame* dst,
 }
 
 } // namespace lmms::MixHelpers
-
@@ -0,0 +1,90 @@
+/*
+ * MixHelpersAvx2.cpp - MixHelpers using AVX2
+ *
+ * This file is part of LMMS - https://lmms.io
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this program (see COPYING); if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301 USA.
+ *
+ */
+
+// Compiled with AVX2 enabled, see src/CMakeLists.txt
+
+#include "MixHelpersSimd.h"
+
+#ifdef LMMS_HAVE_MIX_HELPERS_SIMD
+
+#include <immintrin.h>
+
+#include "MixHelpersKernels.h"
+
+namespace lmms::MixHelpers
+{
+
+namespace
+{
+
+struct Avx2
+{
+	using Vec = __m256;
+	using Mask = __m256;
+	static constexpr int Width = 8;
+
+	static Vec load(const float* p) { return _mm256_loadu_ps(p); }
+	static void store(float* p, Vec v) { _mm256_storeu_ps(p, v); }
+	static Vec set1(float f) { return _mm256_set1_ps(f); }
+	static Vec add(Vec a, Vec b) { return _mm256_add_ps(a, b); }
+	static Vec mul(Vec a, Vec b) { return _mm256_mul_ps(a, b); }
+	static Vec min(Vec a, Vec b) { return _mm256_min_ps(a, b); }
+	static Vec max(Vec a, Vec b) { return _mm256_max_ps(a, b); }
+
+	static Vec frameCoeffs(const float* p)
+	{
+		const auto duplicate = _mm256_setr_epi32(0, 0, 1, 1, 2, 2, 3, 3);
+		return _mm256_permutevar8x32_ps(_mm256_castps128_ps256(_mm_loadu_ps(p)), duplicate);
+	}
+
+	static Mask nonFinite(Vec v)
+	{
+		const auto exponent = _mm256_set1_epi32(0x7f800000);
+		return _mm256_castsi256_ps(_mm256_cmpeq_epi32(_mm256_and_si256(_mm256_castps_si256(v), exponent), exponent));
+	}
+
+	static Vec zeroWhere(Mask m, Vec v) { return _mm256_andnot_ps(m, v); }
+
+	static Mask absGreaterEqual(Vec v, Vec threshold)
+	{
+		const auto abs = _mm256_and_ps(v, _mm256_castsi256_ps(_mm256_set1_epi32(0x7fffffff)));
+		return _mm256_cmp_ps(abs, threshold, _CMP_GE_OQ);
+	}
+
+	static Mask none() { return _mm256_setzero_ps(); }
+	static Mask either(Mask a, Mask b) { return _mm256_or_ps(a, b); }
+	static bool any(Mask m) { return _mm256_movemask_ps(m) != 0; }
+} ;
+
+constexpr Kernels s_kernels = makeKernels<Avx2>();
+
+} // namespace
+
+
+const Kernels* avx2Kernels()
+{
+	return &s_kernels;
+}
+
+} // namespace lmms::MixHelpers
+
+#endif // LMMS_HAVE_MIX_HELPERS_SIMD
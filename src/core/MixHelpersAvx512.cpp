@@ -0,0 +1,89 @@
+/*
+ * MixHelpersAvx512.cpp - MixHelpers using AVX-512F
+ *
+ * This file is part of LMMS - https://lmms.io
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this program (see COPYING); if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301 USA.
+ *
+ */
+
+// Compiled with AVX-512F enabled, see src/CMakeLists.txt
+
+#include "MixHelpersSimd.h"
+
+#ifdef LMMS_HAVE_MIX_HELPERS_SIMD
+
+#include <immintrin.h>
+
+#include "MixHelpersKernels.h"
+
+namespace lmms::MixHelpers
+{
+
+namespace
+{
+
+struct Avx512
+{
+	using Vec = __m512;
+	using Mask = __mmask16;
+	static constexpr int Width = 16;
+
+	static Vec load(const float* p) { return _mm512_loadu_ps(p); }
+	static void store(float* p, Vec v) { _mm512_storeu_ps(p, v); }
+	static Vec set1(float f) { return _mm512_set1_ps(f); }
+	static Vec add(Vec a, Vec b) { return _mm512_add_ps(a, b); }
+	static Vec mul(Vec a, Vec b) { return _mm512_mul_ps(a, b); }
+	static Vec min(Vec a, Vec b) { return _mm512_min_ps(a, b); }
+	static Vec max(Vec a, Vec b) { return _mm512_max_ps(a, b); }
+
+	static Vec frameCoeffs(const float* p)
+	{
+		const auto duplicate = _mm512_setr_epi32(0, 0, 1, 1, 2, 2, 3, 3, 4, 4, 5, 5, 6, 6, 7, 7);
+		return _mm512_permutexvar_ps(duplicate, _mm512_castps256_ps512(_mm256_loadu_ps(p)));
+	}
+
+	static Mask nonFinite(Vec v)
+	{
+		const auto exponent = _mm512_set1_epi32(0x7f800000);
+		return _mm512_cmpeq_epi32_mask(_mm512_and_si512(_mm512_castps_si512(v), exponent), exponent);
+	}
+
+	static Vec zeroWhere(Mask m, Vec v) { return _mm512_maskz_mov_ps(static_cast<Mask>(~m), v); }
+
+	static Mask absGreaterEqual(Vec v, Vec threshold)
+	{
+		return _mm512_cmp_ps_mask(_mm512_abs_ps(v), threshold, _CMP_GE_OQ);
+	}
+
+	static Mask none() { return 0; }
+	static Mask either(Mask a, Mask b) { return static_cast<Mask>(a | b); }
+	static bool any(Mask m) { return m != 0; }
+} ;
+
+constexpr Kernels s_kernels = makeKernels<Avx512>();
+
+} // namespace
+
+
+const Kernels* avx512Kernels()
+{
+	return &s_kernels;
+}
+
+} // namespace lmms::MixHelpers
+
+#endif // LMMS_HAVE_MIX_HELPERS_SIMD
@@ -0,0 +1,224 @@
+/*
+ * MixHelpersKernels.h - MixHelpers implemented on top of a vector type
+ *
+ * This file is part of LMMS - https://lmms.io
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this program (see COPYING); if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301 USA.
+ *
+ */
+
+#ifndef LMMS_MIX_HELPERS_KERNELS_H
+#define LMMS_MIX_HELPERS_KERNELS_H
+
+#include <cstdint>
+#include <cstring>
+
+#include "MixHelpersSimd.h"
+
+/*
+	Only to be included by the translation units compiled for a specific
+	instruction set. Everything in here has internal linkage and only uses
+	the vector type passed as template argument, so no inline function of
+	another header gets compiled with instructions the CPU might not have.
+
+	The vector type V provides:
+		Vec, Mask          vector of floats and result of comparisons
+		Width              number of floats in Vec, a multiple of 2
+		load, store        unaligned access to Width floats
+		set1, add, mul, min, max
+		frameCoeffs(p)     Width / 2 floats from p, each one repeated for
+		                   both channels
+		nonFinite(v)       mask of the infs and NaNs in v
+		zeroWhere(m, v)    v with the elements in m set to 0
+		absGreaterEqual(v, threshold)
+		none(), either(m1, m2), any(m)
+
+	The results equal the ones of the scalar implementations bit by bit,
+	therefore the operations are done in the same order and FMA is not used.
+*/
+
+namespace lmms::MixHelpers
+{
+
+namespace
+{
+
+constexpr float SilenceThreshold = 0.0000001f;
+constexpr float SanitizeLimit = 1000.f;
+
+inline float* samples(SampleFrame* frames) { return reinterpret_cast<float*>(frames); }
+inline const float* samples(const SampleFrame* frames) { return reinterpret_cast<const float*>(frames); }
+
+inline bool isFinite(float sample)
+{
+	auto bits = std::uint32_t{0};
+	std::memcpy(&bits, &sample, sizeof(bits));
+	return (bits & 0x7f800000u) != 0x7f800000u;
+}
+
+
+template<typename V>
+bool isSilent(const SampleFrame* src, int frames)
+{
+	const float* s = samples(src);
+	const int count = frames * 2;
+	const auto threshold = V::set1(SilenceThreshold);
+
+	int i = 0;
+	for (; i + V::Width <= count; i += V::Width)
+	{
+		if (V::any(V::absGreaterEqual(V::load(s + i), threshold))) { return false; }
+	}
+	for (; i < count; ++i)
+	{
+		if (s[i] >= SilenceThreshold || -s[i] >= SilenceThreshold) { return false; }
+	}
+	return true;
+}
+
+
+template<typename V>
+bool sanitize(SampleFrame* src, int frames)
+{
+	float* s = samples(src);
+	const int count = frames * 2;
+	const auto low = V::set1(-SanitizeLimit);
+	const auto high = V::set1(SanitizeLimit);
+
+	// clamp everything and clear the whole buffer afterwards if needed,
+	// the result is the same as stopping at the first bad sample
+	auto bad = V::none();
+	bool badTail = false;
+
+	int i = 0;
+	for (; i + V::Width <= count; i += V::Width)
+	{
+		const auto v = V::load(s + i);
+		bad = V::either(bad, V::nonFinite(v));
+		V::store(s + i, V::min(V::max(v, low), high));
+	}
+	for (; i < count; ++i)
+	{
+		badTail = badTail || !isFinite(s[i]);
+		s[i] = s[i] < -SanitizeLimit ? -SanitizeLimit : SanitizeLimit < s[i] ? SanitizeLimit : s[i];
+	}
+
+	if (!V::any(bad) && !badTail) { return false; }
+
+	const auto zero = V::set1(0.f);
+	for (i = 0; i + V::Width <= count; i += V::Width) { V::store(s + i, zero); }
+	for (; i < count; ++i) { s[i] = 0.f; }
+	return true;
+}
+
+
+template<typename V>
+void add(SampleFrame* dst, const SampleFrame* src, int frames)
+{
+	float* d = samples(dst);
+	const float* s = samples(src);
+	const int count = frames * 2;
+
+	int i = 0;
+	for (; i + V::Width <= count; i += V::Width)
+	{
+		V::store(d + i, V::add(V::load(d + i), V::load(s + i)));
+	}
+	for (; i < count; ++i) { d[i] += s[i]; }
+}
+
+
+template<typename V>
+void multiply(SampleFrame* dst, float coeff, int frames)
+{
+	float* d = samples(dst);
+	const int count = frames * 2;
+	const auto c = V::set1(coeff);
+
+	int i = 0;
+	for (; i + V::Width <= count; i += V::Width)
+	{
+		V::store(d + i, V::mul(V::load(d + i), c));
+	}
+	for (; i < count; ++i) { d[i] *= coeff; }
+}
+
+
+template<typename V, bool Sanitized>
+void addMultiplied(SampleFrame* dst, const SampleFrame* src, float coeffSrc, int frames)
+{
+	float* d = samples(dst);
+	const float* s = samples(src);
+	const int count = frames * 2;
+	const auto c = V::set1(coeffSrc);
+
+	int i = 0;
+	for (; i + V::Width <= count; i += V::Width)
+	{
+		const auto v = V::load(s + i);
+		const auto product = V::mul(v, c);
+		V::store(d + i, V::add(V::load(d + i), Sanitized ? V::zeroWhere(V::nonFinite(v), product) : product));
+	}
+	for (; i < count; ++i)
+	{
+		d[i] += Sanitized && !isFinite(s[i]) ? 0.f : s[i] * coeffSrc;
+	}
+}
+
+
+template<typename V, bool Sanitized>
+void addMultipliedByBuffers(SampleFrame* dst, const SampleFrame* src,
+	const float* coeffSrcBuf1, const float* coeffSrcBuf2, int frames)
+{
+	float* d = samples(dst);
+	const float* s = samples(src);
+	const int count = frames * 2;
+
+	int i = 0;
+	for (; i + V::Width <= count; i += V::Width)
+	{
+		const auto v = V::load(s + i);
+		const auto product = V::mul(V::mul(v, V::frameCoeffs(coeffSrcBuf1 + i / 2)),
+			V::frameCoeffs(coeffSrcBuf2 + i / 2));
+		V::store(d + i, V::add(V::load(d + i), Sanitized ? V::zeroWhere(V::nonFinite(v), product) : product));
+	}
+	for (; i < count; ++i)
+	{
+		d[i] += Sanitized && !isFinite(s[i]) ? 0.f : s[i] * coeffSrcBuf1[i / 2] * coeffSrcBuf2[i / 2];
+	}
+}
+
+
+template<typename V>
+constexpr Kernels makeKernels()
+{
+	return Kernels{
+		isSilent<V>,
+		sanitize<V>,
+		add<V>,
+		multiply<V>,
+		addMultiplied<V, false>,
+		addMultiplied<V, true>,
+		addMultipliedByBuffers<V, false>,
+		addMultipliedByBuffers<V, true>
+	};
+}
+
+} // namespace
+
+} // namespace lmms::MixHelpers
+
+#endif // LMMS_MIX_HELPERS_KERNELS_H
@@ -0,0 +1,67 @@
+/*
+ * MixHelpersSimd.h - instruction set specific implementations of MixHelpers
+ *
+ * This file is part of LMMS - https://lmms.io
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this program (see COPYING); if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301 USA.
+ *
+ */
+
+#ifndef LMMS_MIX_HELPERS_SIMD_H
+#define LMMS_MIX_HELPERS_SIMD_H
+
+#include "lmmsconfig.h"
+
+namespace lmms
+{
+
+class SampleFrame;
+
+namespace MixHelpers
+{
+
+//! The functions of MixHelpers which have vectorized implementations. The
+//! NaN handler setting is checked by the callers, so sanitize and the
+//! sanitizing functions always check their input.
+struct Kernels
+{
+	bool (*isSilent)(const SampleFrame* src, int frames);
+	bool (*sanitize)(SampleFrame* src, int frames);
+	void (*add)(SampleFrame* dst, const SampleFrame* src, int frames);
+	void (*multiply)(SampleFrame* dst, float coeff, int frames);
+	void (*addMultiplied)(SampleFrame* dst, const SampleFrame* src, float coeffSrc, int frames);
+	void (*addSanitizedMultiplied)(SampleFrame* dst, const SampleFrame* src, float coeffSrc, int frames);
+	void (*addMultipliedByBuffers)(SampleFrame* dst, const SampleFrame* src,
+		const float* coeffSrcBuf1, const float* coeffSrcBuf2, int frames);
+	void (*addSanitizedMultipliedByBuffers)(SampleFrame* dst, const SampleFrame* src,
+		const float* coeffSrcBuf1, const float* coeffSrcBuf2, int frames);
+} ;
+
+#if defined(LMMS_HOST_X86) || defined(LMMS_HOST_X86_64)
+#define LMMS_HAVE_MIX_HELPERS_SIMD
+
+// Each of these is defined in a translation unit compiled for the respective
+// instruction set, so they must only be called if the CPU supports it
+const Kernels* sse2Kernels();
+const Kernels* avx2Kernels();
+const Kernels* avx512Kernels();
+#endif
+
+} // namespace MixHelpers
+
+} // namespace lmms
+
+#endif // LMMS_MIX_HELPERS_SIMD_H
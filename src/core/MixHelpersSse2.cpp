@@ -0,0 +1,90 @@
+/*
+ * MixHelpersSse2.cpp - MixHelpers using SSE2
+ *
+ * This file is part of LMMS - https://lmms.io
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this program (see COPYING); if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301 USA.
+ *
+ */
+
+// Compiled with SSE2 enabled, see src/CMakeLists.txt
+
+#include "MixHelpersSimd.h"
+
+#ifdef LMMS_HAVE_MIX_HELPERS_SIMD
+
+#include <immintrin.h>
+
+#include "MixHelpersKernels.h"
+
+namespace lmms::MixHelpers
+{
+
+namespace
+{
+
+struct Sse2
+{
+	using Vec = __m128;
+	using Mask = __m128;
+	static constexpr int Width = 4;
+
+	static Vec load(const float* p) { return _mm_loadu_ps(p); }
+	static void store(float* p, Vec v) { _mm_storeu_ps(p, v); }
+	static Vec set1(float f) { return _mm_set1_ps(f); }
+	static Vec add(Vec a, Vec b) { return _mm_add_ps(a, b); }
+	static Vec mul(Vec a, Vec b) { return _mm_mul_ps(a, b); }
+	static Vec min(Vec a, Vec b) { return _mm_min_ps(a, b); }
+	static Vec max(Vec a, Vec b) { return _mm_max_ps(a, b); }
+
+	static Vec frameCoeffs(const float* p)
+	{
+		const auto coeffs = _mm_castpd_ps(_mm_load_sd(reinterpret_cast<const double*>(p)));
+		return _mm_unpacklo_ps(coeffs, coeffs);
+	}
+
+	static Mask nonFinite(Vec v)
+	{
+		const auto exponent = _mm_set1_epi32(0x7f800000);
+		return _mm_castsi128_ps(_mm_cmpeq_epi32(_mm_and_si128(_mm_castps_si128(v), exponent), exponent));
+	}
+
+	static Vec zeroWhere(Mask m, Vec v) { return _mm_andnot_ps(m, v); }
+
+	static Mask absGreaterEqual(Vec v, Vec threshold)
+	{
+		const auto abs = _mm_and_ps(v, _mm_castsi128_ps(_mm_set1_epi32(0x7fffffff)));
+		return _mm_cmpge_ps(abs, threshold);
+	}
+
+	static Mask none() { return _mm_setzero_ps(); }
+	static Mask either(Mask a, Mask b) { return _mm_or_ps(a, b); }
+	static bool any(Mask m) { return _mm_movemask_ps(m) != 0; }
+} ;
+
+constexpr Kernels s_kernels = makeKernels<Sse2>();
+
+} // namespace
+
+
+const Kernels* sse2Kernels()
+{
+	return &s_kernels;
+}
+
+} // namespace lmms::MixHelpers
+
+#endif // LMMS_HAVE_MIX_HELPERS_SIMD
@@ -24,11 +24,15 @@
 
 #include <QDomElement>
 
+#include <algorithm>
+#include <span>
+
 #include "AudioEngine.h"
 #include "AudioEngineWorkerThread.h"
 #include "BufferManager.h"
 #include "Mixer.h"
 #include "MixHelpers.h"
+#include "RenderTracer.h"
 #include "Song.h"
 
 #include "InstrumentTrack.h"
@@ -71,10 +75,11 @@ MixerChannel::MixerChannel( int idx, Model * _parent ) :
 	m_name(),
 	m_lock(),
 	m_channelIndex( idx ),
-	m_queued( false ),
-	m_dependenciesMet(0)
+	m_muted( false ),
+	m_unscheduledReceives( 0 )
 {
 	zeroSampleFrames(m_buffer, Engine::audioEngine()->framesPerPeriod());
+	setCpuTimeCounter(&m_cpuTime);
 }
 
 
@@ -86,27 +91,6 @@ MixerChannel::~MixerChannel()
 }
 
 
-inline void MixerChannel::processed()
-{
-	for( const MixerRoute * receiverRoute : m_sends )
-	{
-		if( receiverRoute->receiver()->m_muted == false )
-		{
-			receiverRoute->receiver()->incrementDeps();
-		}
-	}
-}
-
-void MixerChannel::incrementDeps()
-{
-	const auto i = m_dependenciesMet++ + 1;
-	if( i >= m_receives.size() && ! m_queued )
-	{
-		m_queued = true;
-		AudioEngineWorkerThread::addJob( this );
-	}
-}
-
 void MixerChannel::unmuteForSolo()
 {
 	//TODO: Recursively activate every channel, this channel sends to
@@ -119,6 +103,7 @@ void MixerChannel::doProcessing()
 {
 	const fpp_t fpp = Engine::audioEngine()->framesPerPeriod();
 
+	m_muted = m_muteModel.value();
 	if( m_muted == false )
 	{
 		for( MixerRoute * senderRoute : m_receives )
@@ -179,9 +164,6 @@ void MixerChannel::doProcessing()
 	{
 		m_peakLeft = m_peakRight = 0.0f;
 	}
-
-	// increment dependency counter of all receivers
-	processed();
 }
 
 
@@ -190,6 +172,7 @@ Mixer::Mixer() :
 	Model( nullptr ),
 	JournallingObject(),
 	m_mixerChannels(),
+	m_routingPlan(Engine::audioEngine()->rcuDomain()),
 	m_lastSoloed(-1)
 {
 	// create master channel
@@ -219,6 +202,7 @@ int Mixer::createChannel()
 	const int index = m_mixerChannels.size();
 	// create new channel
 	m_mixerChannels.push_back( new MixerChannel( index, this ) );
+	updateRoutingPlan();
 
 	// reset channel state
 	clearChannel( index );
@@ -353,6 +337,8 @@ void Mixer::deleteChannel( int index )
 
 	// actually delete the channel
 	m_mixerChannels.erase(m_mixerChannels.begin() + index);
+	updateRoutingPlan();
+	Engine::audioEngine()->synchronizeSnapshots();
 	delete ch;
 
 	for (auto i = static_cast<std::size_t>(index); i < m_mixerChannels.size(); ++i)
@@ -435,6 +421,8 @@ void Mixer::moveChannelLeft( int index )
 	// Update m_channelIndex of both channels
 	m_mixerChannels[index]->m_channelIndex = index;
 	m_mixerChannels[index - 1]->m_channelIndex = index -1;
+
+	updateRoutingPlan();
 }
 
 
@@ -486,6 +474,7 @@ MixerRoute * Mixer::createRoute( MixerChannel * from, MixerChannel * to, float a
 
 	// add us to mixer's list
 	Engine::mixer()->m_mixerRoutes.push_back(route);
+	Engine::mixer()->updateRoutingPlan();
 	Engine::audioEngine()->doneChangeInModel();
 
 	return route;
@@ -529,6 +518,7 @@ void Mixer::deleteChannelSend( MixerRoute * route )
 
 	// remove us from mixer's list
 	removeFromMixerRoute(Engine::mixer()->m_mixerRoutes);
+	Engine::mixer()->updateRoutingPlan();
 
 	delete route;
 	Engine::audioEngine()->doneChangeInModel();
@@ -598,12 +588,14 @@ FloatModel * Mixer::channelSendModel( mix_ch_t fromChannel, mix_ch_t toChannel )
 
 void Mixer::mixToChannel( const SampleFrame* _buf, mix_ch_t _ch )
 {
-	if( m_mixerChannels[_ch]->m_muteModel.value() == false )
+	// called by the audio thread, which must not access m_mixerChannels
+	MixerChannel * ch = m_routingPlan.read().channels[_ch];
+	if( ch->m_muteModel.value() == false )
 	{
-		m_mixerChannels[_ch]->m_lock.lock();
-		MixHelpers::add( m_mixerChannels[_ch]->m_buffer, _buf, Engine::audioEngine()->framesPerPeriod() );
-		m_mixerChannels[_ch]->m_hasInput = true;
-		m_mixerChannels[_ch]->m_lock.unlock();
+		ch->m_lock.lock();
+		MixHelpers::add( ch->m_buffer, _buf, Engine::audioEngine()->framesPerPeriod() );
+		ch->m_hasInput = true;
+		ch->m_lock.unlock();
 	}
 }
 
@@ -612,84 +604,106 @@ void Mixer::mixToChannel( const SampleFrame* _buf, mix_ch_t _ch )
 
 void Mixer::prepareMasterMix()
 {
-	zeroSampleFrames(m_mixerChannels[0]->m_buffer, Engine::audioEngine()->framesPerPeriod());
+	zeroSampleFrames(m_routingPlan.read().channels[0]->m_buffer, Engine::audioEngine()->framesPerPeriod());
 }
 
 
 
-void Mixer::masterMix( SampleFrame* _buf )
+void Mixer::updateRoutingPlan()
 {
-	const int fpp = Engine::audioEngine()->framesPerPeriod();
+	m_routingPlan.update([this](RoutingPlan& plan) { compileRoutingPlan(plan); });
+}
 
-	// add the channels that have no dependencies (no incoming senders, ie.
-	// no receives) to the jobqueue. The channels that have receives get
-	// added when their senders get processed, which is detected by
-	// dependency counting.
-	// also instantly add all muted channels as they don't need to care
-	// about their senders, and can just increment the deps of their
-	// recipients right away.
-	AudioEngineWorkerThread::resetJobQueue( AudioEngineWorkerThread::JobQueue::OperationMode::Dynamic );
-	for( MixerChannel * ch : m_mixerChannels )
-	{
-		ch->m_muted = ch->m_muteModel.value();
-		if( ch->m_muted ) // instantly "process" muted channels
-		{
-			ch->processed();
-			ch->done();
-		}
-		else if( ch->m_receives.size() == 0 )
+
+
+void Mixer::compileRoutingPlan(RoutingPlan& plan)
+{
+	plan.channels = m_mixerChannels;
+	plan.order.clear();
+	plan.levels.clear();
+	plan.order.reserve(m_mixerChannels.size());
+	plan.levels.reserve(m_mixerChannels.size() + 1);
+
+	// the first level consists of all channels without senders. muted
+	// channels are part of the plan as well, so mute changes, which can be
+	// automated, don't require a new plan
+	for (MixerChannel* ch : m_mixerChannels)
+	{
+		ch->m_unscheduledReceives = ch->m_receives.size();
+		if (ch->m_unscheduledReceives == 0)
 		{
-			ch->m_queued = true;
-			AudioEngineWorkerThread::addJob( ch );
+			plan.order.push_back(ch);
 		}
 	}
-	while (m_mixerChannels[0]->state() != ThreadableJob::ProcessingState::Done)
+
+	// a channel enters the level after its last sender
+	std::size_t levelBegin = 0;
+	while (levelBegin < plan.order.size())
 	{
-		bool found = false;
-		for( MixerChannel * ch : m_mixerChannels )
+		const std::size_t levelEnd = plan.order.size();
+		plan.levels.push_back(levelBegin);
+		for (std::size_t i = levelBegin; i < levelEnd; ++i)
 		{
-			const auto s = ch->state();
-			if (s == ThreadableJob::ProcessingState::Queued
-				|| s == ThreadableJob::ProcessingState::InProgress)
+			for (const MixerRoute* send : plan.order[i]->m_sends)
 			{
-				found = true;
-				break;
+				MixerChannel* receiver = send->receiver();
+				if (--receiver->m_unscheduledReceives == 0)
+				{
+					plan.order.push_back(receiver);
+				}
 			}
 		}
-		if( !found )
-		{
-			break;
-		}
+		levelBegin = levelEnd;
+	}
+	plan.levels.push_back(plan.order.size());
+}
+
+
+
+void Mixer::masterMix( SampleFrame* _buf )
+{
+	const int fpp = Engine::audioEngine()->framesPerPeriod();
+
+	// the plan stays valid until the end of the period, even if channels
+	// get added or removed in the meantime
+	const RoutingPlan& plan = m_routingPlan.read();
+	MixerChannel* master = plan.channels[0];
+
+	// process the channels level by level. all channels of a level only
+	// depend on channels of previous levels, so they can run in parallel
+	for (std::size_t level = 0; level + 1 < plan.levels.size(); ++level)
+	{
+		RenderTracer::Scope traceScope("Mixer level", "mixer");
+		AudioEngineWorkerThread::fillJobQueue(std::span{plan.order.begin() + plan.levels[level],
+			plan.order.begin() + plan.levels[level + 1]});
 		AudioEngineWorkerThread::startAndWaitForJobs();
 	}
 
 	// handle sample-exact data in master volume fader
-	ValueBuffer * volBuf = m_mixerChannels[0]->m_volumeModel.valueBuffer();
+	ValueBuffer * volBuf = master->m_volumeModel.valueBuffer();
 
 	if( volBuf )
 	{
 		for( int f = 0; f < fpp; f++ )
 		{
-			m_mixerChannels[0]->m_buffer[f][0] *= volBuf->values()[f];
-			m_mixerChannels[0]->m_buffer[f][1] *= volBuf->values()[f];
+			master->m_buffer[f][0] *= volBuf->values()[f];
+			master->m_buffer[f][1] *= volBuf->values()[f];
 		}
 	}
 
 	const float v = volBuf
 		? 1.0f
-		: m_mixerChannels[0]->m_volumeModel.value();
-	MixHelpers::addSanitizedMultiplied( _buf, m_mixerChannels[0]->m_buffer, v, fpp );
+		: master->m_volumeModel.value();
+	MixHelpers::addSanitizedMultiplied( _buf, master->m_buffer, v, fpp );
 
 	// clear all channel buffers and
 	// reset channel process state
-	for( int i = 0; i < numChannels(); ++i)
+	for (MixerChannel* ch : plan.channels)
 	{
-		zeroSampleFrames(m_mixerChannels[i]->m_buffer, Engine::audioEngine()->framesPerPeriod());
-		m_mixerChannels[i]->reset();
-		m_mixerChannels[i]->m_queued = false;
+		zeroSampleFrames(ch->m_buffer, Engine::audioEngine()->framesPerPeriod());
+		ch->reset();
 		// also reset hasInput
-		m_mixerChannels[i]->m_hasInput = false;
-		m_mixerChannels[i]->m_dependenciesMet = 0;
+		ch->m_hasInput = false;
 	}
 }
 
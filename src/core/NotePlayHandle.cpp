@@ -81,6 +81,7 @@ NotePlayHandle::NotePlayHandle( InstrumentTrack* instrumentTrack,
 	m_origin( origin ),
 	m_frequencyNeedsUpdate( false )
 {
+	setCpuTimeCounter(&instrumentTrack->cpuTime());
 	lock();
 	if( hasParent() == false )
 	{
@@ -602,25 +603,13 @@ void NotePlayHandle::resize( const bpm_t _new_tempo )
 }
 
 
-NotePlayHandle ** NotePlayHandleManager::s_available;
-QReadWriteLock NotePlayHandleManager::s_mutex;
-std::atomic_int NotePlayHandleManager::s_availableIndex;
-int NotePlayHandleManager::s_size;
+LocklessPoolT<NotePlayHandle> * NotePlayHandleManager::s_pool = nullptr;
 
 
 void NotePlayHandleManager::init()
 {
-	s_available = new NotePlayHandle*[INITIAL_NPH_CACHE];
-
-	auto n = static_cast<NotePlayHandle *>(std::malloc(sizeof(NotePlayHandle) * INITIAL_NPH_CACHE));
-
-	for( int i=0; i < INITIAL_NPH_CACHE; ++i )
-	{
-		s_available[ i ] = n;
-		++n;
-	}
-	s_availableIndex = INITIAL_NPH_CACHE - 1;
-	s_size = INITIAL_NPH_CACHE;
+	s_pool = new LocklessPoolT<NotePlayHandle>( INITIAL_NPH_CACHE, NPH_CACHE_WATERMARK,
+						NPH_CACHE_INCREMENT, MAX_NPH_CACHE );
 }
 
 
@@ -632,12 +621,7 @@ NotePlayHandle * NotePlayHandleManager::acquire( InstrumentTrack* instrumentTrac
 				int midiEventChannel,
 				NotePlayHandle::Origin origin )
 {
-	// TODO: use some lockless data structures
-	s_mutex.lockForWrite();
-	if (s_availableIndex < 0) { extend(NPH_CACHE_INCREMENT); }
-	NotePlayHandle * nph = s_available[s_availableIndex--];
-	s_mutex.unlock();
-
+	NotePlayHandle * nph = s_pool->alloc();
 	new( (void*)nph ) NotePlayHandle( instrumentTrack, offset, frames, noteToPlay, parent, midiEventChannel, origin );
 	return nph;
 }
@@ -646,31 +630,20 @@ NotePlayHandle * NotePlayHandleManager::acquire( InstrumentTrack* instrumentTrac
 void NotePlayHandleManager::release( NotePlayHandle * nph )
 {
 	nph->NotePlayHandle::~NotePlayHandle();
-	s_mutex.lockForRead();
-	s_available[++s_availableIndex] = nph;
-	s_mutex.unlock();
+	s_pool->free( nph );
 }
 
 
-void NotePlayHandleManager::extend( int c )
+void NotePlayHandleManager::free()
 {
-	s_size += c;
-	auto tmp = new NotePlayHandle*[s_size];
-	delete[] s_available;
-	s_available = tmp;
-
-	auto n = static_cast<NotePlayHandle *>(std::malloc(sizeof(NotePlayHandle) * c));
-
-	for( int i=0; i < c; ++i )
-	{
-		s_available[++s_availableIndex] = n;
-		++n;
-	}
+	delete s_pool;
+	s_pool = nullptr;
 }
 
-void NotePlayHandleManager::free()
+
+LocklessPool::Statistics NotePlayHandleManager::statistics()
 {
-	delete[] s_available;
+	return s_pool->statistics();
 }
 
 
@@ -26,6 +26,7 @@
 #include "Oscillator.h"
 
 #include <algorithm>
+#include <mutex>
 #if !defined(__MINGW32__) && !defined(__MINGW64__)
 	#include <thread>
 #endif
@@ -36,20 +37,60 @@
 #include "AutomatableModel.h"
 #include "fftw3.h"
 #include "fft_helpers.h"
+#include "MappedCache.h"
 
 
 namespace lmms
 {
 
 
+namespace
+{
+
+const auto WaveTablesCacheFile = QStringLiteral("oscillator-wavetables.bin");
+//! Bump this whenever the generated tables change
+constexpr std::uint32_t WaveTablesCacheVersion = 1;
+
+//! What the tables are generated from, which is checked when mapping them.
+//! They hold one cycle each and don't depend on the sample rate.
+struct WaveTablesParameters
+{
+	std::int32_t tableLength = OscillatorConstants::WAVETABLE_LENGTH;
+	std::int32_t tablesPerWaveform = OscillatorConstants::WAVE_TABLES_PER_WAVEFORM_COUNT;
+	std::int32_t semitonesPerTable = OscillatorConstants::SEMITONES_PER_TABLE;
+	std::int32_t maxFrequency = OscillatorConstants::MAX_FREQ;
+	std::int32_t waveforms = static_cast<std::int32_t>(Oscillator::NumWaveShapeTables);
+	std::int32_t sampleSize = sizeof(sample_t);
+};
+
+std::mutex s_fftPlanMutex;
+
+} // namespace
+
+
 void Oscillator::waveTableInit()
 {
-	createFFTPlans();
-	generateWaveTables();
-	// The oscillator FFT plans remain throughout the application lifecycle
-	// due to being expensive to create, and being used whenever a userwave form is changed
-	// deleted in main.cpp main()
+	if (s_waveTables) { return; }
+
+	// The tables only depend on compile-time constants, so they are generated once
+	// and mapped read-only from the cache on later runs
+	const auto parameters = WaveTablesParameters{};
+	s_waveTables = MappedCache::map<WaveTables>(WaveTablesCacheFile, WaveTablesCacheVersion, parameters);
+	if (s_waveTables) { return; }
 
+	auto tables = std::make_unique<WaveTables>();
+	generateWaveTables(*tables);
+
+	// Map the file that was just written, so the pages are shared with other instances
+	if (MappedCache::store(WaveTablesCacheFile, WaveTablesCacheVersion, *tables, parameters))
+	{
+		s_waveTables = MappedCache::map<WaveTables>(WaveTablesCacheFile, WaveTablesCacheVersion, parameters);
+	}
+	if (!s_waveTables)
+	{
+		s_generatedWaveTables = std::move(tables);
+		s_waveTables = s_generatedWaveTables.get();
+	}
 }
 
 Oscillator::Oscillator(const IntModel *wave_shape_model,
@@ -58,7 +99,8 @@ Oscillator::Oscillator(const IntModel *wave_shape_model,
 			const float &detuning_div_samplerate,
 			const float &phase_offset,
 			const float &volume,
-			Oscillator *sub_osc) :
+			Oscillator *sub_osc,
+			bool ownsSubOsc) :
 	m_waveShapeModel(wave_shape_model),
 	m_modulationAlgoModel(mod_algo_model),
 	m_freq(freq),
@@ -66,6 +108,7 @@ Oscillator::Oscillator(const IntModel *wave_shape_model,
 	m_volume(volume),
 	m_ext_phaseOffset(phase_offset),
 	m_subOsc(sub_osc),
+	m_ownsSubOsc(ownsSubOsc),
 	m_phaseOffset(phase_offset),
 	m_phase(phase_offset),
 	m_userWave(nullptr),
@@ -184,6 +227,8 @@ void Oscillator::generateFromFFT(int bands, sample_t* table)
 
 std::unique_ptr<OscillatorConstants::waveform_t> Oscillator::generateAntiAliasUserWaveTable(const SampleBuffer* sampleBuffer)
 {
+	createFFTPlans();
+
 	auto userAntiAliasWaveTable = std::make_unique<OscillatorConstants::waveform_t>();
 	for (int i = 0; i < OscillatorConstants::WAVE_TABLES_PER_WAVEFORM_COUNT; ++i)
 	{
@@ -203,19 +248,22 @@ std::unique_ptr<OscillatorConstants::waveform_t> Oscillator::generateAntiAliasUs
 
 
 
-sample_t Oscillator::s_waveTables
-	[Oscillator::NumWaveShapeTables]
-	[OscillatorConstants::WAVE_TABLES_PER_WAVEFORM_COUNT]
-	[OscillatorConstants::WAVETABLE_LENGTH];
+const Oscillator::WaveTables* Oscillator::s_waveTables = nullptr;
+std::unique_ptr<Oscillator::WaveTables> Oscillator::s_generatedWaveTables;
 fftwf_plan Oscillator::s_fftPlan;
 fftwf_plan Oscillator::s_ifftPlan;
-fftwf_complex * Oscillator::s_specBuf;
+fftwf_complex * Oscillator::s_specBuf = nullptr;
 std::array<float, OscillatorConstants::WAVETABLE_LENGTH> Oscillator::s_sampleBuffer;
 
 
 
 void Oscillator::createFFTPlans()
 {
+	// The plans are expensive to create, so they are only created once they are needed to
+	// generate a wave table, and then kept for the application lifecycle
+	const auto lock = std::lock_guard{s_fftPlanMutex};
+	if (s_specBuf != nullptr) { return; }
+
 	Oscillator::s_specBuf = ( fftwf_complex * ) fftwf_malloc( ( OscillatorConstants::WAVETABLE_LENGTH * 2 + 1 ) * sizeof( fftwf_complex ) );
 	Oscillator::s_fftPlan = fftwf_plan_dft_r2c_1d(OscillatorConstants::WAVETABLE_LENGTH, s_sampleBuffer.data(), s_specBuf, FFTW_MEASURE );
 	Oscillator::s_ifftPlan = fftwf_plan_dft_c2r_1d(OscillatorConstants::WAVETABLE_LENGTH, s_specBuf, s_sampleBuffer.data(), FFTW_MEASURE);
@@ -229,47 +277,44 @@ void Oscillator::createFFTPlans()
 
 void Oscillator::destroyFFTPlans()
 {
+	const auto lock = std::lock_guard{s_fftPlanMutex};
+	if (s_specBuf == nullptr) { return; }
+
 	fftwf_destroy_plan(s_fftPlan);
 	fftwf_destroy_plan(s_ifftPlan);
 	fftwf_free(s_specBuf);
+	s_specBuf = nullptr;
 }
 
-void Oscillator::generateWaveTables()
+void Oscillator::generateWaveTables(WaveTables& tables)
 {
 	// Generate tables for simple shaped (constructed by summing sine waves).
 	// Start from the table that contains the least number of bands, and re-use each table in the following
 	// iteration, adding more bands in each step and avoiding repeated computation of earlier bands.
 	using generator_t = void (*)(int, sample_t*, int);
-	auto simpleGen = [](WaveShape shape, generator_t generator)
+	auto simpleGen = [&tables](WaveShape shape, generator_t generator)
 	{
-		const int shapeID = static_cast<std::size_t>(shape) - FirstWaveShapeTable;
+		auto& waveform = tables[static_cast<std::size_t>(shape) - FirstWaveShapeTable];
 		int lastBands = 0;
 
 		// Clear the first wave table
-		std::fill(
-		    std::begin(s_waveTables[shapeID][OscillatorConstants::WAVE_TABLES_PER_WAVEFORM_COUNT - 1]),
-		    std::end(s_waveTables[shapeID][OscillatorConstants::WAVE_TABLES_PER_WAVEFORM_COUNT - 1]),
-		    0.f);
+		waveform[OscillatorConstants::WAVE_TABLES_PER_WAVEFORM_COUNT - 1].fill(0.f);
 
 		for (int i = OscillatorConstants::WAVE_TABLES_PER_WAVEFORM_COUNT - 1; i >= 0; i--)
 		{
 			const int bands = OscillatorConstants::MAX_FREQ / freqFromWaveTableBand(i);
-			generator(bands, s_waveTables[shapeID][i], lastBands + 1);
+			generator(bands, waveform[i].data(), lastBands + 1);
 			lastBands = bands;
-			if (i)
-			{
-				std::copy(
-					s_waveTables[shapeID][i],
-					s_waveTables[shapeID][i] + OscillatorConstants::WAVETABLE_LENGTH,
-					s_waveTables[shapeID][i - 1]);
-			}
+			if (i) { waveform[i - 1] = waveform[i]; }
 		}
 	};
 
 	// FFT-based wave shapes: make standard wave table without band limit, convert to frequency domain, remove bands
 	// above maximum frequency and convert back to time domain.
-	auto fftGen = []()
+	auto fftGen = [&tables]()
 	{
+		createFFTPlans();
+
 		// Generate moogSaw tables
 		for (int i = 0; i < OscillatorConstants::WAVE_TABLES_PER_WAVEFORM_COUNT; ++i)
 		{
@@ -278,7 +323,7 @@ void Oscillator::generateWaveTables()
 				Oscillator::s_sampleBuffer[i] = moogSawSample((float)i / (float)OscillatorConstants::WAVETABLE_LENGTH);
 			}
 			fftwf_execute(s_fftPlan);
-			generateFromFFT(OscillatorConstants::MAX_FREQ / freqFromWaveTableBand(i), s_waveTables[static_cast<std::size_t>(WaveShape::MoogSaw) - FirstWaveShapeTable][i]);
+			generateFromFFT(OscillatorConstants::MAX_FREQ / freqFromWaveTableBand(i), tables[static_cast<std::size_t>(WaveShape::MoogSaw) - FirstWaveShapeTable][i].data());
 		}
 
 		// Generate exponential tables
@@ -289,7 +334,7 @@ void Oscillator::generateWaveTables()
 				s_sampleBuffer[i] = expSample((float)i / (float)OscillatorConstants::WAVETABLE_LENGTH);
 			}
 			fftwf_execute(s_fftPlan);
-			generateFromFFT(OscillatorConstants::MAX_FREQ / freqFromWaveTableBand(i), s_waveTables[static_cast<std::size_t>(WaveShape::Exponential) - FirstWaveShapeTable][i]);
+			generateFromFFT(OscillatorConstants::MAX_FREQ / freqFromWaveTableBand(i), tables[static_cast<std::size_t>(WaveShape::Exponential) - FirstWaveShapeTable][i].data());
 		}
 	};
 
@@ -572,6 +617,37 @@ float Oscillator::syncInit( SampleFrame* _ab, const fpp_t _frames,
 
 
 
+template<Oscillator::WaveShape W, typename NextPhase, typename Mix>
+void Oscillator::renderBlocks(SampleFrame* ab, const fpp_t frames, const ch_cnt_t chnl,
+	NextPhase nextPhase, Mix mix)
+{
+	std::array<float, BlockSize> phases;
+	std::array<sample_t, BlockSize> samples;
+
+	for (fpp_t begin = 0; begin < frames; begin += BlockSize)
+	{
+		const fpp_t count = std::min(BlockSize, frames - begin);
+		SampleFrame* block = ab + begin;
+
+		// the phase of each frame depends on the previous one...
+		for (fpp_t frame = 0; frame < count; ++frame)
+		{
+			phases[frame] = nextPhase(block[frame][chnl]);
+		}
+
+		// ...but the samples don't
+		getSamples<W>(phases.data(), samples.data(), count);
+
+		for (fpp_t frame = 0; frame < count; ++frame)
+		{
+			block[frame][chnl] = mix(block[frame][chnl], samples[frame]);
+		}
+	}
+}
+
+
+
+
 // if we have no sub-osc, we can't do any modulation... just get our samples
 template<Oscillator::WaveShape W>
 void Oscillator::updateNoSub( SampleFrame* _ab, const fpp_t _frames,
@@ -579,12 +655,11 @@ void Oscillator::updateNoSub( SampleFrame* _ab, const fpp_t _frames,
 {
 	recalcPhase();
 	const float osc_coeff = m_freq * m_detuning_div_samplerate;
+	const float volume = m_volume;
 
-	for( fpp_t frame = 0; frame < _frames; ++frame )
-	{
-		_ab[frame][_chnl] = getSample<W>( m_phase ) * m_volume;
-		m_phase += osc_coeff;
-	}
+	renderBlocks<W>(_ab, _frames, _chnl,
+		[&](sample_t) { const float phase = m_phase; m_phase += osc_coeff; return phase; },
+		[volume](sample_t, sample_t sample) { return sample * volume; });
 }
 
 
@@ -598,14 +673,11 @@ void Oscillator::updatePM( SampleFrame* _ab, const fpp_t _frames,
 	m_subOsc->update( _ab, _frames, _chnl, true );
 	recalcPhase();
 	const float osc_coeff = m_freq * m_detuning_div_samplerate;
+	const float volume = m_volume;
 
-	for( fpp_t frame = 0; frame < _frames; ++frame )
-	{
-		_ab[frame][_chnl] = getSample<W>( m_phase +
-					_ab[frame][_chnl] )
-							* m_volume;
-		m_phase += osc_coeff;
-	}
+	renderBlocks<W>(_ab, _frames, _chnl,
+		[&](sample_t sub) { const float phase = m_phase + sub; m_phase += osc_coeff; return phase; },
+		[volume](sample_t, sample_t sample) { return sample * volume; });
 }
 
 
@@ -619,12 +691,11 @@ void Oscillator::updateAM( SampleFrame* _ab, const fpp_t _frames,
 	m_subOsc->update( _ab, _frames, _chnl, false );
 	recalcPhase();
 	const float osc_coeff = m_freq * m_detuning_div_samplerate;
+	const float volume = m_volume;
 
-	for( fpp_t frame = 0; frame < _frames; ++frame )
-	{
-		_ab[frame][_chnl] *= getSample<W>( m_phase ) * m_volume;
-		m_phase += osc_coeff;
-	}
+	renderBlocks<W>(_ab, _frames, _chnl,
+		[&](sample_t) { const float phase = m_phase; m_phase += osc_coeff; return phase; },
+		[volume](sample_t sub, sample_t sample) { return sub * (sample * volume); });
 }
 
 
@@ -638,12 +709,11 @@ void Oscillator::updateMix( SampleFrame* _ab, const fpp_t _frames,
 	m_subOsc->update( _ab, _frames, _chnl, false );
 	recalcPhase();
 	const float osc_coeff = m_freq * m_detuning_div_samplerate;
+	const float volume = m_volume;
 
-	for( fpp_t frame = 0; frame < _frames; ++frame )
-	{
-		_ab[frame][_chnl] += getSample<W>( m_phase ) * m_volume;
-		m_phase += osc_coeff;
-	}
+	renderBlocks<W>(_ab, _frames, _chnl,
+		[&](sample_t) { const float phase = m_phase; m_phase += osc_coeff; return phase; },
+		[volume](sample_t sub, sample_t sample) { return sub + sample * volume; });
 }
 
 
@@ -658,16 +728,20 @@ void Oscillator::updateSync( SampleFrame* _ab, const fpp_t _frames,
 	const float sub_osc_coeff = m_subOsc->syncInit( _ab, _frames, _chnl );
 	recalcPhase();
 	const float osc_coeff = m_freq * m_detuning_div_samplerate;
+	const float volume = m_volume;
 
-	for( fpp_t frame = 0; frame < _frames ; ++frame )
-	{
-		if( m_subOsc->syncOk( sub_osc_coeff ) )
+	renderBlocks<W>(_ab, _frames, _chnl,
+		[&](sample_t)
 		{
-			m_phase = m_phaseOffset;
-		}
-		_ab[frame][_chnl] = getSample<W>( m_phase ) * m_volume;
-		m_phase += osc_coeff;
-	}
+			if (m_subOsc->syncOk(sub_osc_coeff))
+			{
+				m_phase = m_phaseOffset;
+			}
+			const float phase = m_phase;
+			m_phase += osc_coeff;
+			return phase;
+		},
+		[volume](sample_t, sample_t sample) { return sample * volume; });
 }
 
 
@@ -682,142 +756,89 @@ void Oscillator::updateFM( SampleFrame* _ab, const fpp_t _frames,
 	recalcPhase();
 	const float osc_coeff = m_freq * m_detuning_div_samplerate;
 	const float sampleRateCorrection = 44100.0f / Engine::audioEngine()->outputSampleRate();
+	const float volume = m_volume;
 
-	for( fpp_t frame = 0; frame < _frames; ++frame )
-	{
-		m_phase += _ab[frame][_chnl] * sampleRateCorrection;
-		_ab[frame][_chnl] = getSample<W>( m_phase ) * m_volume;
-		m_phase += osc_coeff;
-	}
-}
-
-
-
-
-template<>
-inline sample_t Oscillator::getSample<Oscillator::WaveShape::Sine>(const float sample)
-{
-	const float current_freq = m_freq * m_detuning_div_samplerate * Engine::audioEngine()->outputSampleRate();
-
-	if (!m_useWaveTable || current_freq < OscillatorConstants::MAX_FREQ)
-	{
-		return sinSample(sample);
-	}
-	else
-	{
-		return 0;
-	}
-}
-
-
-
-
-template<>
-inline sample_t Oscillator::getSample<Oscillator::WaveShape::Triangle>(
-		const float _sample )
-{
-	if (m_useWaveTable && !m_isModulator)
-	{
-		return wtSample(s_waveTables[static_cast<std::size_t>(WaveShape::Triangle) - FirstWaveShapeTable],_sample);
-	}
-	else
-	{
-		return triangleSample(_sample);
-	}
+	renderBlocks<W>(_ab, _frames, _chnl,
+		[&](sample_t sub)
+		{
+			m_phase += sub * sampleRateCorrection;
+			const float phase = m_phase;
+			m_phase += osc_coeff;
+			return phase;
+		},
+		[volume](sample_t, sample_t sample) { return sample * volume; });
 }
 
 
 
 
-template<>
-inline sample_t Oscillator::getSample<Oscillator::WaveShape::Saw>(
-		const float _sample )
+void Oscillator::wtSamples(const sample_t* bandTable, const float* phases,
+	sample_t* samples, const fpp_t count)
 {
-	if (m_useWaveTable && !m_isModulator)
+	for (fpp_t i = 0; i < count; ++i)
 	{
-		return wtSample(s_waveTables[static_cast<std::size_t>(WaveShape::Saw) - FirstWaveShapeTable], _sample);
-	}
-	else
-	{
-		return sawSample(_sample);
+		const float frame = absFraction(phases[i]) * OscillatorConstants::WAVETABLE_LENGTH;
+		const auto f1 = static_cast<f_cnt_t>(frame);
+		const auto f2 = f1 < OscillatorConstants::WAVETABLE_LENGTH - 1 ? f1 + 1 : 0;
+		samples[i] = linearInterpolate(bandTable[f1], bandTable[f2], fraction(frame));
 	}
 }
 
 
 
 
-template<>
-inline sample_t Oscillator::getSample<Oscillator::WaveShape::Square>(
-		const float _sample )
+// The wave shape and whether to use a wave table are decided once per block,
+// so each loop below does the same work for every frame
+template<Oscillator::WaveShape W>
+void Oscillator::getSamples(const float* phases, sample_t* samples, const fpp_t count)
 {
-	if (m_useWaveTable && !m_isModulator)
-	{
-		return wtSample(s_waveTables[static_cast<std::size_t>(WaveShape::Square) - FirstWaveShapeTable], _sample);
-	}
-	else
-	{
-		return squareSample(_sample);
-	}
-}
-
-
+	const float currentFreq = m_freq * m_detuning_div_samplerate * Engine::audioEngine()->outputSampleRate();
 
-
-template<>
-inline sample_t Oscillator::getSample<Oscillator::WaveShape::MoogSaw>(
-							const float _sample )
-{
-	if (m_useWaveTable && !m_isModulator)
+	if constexpr (W == WaveShape::Sine)
 	{
-		return wtSample(s_waveTables[static_cast<std::size_t>(WaveShape::MoogSaw) - FirstWaveShapeTable], _sample);
-	}
-	else
-	{
-		return moogSawSample(_sample);
+		if (!m_useWaveTable || currentFreq < OscillatorConstants::MAX_FREQ)
+		{
+			std::transform(phases, phases + count, samples, sinSample);
+		}
+		else
+		{
+			std::fill_n(samples, count, 0.f);
+		}
 	}
-}
-
-
-
-
-template<>
-inline sample_t Oscillator::getSample<Oscillator::WaveShape::Exponential>(
-							const float _sample )
-{
-	if (m_useWaveTable && !m_isModulator)
+	else if constexpr (W == WaveShape::WhiteNoise)
 	{
-		return wtSample(s_waveTables[static_cast<std::size_t>(WaveShape::Exponential) - FirstWaveShapeTable], _sample);
+		std::transform(phases, phases + count, samples, noiseSample);
 	}
-	else
+	else if constexpr (W == WaveShape::UserDefined)
 	{
-		return expSample(_sample);
+		if (m_useWaveTable && m_userAntiAliasWaveTable && !m_isModulator)
+		{
+			const int band = waveTableBandFromFreq(currentFreq);
+			wtSamples((*m_userAntiAliasWaveTable)[band].data(), phases, samples, count);
+		}
+		else
+		{
+			const SampleBuffer* userWave = m_userWave.get();
+			std::transform(phases, phases + count, samples,
+				[userWave](float phase) { return userWaveSample(userWave, phase); });
+		}
 	}
-}
-
-
-
-
-template<>
-inline sample_t Oscillator::getSample<Oscillator::WaveShape::WhiteNoise>(
-							const float _sample )
-{
-	return( noiseSample( _sample ) );
-}
-
-
-
-
-template<>
-inline sample_t Oscillator::getSample<Oscillator::WaveShape::UserDefined>(
-							const float _sample )
-{
-	if (m_useWaveTable && m_userAntiAliasWaveTable && !m_isModulator)
+	else if (m_useWaveTable && !m_isModulator)
 	{
-		return wtSample(m_userAntiAliasWaveTable.get(), _sample);
+		const int band = waveTableBandFromFreq(currentFreq);
+		wtSamples(waveTable(W)[band].data(), phases, samples, count);
 	}
 	else
 	{
-		return userWaveSample(m_userWave.get(), _sample);
+		constexpr auto waveSample = []
+		{
+			if constexpr (W == WaveShape::Triangle) { return triangleSample; }
+			else if constexpr (W == WaveShape::Saw) { return sawSample; }
+			else if constexpr (W == WaveShape::Square) { return squareSample; }
+			else if constexpr (W == WaveShape::MoogSaw) { return moogSawSample; }
+			else { return expSample; }
+		}();
+		std::transform(phases, phases + count, samples, waveSample);
 	}
 }
 
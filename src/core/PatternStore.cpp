@@ -25,6 +25,8 @@
 
 #include "PatternStore.h"
 
+#include <algorithm>
+
 #include "Clip.h"
 #include "Engine.h"
 #include "PatternTrack.h"
@@ -237,19 +239,29 @@ void PatternStore::createClipsForPattern(int pattern)
 	}
 }
 
-AutomatedValueMap PatternStore::automatedValuesAt(TimePos time, int clipNum) const
+AutomationSourceMap PatternStore::automationSourcesAt(TimePos time, int clipNum) const
 {
 	Q_ASSERT(clipNum >= 0);
 	Q_ASSERT(time.getTicks() >= 0);
 
 	auto lengthBars = lengthOfPattern(clipNum);
 	auto lengthTicks = lengthBars * TimePos::ticksPerBar();
-	if (time > lengthTicks)
+	const bool clamped = time > lengthTicks;
+	if (clamped)
 	{
 		time = lengthTicks;
 	}
 
-	return TrackContainer::automatedValuesAt(time + (TimePos::ticksPerBar() * clipNum), clipNum);
+	auto sources = TrackContainer::automationSourcesAt(time + (TimePos::ticksPerBar() * clipNum), clipNum);
+	if (clamped)
+	{
+		// the pattern has ended, so its automation stays where it is
+		for (auto& source : sources)
+		{
+			source.end = std::min<int>(source.end, source.time);
+		}
+	}
+	return sources;
 }
 
 
@@ -90,7 +90,7 @@ void PeakController::updateValueBuffer()
 		if( m_currentSample != targetSample )
 		{
 			const f_cnt_t frames = Engine::audioEngine()->framesPerPeriod();
-			float * values = m_valueBuffer.values();
+			float * values = m_valueBuffer->values();
 
 			for( f_cnt_t f = 0; f < frames; ++f )
 			{
@@ -101,12 +101,12 @@ void PeakController::updateValueBuffer()
 		}
 		else
 		{
-			m_valueBuffer.fill( m_currentSample );
+			m_valueBuffer->fill( m_currentSample );
 		}
 	}
 	else
 	{
-		m_valueBuffer.fill( 0 );
+		m_valueBuffer->fill( 0 );
 	}
 	m_bufferLastUpdated = s_periods;
 }
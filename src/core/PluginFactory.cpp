@@ -25,14 +25,19 @@
 #include "PluginFactory.h"
 
 #include <QCoreApplication>
+#include <QDataStream>
+#include <QDateTime>
 #include <QDebug>
 #include <QDir>
 #include <QLibrary>
 #include <memory>
+#include <mutex>
 #include "lmmsconfig.h"
 
+#include "CacheFile.h"
 #include "ConfigManager.h"
 #include "Plugin.h"
+#include "embed.h"
 
 // QT qHash specialization, needs to be in global namespace
 qint64 qHash(const QFileInfo& fi)
@@ -50,6 +55,136 @@ namespace lmms
 	QStringList nameFilters("lib*.so");
 #endif
 
+namespace
+{
+
+const auto ManifestFile = QStringLiteral("plugin-manifest.dat");
+//! Bump this whenever ManifestEntry changes
+constexpr quint32 ManifestVersion = 1;
+
+QByteArray fromCString(const char* str)
+{
+	return str ? QByteArray{str} : QByteArray{};
+}
+
+const char* toCString(const QByteArray& str)
+{
+	return str.isNull() ? nullptr : str.constData();
+}
+
+//! What the manifest records about a library, so it can be registered without loading it
+struct ManifestEntry
+{
+	qint64 size = 0;
+	qint64 lastModified = 0;
+	//! False for libraries other plugins depend on, like the ZynAddSubFX core
+	bool isPlugin = false;
+
+	// The Plugin::Descriptor fields, null where the descriptor has a nullptr
+	QByteArray name;
+	QByteArray displayName;
+	QByteArray description;
+	QByteArray author;
+	qint32 version = 0;
+	qint32 type = 0;
+	QByteArray logo;
+	QByteArray supportedFileTypes;
+
+	static ManifestEntry fromFile(const QFileInfo& file)
+	{
+		auto entry = ManifestEntry{};
+		entry.size = file.size();
+		entry.lastModified = file.lastModified().toMSecsSinceEpoch();
+		return entry;
+	}
+
+	static ManifestEntry fromDescriptor(const QFileInfo& file, const Plugin::Descriptor& desc)
+	{
+		auto entry = fromFile(file);
+		entry.isPlugin = true;
+		entry.name = fromCString(desc.name);
+		entry.displayName = fromCString(desc.displayName);
+		entry.description = fromCString(desc.description);
+		entry.author = fromCString(desc.author);
+		entry.version = desc.version;
+		entry.type = static_cast<qint32>(desc.type);
+		if (desc.logo) { entry.logo = QByteArray::fromStdString(desc.logo->pixmapName()); }
+		entry.supportedFileTypes = fromCString(desc.supportedFileTypes);
+		return entry;
+	}
+
+	bool matches(const QFileInfo& file) const
+	{
+		return size == file.size() && lastModified == file.lastModified().toMSecsSinceEpoch();
+	}
+
+	bool operator==(const ManifestEntry&) const = default;
+};
+
+using Manifest = QHash<QString, ManifestEntry>;
+
+QDataStream& operator<<(QDataStream& out, const ManifestEntry& entry)
+{
+	return out << entry.size << entry.lastModified << entry.isPlugin
+		<< entry.name << entry.displayName << entry.description << entry.author
+		<< entry.version << entry.type << entry.logo << entry.supportedFileTypes;
+}
+
+QDataStream& operator>>(QDataStream& in, ManifestEntry& entry)
+{
+	return in >> entry.size >> entry.lastModified >> entry.isPlugin
+		>> entry.name >> entry.displayName >> entry.description >> entry.author
+		>> entry.version >> entry.type >> entry.logo >> entry.supportedFileTypes;
+}
+
+Manifest readManifest()
+{
+	auto manifest = Manifest{};
+	if (!CacheFile::read(ManifestFile, ManifestVersion, [&](QDataStream& in) { in >> manifest; }))
+	{
+		return {};
+	}
+	return manifest;
+}
+
+//! Loads the plugin library before its logo, since the artwork is embedded in the library
+class LazyPluginLogo : public PixmapLoader
+{
+public:
+	LazyPluginLogo(std::string name, std::shared_ptr<QLibrary> library) :
+		PixmapLoader{std::move(name)},
+		m_library{std::move(library)}
+	{ }
+
+	auto pixmap(int width = -1, int height = -1) const -> QPixmap override
+	{
+		m_library->load();
+		return PixmapLoader::pixmap(width, height);
+	}
+
+private:
+	std::shared_ptr<QLibrary> m_library;
+};
+
+} // namespace
+
+
+struct PluginFactory::CachedPlugin
+{
+	CachedPlugin(const ManifestEntry& manifestEntry, std::shared_ptr<QLibrary> library) :
+		entry{manifestEntry},
+		logo{entry.logo.isNull() ? nullptr : std::make_unique<LazyPluginLogo>(entry.logo.toStdString(), std::move(library))},
+		descriptor{toCString(entry.name), toCString(entry.displayName), toCString(entry.description),
+			toCString(entry.author), entry.version, static_cast<Plugin::Type>(entry.type), logo.get(),
+			toCString(entry.supportedFileTypes), nullptr}
+	{ }
+
+	const ManifestEntry entry; //!< owns the strings of the descriptor
+	const std::unique_ptr<LazyPluginLogo> logo;
+	Plugin::Descriptor descriptor;
+};
+
+
 std::unique_ptr<PluginFactory> PluginFactory::s_instance;
 
 PluginFactory::PluginFactory()
@@ -58,6 +193,8 @@ PluginFactory::PluginFactory()
 	discoverPlugins();
 }
 
+PluginFactory::~PluginFactory() = default;
+
 void PluginFactory::setupSearchPaths()
 {
 	// Adds a search path relative to the main executable if the path exists.
@@ -93,8 +230,9 @@ void PluginFactory::setupSearchPaths()
 
 PluginFactory* PluginFactory::instance()
 {
-	if (s_instance == nullptr)
-		s_instance = std::make_unique<PluginFactory>();
+	// The engine discovers the plugins on a worker thread during start-up
+	static std::once_flag once;
+	std::call_once(once, [] { s_instance = std::make_unique<PluginFactory>(); });
 
 	return s_instance.get();
 }
@@ -157,14 +295,90 @@ void PluginFactory::discoverPlugins()
 #endif
 	}
 
+	auto addPlugin = [&](const PluginInfo& info)
+	{
+		pluginInfos << info;
+
+		auto addSupportedFileTypes =
+			[this](QString supportedFileTypes,
+				const PluginInfo& info,
+				const Plugin::Descriptor::SubPluginFeatures::Key* key = nullptr)
+		{
+			if(!supportedFileTypes.isNull())
+			{
+				for (const QString& ext : supportedFileTypes.split(','))
+				{
+					//qDebug() << "Plugin " << info.name()
+					//	<< "supports" << ext;
+					PluginInfoAndKey infoAndKey;
+					infoAndKey.info = info;
+					infoAndKey.key = key
+						? *key
+						: Plugin::Descriptor::SubPluginFeatures::Key();
+					m_pluginByExt.insert(ext, infoAndKey);
+				}
+			}
+		};
+
+		if (info.descriptor->supportedFileTypes)
+			addSupportedFileTypes(QString(info.descriptor->supportedFileTypes), info);
+
+		if (info.descriptor->subPluginFeatures)
+		{
+			Plugin::Descriptor::SubPluginFeatures::KeyList
+				subPluginKeys;
+			info.descriptor->subPluginFeatures->listSubPluginKeys(
+				info.descriptor,
+				subPluginKeys);
+			for(const Plugin::Descriptor::SubPluginFeatures::Key& key
+				: subPluginKeys)
+			{
+				addSupportedFileTypes(key.additionalFileExtensions(), info, &key);
+			}
+		}
+
+		descriptors.insert(info.descriptor->type, info.descriptor);
+	};
+
+	// Libraries that did not change since they were recorded in the manifest
+	// are registered without loading them
+	const Manifest manifest = readManifest();
+	Manifest updatedManifest;
+	QList<QFileInfo> changedFiles;
+	for (const QFileInfo& file : files)
+	{
+		const auto entry = manifest.find(file.absoluteFilePath());
+		if (entry == manifest.end() || !entry->matches(file))
+		{
+			changedFiles << file;
+			continue;
+		}
+		updatedManifest.insert(entry.key(), *entry);
+
+		auto library = std::make_shared<QLibrary>(file.absoluteFilePath());
+		if (!entry->isPlugin)
+		{
+			// The plugins depending on it are loaded lazily, without the retry below
+			library->load();
+			continue;
+		}
+
+		const auto& cached = m_cachedPlugins.emplace_back(std::make_unique<CachedPlugin>(*entry, library));
+		PluginInfo info;
+		info.file = file;
+		info.library = library;
+		info.descriptor = &cached->descriptor;
+		addPlugin(info);
+	}
+
 	// Cheap dependency handling: zynaddsubfx needs ZynAddSubFxCore. By loading
 	// all libraries twice we ensure that libZynAddSubFxCore is found.
-	for (const QFileInfo& file : files)
+	for (const QFileInfo& file : changedFiles)
 	{
 		QLibrary(file.absoluteFilePath()).load();
 	}
 
-	for (const QFileInfo& file : files)
+	for (const QFileInfo& file : changedFiles)
 	{
 		auto library = std::make_shared<QLibrary>(file.absoluteFilePath());
 		if (! library->load()) {
@@ -173,74 +387,44 @@ void PluginFactory::discoverPlugins()
 			continue;
 		}
 
-		Plugin::Descriptor* pluginDescriptor = nullptr;
-		if (library->resolve("lmms_plugin_main"))
+		if (!library->resolve("lmms_plugin_main"))
 		{
-			QString descriptorName = file.baseName() + "_plugin_descriptor";
-			if( descriptorName.left(3) == "lib" )
-			{
-				descriptorName = descriptorName.mid(3);
-			}
-
-			pluginDescriptor = reinterpret_cast<Plugin::Descriptor*>(library->resolve(descriptorName.toUtf8().constData()));
-			if(pluginDescriptor == nullptr)
-			{
-				qWarning() << qApp->translate("PluginFactory", "LMMS plugin %1 does not have a plugin descriptor named %2!").
-							  arg(file.absoluteFilePath()).arg(descriptorName);
-				continue;
-			}
+			updatedManifest.insert(file.absoluteFilePath(), ManifestEntry::fromFile(file));
+			continue;
 		}
 
-		if(pluginDescriptor)
+		QString descriptorName = file.baseName() + "_plugin_descriptor";
+		if( descriptorName.left(3) == "lib" )
 		{
-			PluginInfo info;
-			info.file = file;
-			info.library = library;
-			info.descriptor = pluginDescriptor;
-			pluginInfos << info;
-
-			auto addSupportedFileTypes =
-				[this](QString supportedFileTypes,
-					const PluginInfo& info,
-					const Plugin::Descriptor::SubPluginFeatures::Key* key = nullptr)
-			{
-				if(!supportedFileTypes.isNull())
-				{
-					for (const QString& ext : supportedFileTypes.split(','))
-					{
-						//qDebug() << "Plugin " << info.name()
-						//	<< "supports" << ext;
-						PluginInfoAndKey infoAndKey;
-						infoAndKey.info = info;
-						infoAndKey.key = key
-							? *key
-							: Plugin::Descriptor::SubPluginFeatures::Key();
-						m_pluginByExt.insert(ext, infoAndKey);
-					}
-				}
-			};
+			descriptorName = descriptorName.mid(3);
+		}
 
-			if (info.descriptor->supportedFileTypes)
-				addSupportedFileTypes(QString(info.descriptor->supportedFileTypes), info);
+		auto pluginDescriptor = reinterpret_cast<Plugin::Descriptor*>(library->resolve(descriptorName.toUtf8().constData()));
+		if(pluginDescriptor == nullptr)
+		{
+			qWarning() << qApp->translate("PluginFactory", "LMMS plugin %1 does not have a plugin descriptor named %2!").
+						  arg(file.absoluteFilePath()).arg(descriptorName);
+			continue;
+		}
 
-			if (info.descriptor->subPluginFeatures)
-			{
-				Plugin::Descriptor::SubPluginFeatures::KeyList
-					subPluginKeys;
-				info.descriptor->subPluginFeatures->listSubPluginKeys(
-					info.descriptor,
-					subPluginKeys);
-				for(const Plugin::Descriptor::SubPluginFeatures::Key& key
-					: subPluginKeys)
-				{
-					addSupportedFileTypes(key.additionalFileExtensions(), info, &key);
-				}
-			}
+		PluginInfo info;
+		info.file = file;
+		info.library = library;
+		info.descriptor = pluginDescriptor;
+		addPlugin(info);
 
-			descriptors.insert(info.descriptor->type, info.descriptor);
+		// The sub-plugins are listed by the loaded library, so these are always loaded
+		if (!pluginDescriptor->subPluginFeatures)
+		{
+			updatedManifest.insert(file.absoluteFilePath(), ManifestEntry::fromDescriptor(file, *pluginDescriptor));
 		}
 	}
 
+	if (updatedManifest != manifest)
+	{
+		CacheFile::write(ManifestFile, ManifestVersion, [&](QDataStream& out) { out << updatedManifest; });
+	}
+
 	m_pluginInfos = pluginInfos;
 	m_descriptors = descriptors;
 }
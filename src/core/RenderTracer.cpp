@@ -0,0 +1,321 @@
+/*
+ * RenderTracer.cpp - timeline of the render loop in Chrome trace format
+ *
+ * This file is part of LMMS - https://lmms.io
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this program (see COPYING); if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301 USA.
+ *
+ */
+
+#include "RenderTracer.h"
+
+#include <array>
+#include <bit>
+#include <cstdint>
+#include <cstdlib>
+#include <memory>
+#include <thread>
+#include <unordered_map>
+
+#include <QFile>
+
+#ifdef __GNUG__
+#include <cxxabi.h>
+#endif
+
+namespace lmms
+{
+
+namespace
+{
+
+using namespace std::chrono_literals;
+using Clock = RenderTracer::Clock;
+
+constexpr std::uint32_t MaxThreads = 256;
+constexpr auto WritePeriod = 20ms;
+
+std::atomic<std::uint32_t> s_threadCount = 0;
+std::array<std::atomic<const char*>, MaxThreads> s_threadNames{};
+thread_local std::uint32_t t_threadId = MaxThreads;
+
+
+std::uint32_t threadId()
+{
+	if (t_threadId == MaxThreads)
+	{
+		// threads beyond the limit share the last id
+		t_threadId = std::min(s_threadCount.fetch_add(1, std::memory_order_relaxed), MaxThreads - 1);
+	}
+	return t_threadId;
+}
+
+
+QByteArray typeName(const std::type_info& type)
+{
+	QByteArray name = type.name();
+#ifdef __GNUG__
+	int status = 0;
+	if (char* demangled = abi::__cxa_demangle(type.name(), nullptr, nullptr, &status))
+	{
+		name = demangled;
+		std::free(demangled);
+	}
+#endif
+	return name.replace("class ", "").replace("lmms::", "");
+}
+
+
+
+
+struct Event
+{
+	std::atomic<std::uint64_t> sequence;
+	const char* name;
+	const char* category;
+	const std::type_info* type;
+	Clock::time_point begin;
+	Clock::time_point end;
+	std::uint32_t thread;
+};
+
+
+/*
+	A bounded multi-producer, single-consumer ring. The sequence number of
+	each slot tells whose turn it is: a producer may fill slot i when its
+	sequence equals the write position, the consumer may read it when it is
+	one ahead of that.
+*/
+class TraceSession
+{
+public:
+	TraceSession(std::size_t capacity) :
+		m_mask(std::bit_ceil(capacity) - 1),
+		m_events(std::make_unique<Event[]>(m_mask + 1)),
+		m_writePos(0),
+		m_readPos(0),
+		m_dropped(0),
+		m_epoch(Clock::now()),
+		m_firstEvent(true),
+		m_stop(false)
+	{
+		for (std::size_t i = 0; i <= m_mask; ++i)
+		{
+			m_events[i].sequence.store(i, std::memory_order_relaxed);
+		}
+	}
+
+	bool open(const QString& fileName)
+	{
+		m_file.setFileName(fileName);
+		if (!m_file.open(QFile::WriteOnly | QFile::Truncate)) { return false; }
+		m_file.write("{\"traceEvents\":[\n");
+		m_writer = std::thread([this] { writeLoop(); });
+		return true;
+	}
+
+	void push(const char* name, const char* category, const std::type_info* type,
+		Clock::time_point begin, Clock::time_point end)
+	{
+		auto pos = m_writePos.load(std::memory_order_relaxed);
+		Event* event;
+		while (true)
+		{
+			event = &m_events[pos & m_mask];
+			const auto sequence = event->sequence.load(std::memory_order_acquire);
+			if (sequence == pos)
+			{
+				if (m_writePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) { break; }
+			}
+			else if (sequence < pos)
+			{
+				// the writer thread didn't catch up
+				m_dropped.fetch_add(1, std::memory_order_relaxed);
+				return;
+			}
+			else
+			{
+				pos = m_writePos.load(std::memory_order_relaxed);
+			}
+		}
+
+		event->name = name;
+		event->category = category;
+		event->type = type;
+		event->begin = begin;
+		event->end = end;
+		event->thread = threadId();
+		event->sequence.store(pos + 1, std::memory_order_release);
+	}
+
+	void finish()
+	{
+		m_stop.store(true, std::memory_order_release);
+		m_writer.join();
+
+		for (std::uint32_t thread = 0; thread < std::min(s_threadCount.load(), MaxThreads); ++thread)
+		{
+			if (const char* name = s_threadNames[thread].load(std::memory_order_relaxed))
+			{
+				writeSeparator();
+				m_file.write("{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":"
+					+ QByteArray::number(thread) + ",\"args\":{\"name\":\"" + name + "\"}}");
+			}
+		}
+		m_file.write("\n],\"displayTimeUnit\":\"ms\",\"otherData\":{\"droppedEvents\":"
+			+ QByteArray::number(static_cast<qulonglong>(m_dropped.load())) + "}}\n");
+		m_file.close();
+	}
+
+private:
+	void writeLoop()
+	{
+		while (!m_stop.load(std::memory_order_acquire))
+		{
+			drain();
+			std::this_thread::sleep_for(WritePeriod);
+		}
+		drain();
+	}
+
+	void drain()
+	{
+		while (true)
+		{
+			Event& event = m_events[m_readPos & m_mask];
+			if (event.sequence.load(std::memory_order_acquire) != m_readPos + 1) { break; }
+
+			write(event);
+			event.sequence.store(m_readPos + m_mask + 1, std::memory_order_release);
+			++m_readPos;
+		}
+		m_file.flush();
+	}
+
+	void write(const Event& event)
+	{
+		const auto micros = [this](Clock::time_point time) {
+			return QByteArray::number(std::chrono::duration<double, std::micro>(time - m_epoch).count(), 'f', 3);
+		};
+
+		QByteArray name;
+		if (event.type)
+		{
+			auto it = m_typeNames.find(event.type);
+			if (it == m_typeNames.end()) { it = m_typeNames.emplace(event.type, typeName(*event.type)).first; }
+			name = it->second;
+		}
+		else
+		{
+			name = event.name;
+		}
+
+		writeSeparator();
+		m_file.write("{\"name\":\"" + name + "\",\"cat\":\"" + event.category
+			+ "\",\"ph\":\"X\",\"ts\":" + micros(event.begin)
+			+ ",\"dur\":" + QByteArray::number(std::chrono::duration<double, std::micro>(event.end - event.begin).count(), 'f', 3)
+			+ ",\"pid\":1,\"tid\":" + QByteArray::number(event.thread) + "}");
+	}
+
+	void writeSeparator()
+	{
+		if (!m_firstEvent) { m_file.write(",\n"); }
+		m_firstEvent = false;
+	}
+
+	const std::size_t m_mask;
+	std::unique_ptr<Event[]> m_events;
+	alignas(64) std::atomic<std::uint64_t> m_writePos;
+	alignas(64) std::uint64_t m_readPos;
+	std::atomic<std::uint64_t> m_dropped;
+
+	const Clock::time_point m_epoch;
+	QFile m_file;
+	bool m_firstEvent;
+	std::unordered_map<const std::type_info*, QByteArray> m_typeNames;
+	std::thread m_writer;
+	std::atomic<bool> m_stop;
+} ;
+
+
+std::unique_ptr<TraceSession> s_session;
+
+} // namespace
+
+
+std::atomic<bool> RenderTracer::s_active = false;
+
+
+
+
+bool RenderTracer::start(const QString& fileName, std::size_t capacity)
+{
+	if (s_session) { return false; }
+
+	auto session = std::make_unique<TraceSession>(capacity);
+	if (!session->open(fileName)) { return false; }
+
+	s_session = std::move(session);
+	s_active.store(true, std::memory_order_release);
+	return true;
+}
+
+
+
+
+void RenderTracer::stop()
+{
+	if (!s_session) { return; }
+
+	s_active.store(false, std::memory_order_relaxed);
+	s_session->finish();
+	s_session.reset();
+}
+
+
+
+
+void RenderTracer::setThreadName(const char* name)
+{
+	s_threadNames[threadId()].store(name, std::memory_order_relaxed);
+}
+
+
+
+
+void RenderTracer::record(const char* name, const char* category,
+	Clock::time_point begin, Clock::time_point end)
+{
+	if (s_active.load(std::memory_order_acquire))
+	{
+		s_session->push(name, category, nullptr, begin, end);
+	}
+}
+
+
+
+
+void RenderTracer::recordJob(const std::type_info& type,
+	Clock::time_point begin, Clock::time_point end)
+{
+	if (s_active.load(std::memory_order_acquire))
+	{
+		s_session->push(nullptr, "job", &type, begin, end);
+	}
+}
+
+
+} // namespace lmms
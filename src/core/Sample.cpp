@@ -26,6 +26,7 @@
 
 #include "lmms_math.h"
 
+#include <algorithm>
 #include <cassert>
 
 namespace lmms {
@@ -132,18 +133,30 @@ bool Sample::play(SampleFrame* dst, PlaybackState* state, size_t numFrames, floa
 	const auto marginSize = s_interpolationMargins[state->resampler().interpolationMode()];
 
 	state->m_frameIndex = std::max<int>(m_startFrame, state->m_frameIndex);
+	readAhead(state);
 
-	auto playBuffer = std::vector<SampleFrame>(numFrames / resampleRatio + marginSize);
-	playRaw(playBuffer.data(), playBuffer.size(), state, loopMode);
+	if (resampleRatio == 1.0f && !state->m_varyingPitch && !state->m_resampling)
+	{
+		copyRaw(dst, numFrames, state, loopMode);
+	}
+	else
+	{
+		state->m_resampling = true;
+
+		const auto playFrames = static_cast<std::size_t>(numFrames / resampleRatio) + marginSize;
+		auto& playBuffer = state->m_playBuffer;
+		if (playBuffer.size() < playFrames) { playBuffer.resize(playFrames); }
+		playRaw(playBuffer.data(), playFrames, state, loopMode);
 
-	state->resampler().setRatio(resampleRatio);
+		state->resampler().setRatio(resampleRatio);
 
-	const auto resampleResult
-		= state->resampler().resample(&playBuffer[0][0], playBuffer.size(), &dst[0][0], numFrames, resampleRatio);
-	advance(state, resampleResult.inputFramesUsed, loopMode);
+		const auto resampleResult
+			= state->resampler().resample(&playBuffer[0][0], playFrames, &dst[0][0], numFrames, resampleRatio);
+		advance(state, resampleResult.inputFramesUsed, loopMode);
 
-	const auto outputFrames = static_cast<f_cnt_t>(resampleResult.outputFramesGenerated);
-	if (outputFrames < numFrames) { std::fill_n(dst + outputFrames, numFrames - outputFrames, SampleFrame{}); }
+		const auto outputFrames = static_cast<f_cnt_t>(resampleResult.outputFramesGenerated);
+		if (outputFrames < numFrames) { std::fill_n(dst + outputFrames, numFrames - outputFrames, SampleFrame{}); }
+	}
 
 	if (!approximatelyEqual(m_amplification, 1.0f))
 	{
@@ -174,7 +187,11 @@ void Sample::setAllPointFrames(int startFrame, int endFrame, int loopStartFrame,
 
 void Sample::playRaw(SampleFrame* dst, size_t numFrames, const PlaybackState* state, Loop loopMode) const
 {
-	if (m_buffer->size() < 1) { return; }
+	if (m_buffer->size() < 1)
+	{
+		std::fill_n(dst, numFrames, SampleFrame{});
+		return;
+	}
 
 	auto index = state->m_frameIndex;
 	auto backwards = state->m_backwards;
@@ -184,7 +201,11 @@ void Sample::playRaw(SampleFrame* dst, size_t numFrames, const PlaybackState* st
 		switch (loopMode)
 		{
 		case Loop::Off:
-			if (index < 0 || index >= m_endFrame) { return; }
+			if (index < 0 || index >= m_endFrame)
+			{
+				std::fill(dst + i, dst + numFrames, SampleFrame{});
+				return;
+			}
 			break;
 		case Loop::On:
 			if (index < m_loopStartFrame && backwards) { index = m_loopEndFrame - 1; }
@@ -211,6 +232,123 @@ void Sample::playRaw(SampleFrame* dst, size_t numFrames, const PlaybackState* st
 	}
 }
 
+void Sample::copyRaw(SampleFrame* dst, size_t numFrames, PlaybackState* state, Loop loopMode) const
+{
+	const auto data = m_buffer->data();
+	const auto size = static_cast<int>(m_buffer->size());
+	const auto reversed = m_reversed.load(std::memory_order_relaxed);
+	const auto endFrame = m_endFrame.load(std::memory_order_relaxed);
+	const auto loopStartFrame = m_loopStartFrame.load(std::memory_order_relaxed);
+	const auto loopEndFrame = m_loopEndFrame.load(std::memory_order_relaxed);
+
+	auto index = state->m_frameIndex;
+	auto backwards = state->m_backwards;
+	auto written = std::size_t{0};
+
+	// A loop without frames has no runs. playRaw() keeps wrapping at the loop point,
+	// and advance() doesn't wrap, so this does the same frame by frame
+	if (loopMode != Loop::Off && loopStartFrame == loopEndFrame)
+	{
+		for (auto i = std::size_t{0}; i < numFrames; ++i)
+		{
+			if (index < loopStartFrame && backwards)
+			{
+				index = loopMode == Loop::On ? loopEndFrame - 1 : loopStartFrame;
+				backwards = loopMode == Loop::On;
+			}
+			else if (index >= loopEndFrame)
+			{
+				index = loopMode == Loop::On ? loopStartFrame : loopEndFrame - 1;
+				backwards = backwards || loopMode == Loop::PingPong;
+			}
+
+			const auto position = reversed ? size - index - 1 : index;
+			dst[i] = position >= 0 && position < size ? data[position] : SampleFrame{};
+			backwards ? --index : ++index;
+		}
+		state->m_frameIndex += (state->m_backwards ? -1 : 1) * static_cast<int>(numFrames);
+		return;
+	}
+
+	// Same wrapping as in playRaw(), but applied once per contiguous run of frames
+	while (written < numFrames)
+	{
+		auto runEnd = backwards ? -1 : size;
+		switch (loopMode)
+		{
+		case Loop::Off:
+			if (index < 0 || index >= endFrame) { runEnd = index; }
+			else if (!backwards) { runEnd = endFrame; }
+			break;
+		case Loop::On:
+			if (index < loopStartFrame && backwards) { index = loopEndFrame - 1; }
+			else if (index >= loopEndFrame) { index = loopStartFrame; }
+			runEnd = backwards ? loopStartFrame - 1 : loopEndFrame;
+			break;
+		case Loop::PingPong:
+			if (index < loopStartFrame && backwards)
+			{
+				index = loopStartFrame;
+				backwards = false;
+			}
+			else if (index >= loopEndFrame)
+			{
+				index = loopEndFrame - 1;
+				backwards = true;
+			}
+			runEnd = backwards ? loopStartFrame - 1 : loopEndFrame;
+			break;
+		default:
+			break;
+		}
+
+		// never read outside of the buffer, even with inconsistent loop points
+		runEnd = std::clamp(runEnd, -1, size);
+		const auto run = std::min<std::size_t>(numFrames - written, std::max(0, backwards ? index - runEnd : runEnd - index));
+		if (run == 0 || index < 0 || index >= size) { break; }
+
+		// playing backwards through a reversed sample reads it forwards and vice versa
+		const auto first = reversed ? size - index - 1 : index;
+		if (backwards == reversed) { std::copy_n(data + first, run, dst + written); }
+		else { std::reverse_copy(data + first + 1 - run, data + first + 1, dst + written); }
+
+		written += run;
+		index += backwards ? -static_cast<int>(run) : static_cast<int>(run);
+	}
+
+	if (written < numFrames) { std::fill(dst + written, dst + numFrames, SampleFrame{}); }
+
+	// a voice that ran out of frames ends like one played through the resampler
+	state->m_frameIndex = written < numFrames && loopMode == Loop::Off ? (backwards ? -1 : endFrame) : index;
+	state->m_backwards = backwards;
+}
+
+void Sample::readAhead(PlaybackState* state) const
+{
+	const auto stream = m_buffer->stream();
+	if (stream == nullptr || stream->size() == 0) { return; }
+
+	// the window is kept in positions of the buffer, which run backwards through a reversed sample
+	const auto size = stream->size();
+	const auto index = static_cast<std::size_t>(std::clamp(state->m_frameIndex, 0, static_cast<int>(size) - 1));
+	const auto position = m_reversed ? size - 1 - index : index;
+	const auto forwards = state->m_backwards == m_reversed;
+	const auto window = static_cast<std::size_t>(stream->sampleRate()) * s_readAheadSeconds;
+
+	// the next window is requested once half of the current one was played
+	const auto begin = state->m_readAheadBegin;
+	const auto end = state->m_readAheadEnd;
+	const auto inWindow = forwards
+		? position >= begin && (position + window / 2 < end || end == size)
+		: position < end && (position >= begin + window / 2 || begin == 0);
+	if (inWindow) { return; }
+
+	const auto first = forwards ? position : position + 1 - std::min(position + 1, window);
+	stream->readAhead(first, window);
+	state->m_readAheadBegin = first;
+	state->m_readAheadEnd = std::min(first + window, size);
+}
+
 void Sample::advance(PlaybackState* state, size_t advanceAmount, Loop loopMode) const
 {
 	state->m_frameIndex += (state->m_backwards ? -1 : 1) * advanceAmount;
@@ -221,12 +359,14 @@ void Sample::advance(PlaybackState* state, size_t advanceAmount, Loop loopMode)
 	const auto loopSize = m_loopEndFrame - m_loopStartFrame;
 	if (loopSize == 0) { return; }
 
+	// Like in playRaw(), backwards playback wraps at the frame before the loop start
+	// and forwards playback at the loop end itself
 	switch (loopMode)
 	{
 	case Loop::On:
 		if (state->m_frameIndex < m_loopStartFrame && state->m_backwards)
 		{
-			state->m_frameIndex = m_loopEndFrame - 1 - distanceFromLoopStart % loopSize;
+			state->m_frameIndex = m_loopEndFrame - 1 - (distanceFromLoopStart - 1) % loopSize;
 		}
 		else if (state->m_frameIndex >= m_loopEndFrame)
 		{
@@ -234,17 +374,20 @@ void Sample::advance(PlaybackState* state, size_t advanceAmount, Loop loopMode)
 		}
 		break;
 	case Loop::PingPong:
-		if (state->m_frameIndex < m_loopStartFrame && state->m_backwards)
-		{
-			state->m_frameIndex = m_loopStartFrame + distanceFromLoopStart % loopSize;
-			state->m_backwards = false;
-		}
-		else if (state->m_frameIndex >= m_loopEndFrame)
-		{
-			state->m_frameIndex = m_loopEndFrame - 1 - distanceFromLoopEnd % loopSize;
-			state->m_backwards = true;
-		}
+	{
+		// A period may bounce off both ends several times, so this takes the position in a cycle
+		// that plays forwards from the loop start and then backwards from the loop end
+		const auto bounce = [&](int position) {
+			position %= 2 * loopSize;
+			state->m_backwards = position >= loopSize;
+			state->m_frameIndex = state->m_backwards ? m_loopEndFrame - 1 - (position - loopSize)
+				: m_loopStartFrame + position;
+		};
+
+		if (state->m_frameIndex < m_loopStartFrame && state->m_backwards) { bounce(distanceFromLoopStart - 1); }
+		else if (state->m_frameIndex >= m_loopEndFrame) { bounce(loopSize + distanceFromLoopEnd); }
 		break;
+	}
 	default:
 		break;
 	}
@@ -42,6 +42,15 @@ SampleBuffer::SampleBuffer(const QString& audioFile)
 	if (audioFile.isEmpty()) { throw std::runtime_error{"Failure loading audio file: Audio file path is empty."}; }
 	const auto absolutePath = PathUtil::toAbsolute(audioFile);
 
+	// long recordings are played from disk instead of being decoded into memory
+	if (auto stream = SampleStream::isEnabled() ? SampleStream::open(absolutePath) : nullptr)
+	{
+		m_sampleRate = stream->sampleRate();
+		m_stream = std::move(stream);
+		m_audioFile = PathUtil::toShortestRelative(audioFile);
+		return;
+	}
+
 	if (auto decodedResult = SampleDecoder::decode(absolutePath))
 	{
 		auto& [data, sampleRate] = *decodedResult;
@@ -74,6 +83,7 @@ void swap(SampleBuffer& first, SampleBuffer& second) noexcept
 {
 	using std::swap;
 	swap(first.m_data, second.m_data);
+	swap(first.m_stream, second.m_stream);
 	swap(first.m_audioFile, second.m_audioFile);
 	swap(first.m_sampleRate, second.m_sampleRate);
 }
@@ -81,8 +91,8 @@ void swap(SampleBuffer& first, SampleBuffer& second) noexcept
 QString SampleBuffer::toBase64() const
 {
 	// TODO: Replace with non-Qt equivalent
-	const auto data = reinterpret_cast<const char*>(m_data.data());
-	const auto size = static_cast<int>(m_data.size() * sizeof(SampleFrame));
+	const auto data = reinterpret_cast<const char*>(this->data());
+	const auto size = static_cast<int>(this->size() * sizeof(SampleFrame));
 	const auto byteArray = QByteArray{data, size};
 	return byteArray.toBase64();
 }
@@ -0,0 +1,330 @@
+/*
+ * SampleStream.cpp - sample data that is memory-mapped from disk
+ *
+ * This file is part of LMMS - https://lmms.io
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this program (see COPYING); if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301 USA.
+ *
+ */
+
+#include "SampleStream.h"
+
+#include <QCryptographicHash>
+#include <QDateTime>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QSaveFile>
+#include <algorithm>
+#include <array>
+#include <cstring>
+#include <sndfile.h>
+#include <thread>
+#include <vector>
+
+#include "ConfigManager.h"
+#include "LmmsSemaphore.h"
+#include "LocklessList.h"
+
+namespace lmms {
+
+namespace {
+
+constexpr auto Magic = std::array<char, 8>{'L', 'M', 'M', 'S', 'S', 'M', 'P', 'L'};
+//! Bump this whenever the decoded format changes
+constexpr std::uint32_t CacheVersion = 1;
+//! The frames start at this offset in decoded files
+constexpr qint64 DataOffset = 64;
+constexpr sf_count_t DecodeChunkFrames = 65536;
+//! Used unless the "samplecachesize" setting gives the limit in MiB
+constexpr qint64 DefaultCacheSize = qint64{4} << 30;
+
+//! Header of decoded files, which are only read on the host that wrote them
+struct CacheHeader
+{
+	std::array<char, 8> magic = Magic;
+	std::uint32_t version = CacheVersion;
+	std::int32_t sampleRate = 0;
+	//! Size and modification time of the audio file that was decoded
+	std::int64_t sourceSize = 0;
+	std::int64_t sourceLastModified = 0;
+	std::uint64_t frames = 0;
+
+	bool operator==(const CacheHeader&) const = default;
+};
+
+static_assert(sizeof(CacheHeader) <= DataOffset);
+
+//! Either a range of mapped memory to load or a file to close
+struct Request
+{
+	const uchar* data;
+	std::size_t size;
+	QFile* file;
+};
+
+//! Loads mapped pages ahead of the audio thread and releases mappings
+class Reader
+{
+public:
+	Reader() :
+		m_requests(RequestCapacity),
+		m_semaphore(0),
+		m_thread([this] { run(); })
+	{
+	}
+
+	//! Real-time safe, returns false if too many requests are pending
+	bool post(const Request& request)
+	{
+		if (!m_requests.tryPush(request)) { return false; }
+		m_semaphore.post();
+		return true;
+	}
+
+private:
+	static constexpr std::size_t RequestCapacity = 1024;
+	static constexpr std::size_t PageSize = 4096;
+
+	void run()
+	{
+		while (true)
+		{
+			m_semaphore.wait();
+
+			// handle the requests in the order they were posted, so a file is
+			// closed only after the read-aheads in its mapping
+			auto element = m_requests.popList();
+			decltype(element) reversed = nullptr;
+			while (element)
+			{
+				const auto next = element->next;
+				element->next = reversed;
+				reversed = element;
+				element = next;
+			}
+
+			while (reversed)
+			{
+				const auto next = reversed->next;
+				process(reversed->value);
+				m_requests.free(reversed);
+				reversed = next;
+			}
+		}
+	}
+
+	static void process(const Request& request)
+	{
+		if (request.file)
+		{
+			// destroying the file removes its mapping
+			delete request.file;
+			return;
+		}
+
+		// reading a byte of every page makes the system load it
+		const volatile uchar* data = request.data;
+		for (auto offset = std::size_t{0}; offset < request.size; offset += PageSize)
+		{
+			static_cast<void>(data[offset]);
+		}
+	}
+
+	LocklessList<Request> m_requests;
+	Semaphore m_semaphore;
+	std::thread m_thread;
+};
+
+//! Never destroyed, since streams may still be released during static destruction
+auto reader() -> Reader&
+{
+	static auto* s_reader = new Reader;
+	return *s_reader;
+}
+
+auto mapDecoded(const QString& cacheFile, const CacheHeader& expected) -> std::pair<std::unique_ptr<QFile>, const uchar*>
+{
+	auto file = std::make_unique<QFile>(cacheFile);
+	const auto bytes = static_cast<qint64>(expected.frames * sizeof(SampleFrame));
+	if (file->size() != DataOffset + bytes || !file->open(QIODevice::ReadOnly)) { return {}; }
+
+	auto header = CacheHeader{};
+	if (file->read(reinterpret_cast<char*>(&header), sizeof(header)) != sizeof(header) || !(header == expected))
+	{
+		return {};
+	}
+
+	const uchar* data = file->map(DataOffset, bytes);
+	if (data == nullptr) { return {}; }
+
+	// the modification time tells trimCache() which files were used last
+	file->setFileTime(QDateTime::currentDateTime(), QFileDevice::FileModificationTime);
+	// the mapping outlives the file descriptor
+	file->close();
+	return {std::move(file), data};
+}
+
+//! Removes the least recently used decoded files, except for \a keep,
+//! until the cache fits into its size limit
+void trimCache(const QString& cacheDir, const QString& keep)
+{
+	auto valid = false;
+	const auto limitMiB = ConfigManager::inst()->value("app", "samplecachesize").toLongLong(&valid);
+	const auto limit = valid && limitMiB >= 0 ? limitMiB << 20 : DefaultCacheSize;
+
+	// oldest first
+	const auto files = QDir{cacheDir}.entryInfoList({"*.frames"}, QDir::Files, QDir::Time | QDir::Reversed);
+	auto total = qint64{0};
+	for (const auto& file : files) { total += file.size(); }
+
+	for (const auto& file : files)
+	{
+		if (total <= limit) { break; }
+		// files that are still mapped can only be removed on some systems,
+		// and are removed from disk once their last stream is gone
+		if (file.absoluteFilePath() != keep && QFile::remove(file.absoluteFilePath())) { total -= file.size(); }
+	}
+}
+
+} // namespace
+
+
+
+
+SampleStream::SampleStream(std::unique_ptr<QFile> file, const uchar* data, std::size_t size, int sampleRate)
+	: m_file(file.release())
+	, m_data(reinterpret_cast<const SampleFrame*>(data))
+	, m_size(size)
+	, m_sampleRate(sampleRate)
+{
+	// start the thread outside of the audio thread
+	reader();
+}
+
+
+
+
+SampleStream::~SampleStream()
+{
+	// pending read-aheads may still access the mapping, so it is released after them
+	while (!reader().post({nullptr, 0, m_file}))
+	{
+		std::this_thread::yield();
+	}
+}
+
+
+
+
+auto SampleStream::isEnabled() -> bool
+{
+	return ConfigManager::inst()->value("app", "streamsamples", "1").toInt();
+}
+
+
+
+
+auto SampleStream::open(const QString& audioFile, std::size_t minSize) -> std::unique_ptr<SampleStream>
+{
+	const auto source = QFileInfo{audioFile};
+	auto file = QFile{audioFile};
+	if (!file.open(QIODevice::ReadOnly)) { return nullptr; }
+
+	auto sfInfo = SF_INFO{};
+	SNDFILE* sndFile = sf_open_fd(file.handle(), SFM_READ, &sfInfo, false);
+	if (sndFile == nullptr) { return nullptr; }
+
+	const auto frames = static_cast<std::size_t>(std::max<sf_count_t>(sfInfo.frames, 0));
+	if (sfInfo.channels < 1 || frames * sizeof(SampleFrame) < minSize)
+	{
+		sf_close(sndFile);
+		return nullptr;
+	}
+
+	auto header = CacheHeader{};
+	header.sampleRate = sfInfo.samplerate;
+	header.sourceSize = source.size();
+	header.sourceLastModified = source.lastModified().toMSecsSinceEpoch();
+	header.frames = frames;
+
+	// one file per audio file, which is replaced when the audio file changes
+	const auto cacheDir = ConfigManager::inst()->cacheDir() + "samples/";
+	const auto cacheFile = cacheDir + QCryptographicHash::hash(
+		source.absoluteFilePath().toUtf8(), QCryptographicHash::Sha1).toHex() + ".frames";
+
+	if (auto [mapped, data] = mapDecoded(cacheFile, header); data != nullptr)
+	{
+		sf_close(sndFile);
+		return std::unique_ptr<SampleStream>{new SampleStream{std::move(mapped), data, frames, header.sampleRate}};
+	}
+
+	auto output = QSaveFile{cacheFile};
+	if (!QDir{}.mkpath(cacheDir) || !output.open(QIODevice::WriteOnly))
+	{
+		sf_close(sndFile);
+		return nullptr;
+	}
+
+	auto headerBytes = std::array<char, DataOffset>{};
+	std::memcpy(headerBytes.data(), &header, sizeof(header));
+	output.write(headerBytes.data(), headerBytes.size());
+
+	// decode in chunks, so the file never has to fit into memory
+	auto input = std::vector<float>(DecodeChunkFrames * sfInfo.channels);
+	auto chunk = std::vector<SampleFrame>(DecodeChunkFrames);
+	auto framesDecoded = std::size_t{0};
+	while (const auto framesRead = sf_readf_float(sndFile, input.data(), DecodeChunkFrames))
+	{
+		if (framesRead < 0) { break; }
+		for (auto i = sf_count_t{0}; i < framesRead; ++i)
+		{
+			// Upmix from mono to stereo, and like SampleDecoder only use the first two channels otherwise
+			const auto frame = &input[i * sfInfo.channels];
+			chunk[i] = sfInfo.channels == 1 ? SampleFrame{frame[0], frame[0]} : SampleFrame{frame[0], frame[1]};
+		}
+		output.write(reinterpret_cast<const char*>(chunk.data()), framesRead * sizeof(SampleFrame));
+		framesDecoded += framesRead;
+	}
+	sf_close(sndFile);
+
+	if (framesDecoded != frames)
+	{
+		output.cancelWriting();
+		return nullptr;
+	}
+	if (!output.commit()) { return nullptr; }
+	trimCache(cacheDir, cacheFile);
+
+	auto [mapped, data] = mapDecoded(cacheFile, header);
+	if (data == nullptr) { return nullptr; }
+	return std::unique_ptr<SampleStream>{new SampleStream{std::move(mapped), data, frames, header.sampleRate}};
+}
+
+
+
+
+void SampleStream::readAhead(std::size_t first, std::size_t count) const
+{
+	if (first >= m_size) { return; }
+	count = std::min(count, m_size - first);
+
+	// a dropped request only means that the audio thread loads the pages itself
+	reader().post({reinterpret_cast<const uchar*>(m_data + first), count * sizeof(SampleFrame), nullptr});
+}
+
+
+} // namespace lmms
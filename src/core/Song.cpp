@@ -31,7 +31,9 @@
 
 #include <algorithm>
 #include <cmath>
+#include <limits>
 
+#include "AutomationClip.h"
 #include "AutomationTrack.h"
 #include "AutomationEditor.h"
 #include "ConfigManager.h"
@@ -97,7 +99,8 @@ Song::Song() :
 	m_elapsedBars( 0 ),
 	m_loopRenderCount(1),
 	m_loopRenderRemaining(1),
-	m_oldAutomatedValues()
+	m_oldAutomatedValues(),
+	m_automationValues(Engine::audioEngine()->framesPerPeriod())
 {
 	for (double& millisecondsElapsed : m_elapsedMilliSeconds) { millisecondsElapsed = 0; }
 	connect( &m_tempoModel, SIGNAL(dataChanged()),
@@ -332,6 +335,7 @@ void Song::processNextBuffer()
 		{
 			// First frame of tick: process automation and play tracks
 			processAutomations(trackList, getPlayPos(), framesToPlay);
+			processAutomationBuffers(frameOffsetInPeriod, 0);
 			processMetronome(frameOffsetInPeriod);
 
 			for (const auto track : trackList)
@@ -339,6 +343,11 @@ void Song::processNextBuffer()
 				track->play(getPlayPos(), framesToPlay, frameOffsetInPeriod, clipNum);
 			}
 		}
+		else if (frameOffsetInPeriod == 0)
+		{
+			// The tick started in the previous period, continue its automation
+			processAutomationBuffers(0, frameOffsetInTick / framesPerTick);
+		}
 
 		// Update frame counters
 		frameOffsetInPeriod += framesToPlay;
@@ -357,6 +366,8 @@ void Song::processAutomations(const TrackList &tracklist, TimePos timeStart, fpp
 
 	QSet<const AutomatableModel*> recordedModels;
 
+	m_automationSources.clear();
+
 	TrackContainer* container = this;
 	int clipNum = -1;
 
@@ -377,7 +388,11 @@ void Song::processAutomations(const TrackList &tracklist, TimePos timeStart, fpp
 		return;
 	}
 
-	values = container->automatedValuesAt(timeStart, clipNum);
+	auto sources = container->automationSourcesAt(timeStart, clipNum);
+	for (auto it = sources.begin(); it != sources.end(); ++it)
+	{
+		values[it.key()] = it->clip->valueAt(it->time);
+	}
 	const TrackList& tracks = container->tracks();
 
 	Track::clipVector clips;
@@ -421,10 +436,59 @@ void Song::processAutomations(const TrackList &tracklist, TimePos timeStart, fpp
 		{
 			it.key()->setAutomatedValue(it.value());
 		}
-		else if (!it.key()->useControllerValue())
+		else
+		{
+			sources.remove(it.key());
+			if (!it.key()->useControllerValue())
+			{
+				it.key()->setUseControllerValue(true);
+			}
+		}
+	}
+	m_automationSources = std::move(sources);
+}
+
+
+
+
+void Song::clearAutomationSources()
+{
+	// the audio engine may be continuing the automation right now
+	Engine::audioEngine()->requestChangeInModel();
+	m_automationSources.clear();
+	Engine::audioEngine()->doneChangeInModel();
+}
+
+
+
+
+void Song::processAutomationBuffers(f_cnt_t offset, double tickOffset)
+{
+	const auto frames = static_cast<int>(Engine::audioEngine()->framesPerPeriod() - offset);
+	const double step = 1.0 / Engine::framesPerTick();
+	float* buffer = m_automationValues.data();
+
+	for (auto it = m_automationSources.begin(); it != m_automationSources.end(); ++it)
+	{
+		const AutomationSource& source = *it;
+		const double time = source.time + tickOffset;
+
+		// frames up to the end of the clip, the value stays there afterwards
+		int playing = frames;
+		if (source.end != std::numeric_limits<int>::max())
+		{
+			playing = time >= source.end
+				? 0
+				: static_cast<int>(std::min(std::floor((source.end - time) / step) + 1, static_cast<double>(frames)));
+		}
+
+		source.clip->valuesAt(time, step, buffer, playing);
+		if (playing < frames)
 		{
-			it.key()->setUseControllerValue(true);
+			std::fill(buffer + playing, buffer + frames, source.clip->valueAt(source.end));
 		}
+
+		it.key()->setAutomatedValueBuffer(buffer, offset);
 	}
 }
 
@@ -652,6 +716,8 @@ void Song::stop()
 	// To avoid race conditions with the processing threads
 	Engine::audioEngine()->requestChangeInModel();
 
+	clearAutomationSources();
+
 	auto& timeline = getTimeline();
 	m_paused = false;
 	m_recording = true;
@@ -836,11 +902,11 @@ bpm_t Song::getTempo()
 }
 
 
-AutomatedValueMap Song::automatedValuesAt(TimePos time, int clipNum) const
+AutomationSourceMap Song::automationSourcesAt(TimePos time, int clipNum) const
 {
 	auto trackList = TrackList{m_globalAutomationTrack};
 	trackList.insert(trackList.end(), tracks().begin(), tracks().end());
-	return TrackContainer::automatedValuesFromTracks(trackList, time, clipNum);
+	return TrackContainer::automationSourcesFromTracks(trackList, time, clipNum);
 }
 
 
@@ -865,6 +931,8 @@ void Song::clearProject()
 
 	Engine::audioEngine()->requestChangeInModel();
 
+	clearAutomationSources();
+
 	if( getGUI() != nullptr && getGUI()->patternEditor() )
 	{
 		getGUI()->patternEditor()->m_editor->clearAllTracks();
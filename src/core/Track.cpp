@@ -30,7 +30,10 @@
 #include "Track.h"
 
 #include <QDomElement>
+#include <QMutexLocker>
 #include <QVariant>
+#include <algorithm>
+#include <limits>
 
 #include "AutomationClip.h"
 #include "AutomationTrack.h"
@@ -341,6 +344,7 @@ void Track::loadSettings(const QDomElement& element)
 Clip * Track::addClip( Clip * clip )
 {
 	m_clips.push_back( clip );
+	invalidateClipIndex();
 
 	emit clipAdded( clip );
 
@@ -360,8 +364,10 @@ void Track::removeClip( Clip * clip )
 	if( it != m_clips.end() )
 	{
 		m_clips.erase( it );
+		invalidateClipIndex();
 		if( Engine::getSong() )
 		{
+			Engine::getSong()->clearAutomationSources();
 			Engine::getSong()->updateLength();
 			Engine::getSong()->setModified();
 		}
@@ -456,18 +462,48 @@ int Track::getClipNum( const Clip * clip )
 void Track::getClipsInRange( clipVector & clipV, const TimePos & start,
 							const TimePos & end )
 {
-	for( Clip* clip : m_clips )
+	QMutexLocker guard(&m_clipIndexMutex);
+	if (!m_clipIndexValid.exchange(true))
 	{
-		int s = clip->startPosition();
-		int e = clip->endPosition();
-		if( ( s <= end ) && ( e >= start ) )
+		updateClipIndex();
+	}
+
+	// maxEnd is ascending, so this skips all clips ending before start,
+	// and the start positions are ascending, so we can stop after end
+	auto it = std::partition_point(m_clipIndex.begin(), m_clipIndex.end(),
+		[&](const IndexedClip& c) { return c.maxEnd < start; });
+	const auto oldSize = clipV.size();
+	for (; it != m_clipIndex.end() && it->start <= end; ++it)
+	{
+		if (it->end >= start)
 		{
-			// Clip is within given range
-			// Insert sorted by Clip's position
-			clipV.insert(std::upper_bound(clipV.begin(), clipV.end(), clip, Clip::comparePosition),
-						clip);
+			clipV.push_back(it->clip);
 		}
 	}
+
+	// callers may collect the clips of several tracks
+	std::inplace_merge(clipV.begin(), clipV.begin() + oldSize, clipV.end(), Clip::comparePosition);
+}
+
+
+
+
+void Track::updateClipIndex()
+{
+	m_clipIndex.clear();
+	for (Clip* clip : m_clips)
+	{
+		m_clipIndex.push_back({clip->startPosition(), clip->endPosition(), 0, clip});
+	}
+	std::stable_sort(m_clipIndex.begin(), m_clipIndex.end(),
+		[](const IndexedClip& a, const IndexedClip& b) { return a.start < b.start; });
+
+	int maxEnd = std::numeric_limits<int>::min();
+	for (auto& c : m_clipIndex)
+	{
+		maxEnd = std::max(maxEnd, c.end);
+		c.maxEnd = maxEnd;
+	}
 }
 
 
@@ -208,6 +208,7 @@ void TrackContainer::removeTrack( Track * _track )
 
 		if( Engine::getSong() )
 		{
+			Engine::getSong()->clearAutomationSources();
 			Engine::getSong()->setModified();
 		}
 	}
@@ -252,11 +253,24 @@ bool TrackContainer::isEmpty() const
 
 AutomatedValueMap TrackContainer::automatedValuesAt(TimePos time, int clipNum) const
 {
-	return automatedValuesFromTracks(tracks(), time, clipNum);
+	const auto sources = automationSourcesAt(time, clipNum);
+
+	AutomatedValueMap valueMap;
+	for (auto it = sources.begin(); it != sources.end(); ++it)
+	{
+		valueMap[it.key()] = it->clip->valueAt(it->time);
+	}
+	return valueMap;
 }
 
 
-AutomatedValueMap TrackContainer::automatedValuesFromTracks(const TrackList &tracks, TimePos time, int clipNum)
+AutomationSourceMap TrackContainer::automationSourcesAt(TimePos time, int clipNum) const
+{
+	return automationSourcesFromTracks(tracks(), time, clipNum);
+}
+
+
+AutomationSourceMap TrackContainer::automationSourcesFromTracks(const TrackList &tracks, TimePos time, int clipNum)
 {
 	Track::clipVector clips;
 
@@ -282,7 +296,7 @@ AutomatedValueMap TrackContainer::automatedValuesFromTracks(const TrackList &tra
 		}
 	}
 
-	AutomatedValueMap valueMap;
+	AutomationSourceMap sourceMap;
 
 	Q_ASSERT(std::is_sorted(clips.begin(), clips.end(), Clip::comparePosition));
 
@@ -297,15 +311,15 @@ AutomatedValueMap TrackContainer::automatedValuesFromTracks(const TrackList &tra
 			if (! p->hasAutomation()) {
 				continue;
 			}
-			TimePos relTime = time - p->startPosition();
+			auto source = AutomationSource{p, time - p->startPosition()};
 			if (! p->getAutoResize()) {
-				relTime = std::min(relTime, p->length());
+				source.end = p->length();
+				source.time = std::min(source.time, p->length());
 			}
-			float value = p->valueAt(relTime);
 
 			for (AutomatableModel* model : p->objects())
 			{
-				valueMap[model] = value;
+				sourceMap[model] = source;
 			}
 		}
 		else if (auto* pattern = dynamic_cast<PatternClip*>(clip))
@@ -317,11 +331,11 @@ AutomatedValueMap TrackContainer::automatedValuesFromTracks(const TrackList &tra
 			patTime = std::min(patTime, clip->length());
 			patTime = patTime % (patStore->lengthOfPattern(patIndex) * TimePos::ticksPerBar());
 
-			auto patValues = patStore->automatedValuesAt(patTime, patIndex);
-			for (auto it=patValues.begin(); it != patValues.end(); it++)
+			auto patSources = patStore->automationSourcesAt(patTime, patIndex);
+			for (auto it=patSources.begin(); it != patSources.end(); it++)
 			{
 				// override old values, pattern track with the highest index takes precedence
-				valueMap[it.key()] = it.value();
+				sourceMap[it.key()] = it.value();
 			}
 		}
 		else
@@ -330,7 +344,7 @@ AutomatedValueMap TrackContainer::automatedValuesFromTracks(const TrackList &tra
 		}
 	}
 
-	return valueMap;
+	return sourceMap;
 };
 
 
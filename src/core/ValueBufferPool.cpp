@@ -0,0 +1,160 @@
+/*
+ * ValueBufferPool.cpp - shared pool of period-sized ValueBuffers
+ *
+ * This file is part of LMMS - https://lmms.io
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this program (see COPYING); if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301 USA.
+ *
+ */
+
+#include "ValueBufferPool.h"
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+
+#include "LocklessIndexStack.h"
+#include "ValueBuffer.h"
+
+
+namespace lmms
+{
+
+static constexpr std::uint32_t INITIAL_BUFFERS = 64;
+static constexpr std::uint32_t MAX_POOLED_BUFFERS = 16384;
+
+// slot of buffers allocated after the pool reached its maximum size
+static constexpr std::uint32_t UNPOOLED = LocklessIndexStack::Empty;
+
+
+namespace
+{
+
+struct PooledValueBuffer : public ValueBuffer
+{
+	PooledValueBuffer(int length, std::uint32_t slot) :
+		ValueBuffer(length),
+		slot(slot)
+	{
+	}
+
+	const std::uint32_t slot;
+};
+
+
+struct Pool
+{
+	explicit Pool(fpp_t fpp) :
+		framesPerPeriod(fpp),
+		freeSlots(MAX_POOLED_BUFFERS),
+		buffers(std::make_unique<std::unique_ptr<PooledValueBuffer>[]>(MAX_POOLED_BUFFERS)),
+		numBuffers(0),
+		inUse(0),
+		poolMisses(0)
+	{
+	}
+
+	PooledValueBuffer* create()
+	{
+		auto slot = numBuffers.load();
+		do
+		{
+			if (slot >= MAX_POOLED_BUFFERS)
+			{
+				return new PooledValueBuffer(framesPerPeriod, UNPOOLED);
+			}
+		}
+		while (!numBuffers.compare_exchange_weak(slot, slot + 1));
+
+		buffers[slot] = std::make_unique<PooledValueBuffer>(framesPerPeriod, slot);
+		return buffers[slot].get();
+	}
+
+	const fpp_t framesPerPeriod;
+	LocklessIndexStack freeSlots;
+	std::unique_ptr<std::unique_ptr<PooledValueBuffer>[]> buffers;
+	std::atomic<std::uint32_t> numBuffers;
+	std::atomic<std::size_t> inUse;
+	std::atomic<std::size_t> poolMisses;
+};
+
+} // namespace
+
+
+static std::unique_ptr<Pool> s_pool;
+
+
+
+
+void ValueBufferPool::init(fpp_t fpp)
+{
+	s_pool = std::make_unique<Pool>(fpp);
+	for (std::uint32_t i = 0; i < INITIAL_BUFFERS; ++i)
+	{
+		s_pool->freeSlots.push(s_pool->create()->slot);
+	}
+}
+
+
+
+
+ValueBuffer* ValueBufferPool::acquire()
+{
+	++s_pool->inUse;
+	const auto slot = s_pool->freeSlots.pop();
+	if (slot != LocklessIndexStack::Empty)
+	{
+		return s_pool->buffers[slot].get();
+	}
+
+	// pool is exhausted - there's no way around allocating here
+	++s_pool->poolMisses;
+	return s_pool->create();
+}
+
+
+
+
+void ValueBufferPool::release(ValueBuffer* buf)
+{
+	if (!buf) { return; }
+
+	const auto slot = static_cast<PooledValueBuffer*>(buf)->slot;
+	if (slot == UNPOOLED)
+	{
+		delete static_cast<PooledValueBuffer*>(buf);
+	}
+	else
+	{
+		s_pool->freeSlots.push(slot);
+	}
+	--s_pool->inUse;
+}
+
+
+
+
+auto ValueBufferPool::statistics() -> Statistics
+{
+	return {
+		s_pool->numBuffers.load(),
+		s_pool->inUse.load(),
+		s_pool->poolMisses.load()
+	};
+}
+
+
+} // namespace lmms
@@ -28,6 +28,7 @@
 #include "AudioEngine.h"
 #include "ConfigManager.h"
 #include "debug.h"
+#include "RenderTracer.h"
 
 namespace lmms
 {
@@ -36,8 +37,7 @@ AudioDevice::AudioDevice( const ch_cnt_t _channels, AudioEngine*  _audioEngine )
 	m_supportsCapture( false ),
 	m_sampleRate( _audioEngine->outputSampleRate() ),
 	m_channels( _channels ),
-	m_audioEngine( _audioEngine ),
-	m_buffer(new SampleFrame[audioEngine()->framesPerPeriod()])
+	m_audioEngine( _audioEngine )
 {
 }
 
@@ -46,7 +46,6 @@ AudioDevice::AudioDevice( const ch_cnt_t _channels, AudioEngine*  _audioEngine )
 
 AudioDevice::~AudioDevice()
 {
-	delete[] m_buffer;
 	m_devMutex.tryLock();
 	unlock();
 }
@@ -56,8 +55,12 @@ AudioDevice::~AudioDevice()
 
 void AudioDevice::processNextBuffer()
 {
-	const fpp_t frames = getNextBuffer( m_buffer );
-	if (frames) { writeBuffer(m_buffer, frames); }
+	RenderTracer::Scope traceScope("Device callback", "device");
+	if (const SampleFrame* b = acquireNextBuffer())
+	{
+		writeBuffer(b, audioEngine()->framesPerPeriod());
+		releaseNextBuffer();
+	}
 	else
 	{
 		m_inProcess = false;
@@ -66,17 +69,28 @@ void AudioDevice::processNextBuffer()
 
 fpp_t AudioDevice::getNextBuffer(SampleFrame* _ab)
 {
+	RenderTracer::Scope traceScope("Device callback", "device");
 	fpp_t frames = audioEngine()->framesPerPeriod();
-	const SampleFrame* b = audioEngine()->nextBuffer();
+	const SampleFrame* b = acquireNextBuffer();
 
 	if (!b) { return 0; }
 
 	memcpy(_ab, b, frames * sizeof(SampleFrame));
 
-	if (audioEngine()->hasFifoWriter()) { delete[] b; }
+	releaseNextBuffer();
 	return frames;
 }
 
+const SampleFrame* AudioDevice::acquireNextBuffer()
+{
+	return audioEngine()->nextBuffer();
+}
+
+void AudioDevice::releaseNextBuffer()
+{
+	audioEngine()->releaseNextBuffer();
+}
+
 
 
 
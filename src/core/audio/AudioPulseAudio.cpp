@@ -249,19 +249,21 @@ void AudioPulseAudio::run()
 void AudioPulseAudio::streamWriteCallback( pa_stream *s, size_t length )
 {
 	const fpp_t fpp = audioEngine()->framesPerPeriod();
-	auto temp = new SampleFrame[fpp];
 	auto pcmbuf = (int_sample_t*)pa_xmalloc(fpp * channels() * sizeof(int_sample_t));
 
 	size_t fd = 0;
 	while( fd < length/4 && m_quit == false )
 	{
-		const fpp_t frames = getNextBuffer( temp );
-		if( !frames )
+		// convert directly from the engine's buffer instead of copying it first
+		const SampleFrame* buf = acquireNextBuffer();
+		if( !buf )
 		{
 			m_quit = true;
 			break;
 		}
-		int bytes = convertToS16(temp, frames, pcmbuf, m_convertEndian);
+		const fpp_t frames = fpp;
+		int bytes = convertToS16(buf, frames, pcmbuf, m_convertEndian);
+		releaseNextBuffer();
 		if( bytes > 0 )
 		{
 			pa_stream_write( m_s, pcmbuf, bytes, nullptr, 0,
@@ -271,7 +273,6 @@ void AudioPulseAudio::streamWriteCallback( pa_stream *s, size_t length )
 	}
 
 	pa_xfree( pcmbuf );
-	delete[] temp;
 }
 
 
@@ -160,6 +160,32 @@ void Lv2ControlBase::copyBuffersToLmms(SampleFrame* buf, fpp_t frames) const {
 
 
 
+void Lv2ControlBase::copyBuffersFromLmms(const PlanarBuffer& buf, fpp_t frames)
+{
+	unsigned firstChan = 0;
+	for (const auto& c : m_procs)
+	{
+		c->copyBuffersFromCore(buf, firstChan, m_channelsPerProc, frames);
+		firstChan += m_channelsPerProc;
+	}
+}
+
+
+
+
+void Lv2ControlBase::copyBuffersToLmms(PlanarBuffer& buf, fpp_t frames) const
+{
+	unsigned firstChan = 0;
+	for (const auto& c : m_procs)
+	{
+		c->copyBuffersToCore(buf, firstChan, m_channelsPerProc, frames);
+		firstChan += m_channelsPerProc;
+	}
+}
+
+
+
+
 void Lv2ControlBase::run(fpp_t frames) {
 	for (const auto& c : m_procs) { c->run(frames); }
 }
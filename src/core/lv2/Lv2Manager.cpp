@@ -32,16 +32,22 @@
 #include <lv2/buf-size/buf-size.h>
 #include <lv2/options/options.h>
 #include <lv2/worker/worker.h>
+#include <QDataStream>
+#include <QDateTime>
 #include <QDebug>
 #include <QElapsedTimer>
+#include <QFileInfo>
+#include <QHash>
 
 #include "AudioEngine.h"
+#include "CacheFile.h"
 #include "ConfigManager.h"
 #include "Engine.h"
 #include "Plugin.h"
 #include "Lv2ControlBase.h"
 #include "Lv2Options.h"
 #include "PluginIssue.h"
+#include "lmmsversion.h"
 
 
 namespace lmms
@@ -165,6 +171,82 @@ const std::set<std::string_view> Lv2Manager::unstablePluginsBuffersizeLessEqual3
 
 
 
+namespace
+{
+
+const auto CatalogFile = QStringLiteral("lv2-catalog.dat");
+//! Bump this whenever the catalog format changes
+constexpr quint32 CatalogVersion = 1;
+
+//! What Lv2Manager::initPlugins() found out about a plugin
+struct CatalogEntry
+{
+	//! Latest modification time and total size of the files describing the plugin
+	qint64 lastModified = 0;
+	qint64 size = -1;
+	Plugin::Type type = Plugin::Type::Undefined;
+	bool valid = false;
+	bool blocked = false;
+	QString name;
+
+	bool operator==(const CatalogEntry&) const = default;
+};
+
+using Catalog = QHash<QString, CatalogEntry>;
+
+QDataStream& operator<<(QDataStream& out, const CatalogEntry& entry)
+{
+	return out << entry.lastModified << entry.size << static_cast<qint32>(entry.type)
+		<< entry.valid << entry.blocked << entry.name;
+}
+
+QDataStream& operator>>(QDataStream& in, CatalogEntry& entry)
+{
+	auto type = qint32{0};
+	in >> entry.lastModified >> entry.size >> type >> entry.valid >> entry.blocked >> entry.name;
+	entry.type = static_cast<Plugin::Type>(type);
+	return in;
+}
+
+//! Everything besides the plugin's files that Lv2ControlBase::check() depends on
+QString catalogContext()
+{
+	const auto fpp = Engine::audioEngine()->framesPerPeriod();
+	return QString{"%1 %2 %3 %4"}.arg(LMMS_VERSION)
+		.arg(fpp <= 32).arg((fpp & (fpp - 1)) == 0).arg(ConfigManager::enableBlockedPlugins());
+}
+
+//! Stamps the plugin's data files and its bundle directory, which changes
+//! when files (e.g. the binary) are added, removed or replaced.
+//! The data file URIs are known from the bundle manifests, so this does not
+//! make lilv load the plugin's data.
+CatalogEntry stampPlugin(const LilvPlugin* plug)
+{
+	auto entry = CatalogEntry{};
+	entry.size = 0;
+	auto stampFile = [&entry](const LilvNode* uriNode, bool addSize)
+	{
+		auto path = AutoLilvPtr<char>(lilv_file_uri_parse(lilv_node_as_uri(uriNode), nullptr));
+		if (!path) { return; }
+		const auto file = QFileInfo{QString::fromLocal8Bit(path.get())};
+		entry.lastModified = std::max(entry.lastModified, file.lastModified().toMSecsSinceEpoch());
+		if (addSize) { entry.size += file.size(); }
+	};
+
+	stampFile(lilv_plugin_get_bundle_uri(plug), false);
+	const LilvNodes* dataUris = lilv_plugin_get_data_uris(plug);
+	LILV_FOREACH(nodes, itr, dataUris)
+	{
+		stampFile(lilv_nodes_get(dataUris, itr), true);
+	}
+	return entry;
+}
+
+} // namespace
+
+
+
+
 Lv2Manager::Lv2Manager() :
 	m_uridCache(m_uridMap)
 {
@@ -241,43 +323,71 @@ void Lv2Manager::initPlugins()
 	QElapsedTimer timer;
 	timer.start();
 
+	// Plugins whose files did not change since the last run are not checked
+	// again, since checking them makes lilv parse all of their data.
+	// Debug output needs the issues, so it bypasses the catalog.
+	const QString context = catalogContext();
+	Catalog catalog;
+	if (!m_debug && !CacheFile::read(CatalogFile, CatalogVersion, [&](QDataStream& in) {
+		auto catalogContext = QString{};
+		in >> catalogContext;
+		if (catalogContext == context) { in >> catalog; }
+	}))
+	{
+		catalog.clear();
+	}
+	Catalog updatedCatalog;
+
 	unsigned blocked = 0;
 	LILV_FOREACH(plugins, itr, plugins)
 	{
 		const LilvPlugin* curPlug = lilv_plugins_get(plugins, itr);
+		const char* pluginUri = lilv_node_as_uri(lilv_plugin_get_uri(curPlug));
 
-		std::vector<PluginIssue> issues;
-		Plugin::Type type = Lv2ControlBase::check(curPlug, issues);
-		std::sort(issues.begin(), issues.end());
-		auto last = std::unique(issues.begin(), issues.end());
-		issues.erase(last, issues.end());
-		if (m_debug && issues.size())
+		CatalogEntry entry = stampPlugin(curPlug);
+		if (const auto cached = catalog.constFind(pluginUri); cached != catalog.constEnd()
+			&& cached->lastModified == entry.lastModified && cached->size == entry.size)
 		{
-			qDebug() << "Lv2 plugin"
-				<< qStringFromPluginNode(curPlug, lilv_plugin_get_name)
-				<< "(URI:"
-				<< lilv_node_as_uri(lilv_plugin_get_uri(curPlug))
-				<< ") can not be loaded:";
-			for (const PluginIssue& iss : issues) { qDebug() << "  - " << iss; }
+			entry = *cached;
 		}
-
-		Lv2Info info(curPlug, type, issues.empty());
-
-		m_lv2InfoMap[lilv_node_as_uri(lilv_plugin_get_uri(curPlug))]
-			= std::move(info);
-		if(issues.empty()) { ++pluginsLoaded; }
 		else
 		{
-			if(std::any_of(issues.begin(), issues.end(),
-				[](const PluginIssue& iss) {
-				return iss.type() == PluginIssueType::Blocked; }))
+			std::vector<PluginIssue> issues;
+			entry.type = Lv2ControlBase::check(curPlug, issues);
+			std::sort(issues.begin(), issues.end());
+			auto last = std::unique(issues.begin(), issues.end());
+			issues.erase(last, issues.end());
+			if (m_debug && issues.size())
 			{
-				++blocked;
+				qDebug() << "Lv2 plugin"
+					<< qStringFromPluginNode(curPlug, lilv_plugin_get_name)
+					<< "(URI:"
+					<< pluginUri
+					<< ") can not be loaded:";
+				for (const PluginIssue& iss : issues) { qDebug() << "  - " << iss; }
 			}
+
+			entry.valid = issues.empty();
+			entry.blocked = std::any_of(issues.begin(), issues.end(),
+				[](const PluginIssue& iss) {
+				return iss.type() == PluginIssueType::Blocked; });
+			if (entry.valid) { entry.name = qStringFromPluginNode(curPlug, lilv_plugin_get_name); }
 		}
+		updatedCatalog.insert(pluginUri, entry);
+
+		m_lv2InfoMap[pluginUri] = Lv2Info(curPlug, entry.type, entry.valid, entry.name);
+		if (entry.valid) { ++pluginsLoaded; }
+		else if (entry.blocked) { ++blocked; }
 		++pluginCount;
 	}
 
+	if (!m_debug && updatedCatalog != catalog)
+	{
+		CacheFile::write(CatalogFile, CatalogVersion, [&](QDataStream& out) {
+			out << context << updatedCatalog;
+		});
+	}
+
 	qDebug() << "Lv2 plugin SUMMARY:"
 		<< pluginsLoaded << "of" << pluginCount << " loaded in"
 		<< timer.elapsed() << "msecs.";
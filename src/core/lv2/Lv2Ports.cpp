@@ -34,6 +34,7 @@
 #include "Lv2Basics.h"
 #include "Lv2Manager.h"
 #include "Lv2Evbuf.h"
+#include "PlanarBuffer.h"
 #include "SampleFrame.h"
 
 
@@ -348,6 +349,37 @@ void Audio::copyBuffersToCore(SampleFrame* lmmsBuf,
 
 
 
+void Audio::copyBuffersFromCore(const PlanarBuffer& lmmsBuf,
+	unsigned channel, fpp_t frames)
+{
+	std::copy_n(lmmsBuf.channel(channel), frames, m_buffer.begin());
+}
+
+
+
+
+void Audio::averageWithBuffersFromCore(const PlanarBuffer& lmmsBuf,
+	unsigned channel, fpp_t frames)
+{
+	const sample_t* samples = lmmsBuf.channel(channel);
+	for (std::size_t f = 0; f < static_cast<unsigned>(frames); ++f)
+	{
+		m_buffer[f] = (m_buffer[f] + samples[f]) / 2.0f;
+	}
+}
+
+
+
+
+void Audio::copyBuffersToCore(PlanarBuffer& lmmsBuf,
+	unsigned channel, fpp_t frames) const
+{
+	std::copy_n(m_buffer.begin(), frames, lmmsBuf.channel(channel));
+}
+
+
+
+
 void AtomSeq::Lv2EvbufDeleter::operator()(LV2_Evbuf *n) { lv2_evbuf_free(n); }
 
 
@@ -325,24 +325,28 @@ void Lv2Proc::copyModelsToCore()
 
 
 
-void Lv2Proc::copyBuffersFromCore(const SampleFrame* buf,
-									unsigned firstChan, unsigned num,
-									fpp_t frames)
+namespace
 {
-	inPorts().m_left->copyBuffersFromCore(buf, firstChan, frames);
+
+// Buf is either an interleaved SampleFrame array or a PlanarBuffer
+template<class Buf>
+void copyPortBuffersFromCore(const Lv2Proc::StereoPortRef& ports,
+	const Buf& buf, unsigned firstChan, unsigned num, fpp_t frames)
+{
+	ports.m_left->copyBuffersFromCore(buf, firstChan, frames);
 	if (num > 1)
 	{
 		// if the caller requests to take input from two channels, but we only
 		// have one input channel... take medium of left and right for
 		// mono input
 		// (this happens if we have two outputs and only one input)
-		if (inPorts().m_right)
+		if (ports.m_right)
 		{
-			inPorts().m_right->copyBuffersFromCore(buf, firstChan + 1, frames);
+			ports.m_right->copyBuffersFromCore(buf, firstChan + 1, frames);
 		}
 		else
 		{
-			inPorts().m_left->averageWithBuffersFromCore(buf, firstChan + 1, frames);
+			ports.m_left->averageWithBuffersFromCore(buf, firstChan + 1, frames);
 		}
 	}
 }
@@ -350,22 +354,64 @@ void Lv2Proc::copyBuffersFromCore(const SampleFrame* buf,
 
 
 
-void Lv2Proc::copyBuffersToCore(SampleFrame* buf,
-								unsigned firstChan, unsigned num,
-								fpp_t frames) const
+template<class Buf>
+void copyPortBuffersToCore(const Lv2Proc::StereoPortRef& ports,
+	Buf& buf, unsigned firstChan, unsigned num, fpp_t frames)
 {
-	outPorts().m_left->copyBuffersToCore(buf, firstChan + 0, frames);
+	ports.m_left->copyBuffersToCore(buf, firstChan + 0, frames);
 	if (num > 1)
 	{
 		// if the caller requests to copy into two channels, but we only have
 		// one output channel, duplicate our output
 		// (this happens if we have two inputs and only one output)
-		Lv2Ports::Audio* ap = outPorts().m_right
-			? outPorts().m_right : outPorts().m_left;
+		Lv2Ports::Audio* ap = ports.m_right
+			? ports.m_right : ports.m_left;
 		ap->copyBuffersToCore(buf, firstChan + 1, frames);
 	}
 }
 
+} // namespace
+
+
+
+
+void Lv2Proc::copyBuffersFromCore(const SampleFrame* buf,
+									unsigned firstChan, unsigned num,
+									fpp_t frames)
+{
+	copyPortBuffersFromCore(inPorts(), buf, firstChan, num, frames);
+}
+
+
+
+
+void Lv2Proc::copyBuffersToCore(SampleFrame* buf,
+								unsigned firstChan, unsigned num,
+								fpp_t frames) const
+{
+	copyPortBuffersToCore(outPorts(), buf, firstChan, num, frames);
+}
+
+
+
+
+void Lv2Proc::copyBuffersFromCore(const PlanarBuffer& buf,
+									unsigned firstChan, unsigned num,
+									fpp_t frames)
+{
+	copyPortBuffersFromCore(inPorts(), buf, firstChan, num, frames);
+}
+
+
+
+
+void Lv2Proc::copyBuffersToCore(PlanarBuffer& buf,
+								unsigned firstChan, unsigned num,
+								fpp_t frames) const
+{
+	copyPortBuffersToCore(outPorts(), buf, firstChan, num, frames);
+}
+
 
 
 
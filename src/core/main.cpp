@@ -208,6 +208,8 @@ void printHelp()
 		"          If not specified, render will overwrite the input file\n"
 		"          For \"rendertracks\", this might be required\n"
 		"  -p, --profile <out>            Dump profiling information to file <out>\n"
+		"  -t, --trace <out>              Record a timeline of the render loop to\n"
+		"          file <out> in Chrome trace format\n"
 		"  -s, --samplerate <samplerate>  Specify output samplerate in Hz\n"
 		"          Range: 44100 (default) to 192000\n"
 		"          Possible values: 1, 2, 4, 8\n"
@@ -259,7 +261,7 @@ int main( int argc, char * * argv )
 	bool allowRoot = false;
 	bool renderLoop = false;
 	bool renderTracks = false;
-	QString fileToLoad, fileToImport, renderOut, profilerOutputFile, configFile;
+	QString fileToLoad, fileToImport, renderOut, profilerOutputFile, traceOutputFile, configFile;
 
 	// first of two command-line parsing stages
 	for (int i = 1; i < argc; ++i)
@@ -678,6 +680,17 @@ int main( int argc, char * * argv )
 
 			profilerOutputFile = QString::fromLocal8Bit( argv[i] );
 		}
+		else if( arg == "--trace" || arg == "-t" )
+		{
+			++i;
+
+			if( i == argc )
+			{
+				return usageError( "No trace file specified" );
+			}
+
+			traceOutputFile = QString::fromLocal8Bit( argv[i] );
+		}
 		else if( arg == "--config" || arg == "-c" )
 		{
 			++i;
@@ -791,6 +804,12 @@ int main( int argc, char * * argv )
 			Engine::audioEngine()->profiler().setOutputFile( profilerOutputFile );
 		}
 
+		if( !traceOutputFile.isEmpty()
+			&& !Engine::audioEngine()->profiler().setTraceFile( traceOutputFile ) )
+		{
+			printf( "Could not open trace file %s\n", traceOutputFile.toUtf8().constData() );
+		}
+
 		// start now!
 		if ( renderTracks )
 		{
@@ -51,12 +51,12 @@ void MidiController::updateValueBuffer()
 {
 	if( m_previousValue != m_lastValue )
 	{
-		m_valueBuffer.interpolate( m_previousValue, m_lastValue );
+		m_valueBuffer->interpolate( m_previousValue, m_lastValue );
 		m_previousValue = m_lastValue;
 	}
 	else
 	{
-		m_valueBuffer.fill( m_lastValue );
+		m_valueBuffer->fill( m_lastValue );
 	}
 	m_bufferLastUpdated = s_periods;
 }
@@ -242,6 +242,7 @@ void EnvelopeAndLfoView::dropEvent( QDropEvent * _de )
 	if( type == "samplefile" )
 	{
 		m_params->m_userWave = SampleLoader::createBufferFromFile(value);
+		m_params->updateSampleVars();
 		m_userLfoBtn->model()->setValue( true );
 		m_params->m_lfoWaveModel.setValue(static_cast<int>(EnvelopeAndLfoParameters::LfoShape::UserDefinedWave));
 		_de->accept();
@@ -254,6 +255,7 @@ void EnvelopeAndLfoView::dropEvent( QDropEvent * _de )
 					firstChildElement().firstChildElement().
 					firstChildElement().attribute("src");
 		m_params->m_userWave = SampleLoader::createBufferFromFile(file);
+		m_params->updateSampleVars();
 		m_userLfoBtn->model()->setValue( true );
 		m_params->m_lfoWaveModel.setValue(static_cast<int>(EnvelopeAndLfoParameters::LfoShape::UserDefinedWave));
 		_de->accept();
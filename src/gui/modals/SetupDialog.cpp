@@ -140,6 +140,8 @@ SetupDialog::SetupDialog(ConfigTab tab_to_open) :
 			"ui", "vstalwaysontop").toInt()),
 	m_disableAutoQuit(ConfigManager::inst()->value(
 			"ui", "disableautoquit", "1").toInt()),
+	m_streamSamples(ConfigManager::inst()->value(
+			"app", "streamsamples", "1").toInt()),
 	m_NaNHandler(ConfigManager::inst()->value(
 			"app", "nanhandler", "1").toInt()),
 	m_bufferSize(ConfigManager::inst()->value(
@@ -449,10 +451,19 @@ SetupDialog::SetupDialog(ConfigTab tab_to_open) :
 		m_disableAutoQuit, SLOT(toggleDisableAutoQuit(bool)), false);
 
 
+	// Samples group
+	QGroupBox * samplesBox = new QGroupBox(tr("Samples"), performance_w);
+	QVBoxLayout * samplesLayout = new QVBoxLayout(samplesBox);
+
+	addCheckBox(tr("Play long samples from disk instead of memory"), samplesBox, samplesLayout,
+		m_streamSamples, SLOT(toggleStreamSamples(bool)), false);
+
+
 	// Performance layout ordering.
 	performance_layout->addWidget(autoSaveBox);
 	performance_layout->addWidget(uiFxBox);
 	performance_layout->addWidget(pluginsBox);
+	performance_layout->addWidget(samplesBox);
 	performance_layout->addStretch();
 
 
@@ -959,6 +970,8 @@ void SetupDialog::accept()
 					QString::number(m_vstAlwaysOnTop));
 	ConfigManager::inst()->setValue("ui", "disableautoquit",
 					QString::number(m_disableAutoQuit));
+	ConfigManager::inst()->setValue("app", "streamsamples",
+					QString::number(m_streamSamples));
 	ConfigManager::inst()->setValue("audioengine", "audiodev",
 					m_audioIfaceNames[m_audioInterfaces->currentText()]);
 	ConfigManager::inst()->setValue("app", "nanhandler",
@@ -1165,6 +1178,12 @@ void SetupDialog::toggleDisableAutoQuit(bool enabled)
 	m_disableAutoQuit = enabled;
 }
 
+
+void SetupDialog::toggleStreamSamples(bool enabled)
+{
+	m_streamSamples = enabled;
+}
+
 void SetupDialog::audioInterfaceChanged(const QString & iface)
 {
 	for(AswMap::iterator it = m_audioIfaceSetupWidgets.begin();
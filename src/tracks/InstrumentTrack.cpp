@@ -73,6 +73,7 @@ InstrumentTrack::InstrumentTrack( TrackContainer* tc ) :
 	m_piano(this),
 	m_microtuner()
 {
+	m_audioPort.setCpuTimeCounter(&m_cpuTime);
 	m_pitchModel.setCenterValue( 0 );
 	m_pitchModel.setStrictStepSize(true);
 	m_panningModel.setCenterValue( DefaultPanning );
@@ -753,23 +754,9 @@ bool InstrumentTrack::play( const TimePos & _start, const fpp_t _frames,
 			cur_start -= c->startPosition();
 		}
 
-		// get all notes from the given clip...
+		// start at the first note at or after cur_start
 		const NoteVector & notes = c->notes();
-		// ...and set our index to zero
-		auto nit = notes.begin();
-
-		// very effective algorithm for playing notes that are
-		// posated within the current sample-frame
-
-
-		if( cur_start > 0 )
-		{
-			// skip notes which are posated before start-bar
-			while( nit != notes.end() && ( *nit )->pos() < cur_start )
-			{
-				++nit;
-			}
-		}
+		auto nit = c->firstNoteFrom(cur_start);
 
 		while (nit != notes.end() && (*nit)->pos() == cur_start)
 		{
@@ -208,6 +208,31 @@ Note * MidiClip::addNote( const Note & _new_note, const bool _quant_pos )
 
 
 
+NoteVector::const_iterator MidiClip::firstNoteFrom(const TimePos& pos) const
+{
+	// the cursor is only a hint, it may be stale after notes were edited
+	auto cursor = std::min(m_playCursor, m_notes.size());
+	if (cursor > 0 && m_notes[cursor - 1]->pos() >= pos)
+	{
+		// seek backwards, e.g. when looping
+		cursor = std::lower_bound(m_notes.begin(), m_notes.end(), pos,
+			[](const Note* note, const TimePos& p) { return note->pos() < p; }) - m_notes.begin();
+	}
+	else
+	{
+		while (cursor < m_notes.size() && m_notes[cursor]->pos() < pos)
+		{
+			++cursor;
+		}
+	}
+
+	m_playCursor = cursor;
+	return m_notes.begin() + cursor;
+}
+
+
+
+
 NoteVector::const_iterator MidiClip::removeNote(NoteVector::const_iterator it)
 {
 	instrumentTrack()->lock();
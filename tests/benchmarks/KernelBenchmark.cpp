@@ -0,0 +1,468 @@
+/*
+ * KernelBenchmark.cpp - microbenchmarks of the DSP kernels (lmms-kernel-bench)
+ *
+ * This file is part of LMMS - https://lmms.io
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this program (see COPYING); if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301 USA.
+ *
+ */
+
+/*
+	Times the inner loops of the audio engine in isolation and prints one
+	JSON object per kernel and buffer size:
+
+		lmms-kernel-bench [FILTER]... [--min-time MS] [--min-frames N] [--max-frames N]
+			[--simd none|sse2|avx2|avx512]
+
+	Only kernels whose name contains one of the FILTER strings are run. The
+	buffer sizes are the powers of two from --min-frames (default 32) to
+	--max-frames (default 4096). Every size is run in batches for at least
+	--min-time milliseconds (default 50); nsPerFrame is the median of the
+	batches, minNsPerFrame the fastest one. Oscillators and filters are
+	timed for a single channel, all other kernels process stereo frames.
+	--simd limits the instruction set used by MixHelpers, by default the
+	best one the CPU supports is used.
+*/
+
+#include <QCoreApplication>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <functional>
+#include <iterator>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "AudioDummy.h"
+#include "AudioEngine.h"
+#include "AudioResampler.h"
+#include "AutomatableModel.h"
+#include "BasicFilters.h"
+#include "Engine.h"
+#include "MixHelpers.h"
+#include "Oscillator.h"
+#include "Sample.h"
+#include "SampleBuffer.h"
+#include "SampleFrame.h"
+#include "ValueBuffer.h"
+
+namespace
+{
+
+using namespace lmms;
+
+using Clock = std::chrono::steady_clock;
+
+constexpr const char* SimdLevelNames[] = {"none", "sse2", "avx2", "avx512"};
+
+struct Options
+{
+	int minTimeMs = 50;
+	int minFrames = 32;
+	int maxFrames = 4096;
+	MixHelpers::SimdLevel simd = MixHelpers::supportedSimdLevel();
+};
+
+struct Kernel
+{
+	std::string name;
+	std::function<void(fpp_t)> run;
+};
+
+struct Result
+{
+	double nsPerFrame;
+	double minNsPerFrame;
+};
+
+
+//! Keeps the results of kernels without side effects alive
+volatile float s_sink = 0.f;
+
+
+//! Input and output buffers shared by all kernels, sized for the largest run
+struct Buffers
+{
+	explicit Buffers(fpp_t frames) :
+		dst(frames),
+		src(frames),
+		silence(frames),
+		left(frames),
+		right(frames),
+		coeffs1(frames),
+		coeffs2(frames)
+	{
+		auto generator = std::minstd_rand{1};
+		auto noise = std::uniform_real_distribution<float>{-1.f, 1.f};
+		for (fpp_t frame = 0; frame < frames; ++frame)
+		{
+			dst[frame] = SampleFrame{noise(generator), noise(generator)};
+			src[frame] = SampleFrame{noise(generator), noise(generator)};
+			left[frame] = noise(generator);
+			right[frame] = noise(generator);
+		}
+		coeffs1.fill(0.5f);
+		coeffs2.interpolate(0.25f, 0.75f);
+	}
+
+	std::vector<SampleFrame> dst;
+	std::vector<SampleFrame> src;
+	std::vector<SampleFrame> silence;
+	std::vector<sample_t> left;
+	std::vector<sample_t> right;
+	ValueBuffer coeffs1;
+	ValueBuffer coeffs2;
+};
+
+
+void addMixHelpers(std::vector<Kernel>& kernels, Buffers& b)
+{
+	// the coefficients keep the destination bounded and away from denormals,
+	// which would dominate the timings otherwise
+	kernels.push_back({"MixHelpers::isSilent", [&b](fpp_t frames) {
+		s_sink = MixHelpers::isSilent(b.silence.data(), frames);
+	}});
+	kernels.push_back({"MixHelpers::sanitize", [&b](fpp_t frames) {
+		s_sink = MixHelpers::sanitize(b.dst.data(), frames);
+	}});
+	kernels.push_back({"MixHelpers::add", [&b](fpp_t frames) {
+		MixHelpers::add(b.dst.data(), b.src.data(), frames);
+	}});
+	kernels.push_back({"MixHelpers::multiply", [&b](fpp_t frames) {
+		MixHelpers::multiply(b.dst.data(), 1.f, frames);
+	}});
+	kernels.push_back({"MixHelpers::addMultiplied", [&b](fpp_t frames) {
+		MixHelpers::addMultiplied(b.dst.data(), b.src.data(), 0.5f, frames);
+	}});
+	kernels.push_back({"MixHelpers::addSwappedMultiplied", [&b](fpp_t frames) {
+		MixHelpers::addSwappedMultiplied(b.dst.data(), b.src.data(), 0.5f, frames);
+	}});
+	kernels.push_back({"MixHelpers::addMultipliedByBuffer", [&b](fpp_t frames) {
+		MixHelpers::addMultipliedByBuffer(b.dst.data(), b.src.data(), 0.5f, &b.coeffs1, frames);
+	}});
+	kernels.push_back({"MixHelpers::addMultipliedByBuffers", [&b](fpp_t frames) {
+		MixHelpers::addMultipliedByBuffers(b.dst.data(), b.src.data(), &b.coeffs1, &b.coeffs2, frames);
+	}});
+	kernels.push_back({"MixHelpers::addSanitizedMultiplied", [&b](fpp_t frames) {
+		MixHelpers::addSanitizedMultiplied(b.dst.data(), b.src.data(), 0.5f, frames);
+	}});
+	kernels.push_back({"MixHelpers::addSanitizedMultipliedByBuffer", [&b](fpp_t frames) {
+		MixHelpers::addSanitizedMultipliedByBuffer(b.dst.data(), b.src.data(), 0.5f, &b.coeffs1, frames);
+	}});
+	kernels.push_back({"MixHelpers::addSanitizedMultipliedByBuffers", [&b](fpp_t frames) {
+		MixHelpers::addSanitizedMultipliedByBuffers(b.dst.data(), b.src.data(), &b.coeffs1, &b.coeffs2, frames);
+	}});
+	kernels.push_back({"MixHelpers::addMultipliedStereo", [&b](fpp_t frames) {
+		MixHelpers::addMultipliedStereo(b.dst.data(), b.src.data(), 0.5f, 0.25f, frames);
+	}});
+	kernels.push_back({"MixHelpers::multiplyAndAddMultiplied", [&b](fpp_t frames) {
+		MixHelpers::multiplyAndAddMultiplied(b.dst.data(), b.src.data(), 0.5f, 0.5f, frames);
+	}});
+	kernels.push_back({"MixHelpers::multiplyAndAddMultipliedJoined", [&b](fpp_t frames) {
+		MixHelpers::multiplyAndAddMultipliedJoined(b.dst.data(), b.left.data(), b.right.data(), 0.5f, 0.5f, frames);
+	}});
+	kernels.push_back({"getAbsPeakValues", [&b](fpp_t frames) {
+		s_sink = getAbsPeakValues(b.src.data(), frames).left();
+	}});
+}
+
+
+
+
+//! An oscillator together with the models and parameters it refers to
+struct OscillatorSetup
+{
+	OscillatorSetup(Oscillator::WaveShape shape, Oscillator::ModulationAlgo algo, bool useWaveTable, bool withSubOsc) :
+		waveShape(static_cast<int>(shape), 0, static_cast<int>(Oscillator::NumWaveShapes) - 1),
+		subWaveShape(static_cast<int>(Oscillator::WaveShape::Sine), 0, static_cast<int>(Oscillator::NumWaveShapes) - 1),
+		modulationAlgo(static_cast<int>(algo), 0, static_cast<int>(Oscillator::NumModulationAlgos) - 1),
+		detuning(1.f / Engine::audioEngine()->outputSampleRate())
+	{
+		Oscillator* subOsc = withSubOsc
+			? new Oscillator(&subWaveShape, &modulationAlgo, subFrequency, detuning, phaseOffset, volume)
+			: nullptr;
+		oscillator = std::make_unique<Oscillator>(&waveShape, &modulationAlgo,
+			frequency, detuning, phaseOffset, volume, subOsc);
+		oscillator->setUseWaveTable(useWaveTable);
+
+		// a single cycle, like the waves loaded into TripleOscillator
+		auto cycle = std::vector<SampleFrame>(256);
+		for (std::size_t frame = 0; frame < cycle.size(); ++frame)
+		{
+			const auto value = Oscillator::moogSawSample(static_cast<float>(frame) / cycle.size());
+			cycle[frame] = SampleFrame{value, value};
+		}
+		auto userWave = std::make_shared<SampleBuffer>(std::move(cycle), Engine::audioEngine()->outputSampleRate());
+		if (useWaveTable)
+		{
+			oscillator->setUserAntiAliasWaveTable(Oscillator::generateAntiAliasUserWaveTable(userWave.get()));
+		}
+		oscillator->setUserWave(std::move(userWave));
+	}
+
+	IntModel waveShape;
+	IntModel subWaveShape;
+	IntModel modulationAlgo;
+	float frequency = 440.f;
+	float subFrequency = 220.f;
+	float detuning;
+	float phaseOffset = 0.f;
+	float volume = 1.f;
+	std::unique_ptr<Oscillator> oscillator;
+};
+
+
+void addOscillators(std::vector<Kernel>& kernels, Buffers& b)
+{
+	static constexpr const char* WaveShapeNames[] = {
+		"Sine", "Triangle", "Saw", "Square", "MoogSaw", "Exponential", "WhiteNoise", "UserDefined"
+	};
+	static_assert(std::size(WaveShapeNames) == Oscillator::NumWaveShapes);
+
+	static constexpr const char* ModulationAlgoNames[] = {
+		"PhaseModulation", "AmplitudeModulation", "SignalMix", "SynchronizedBySubOsc", "FrequencyModulation"
+	};
+	static_assert(std::size(ModulationAlgoNames) == Oscillator::NumModulationAlgos);
+
+	for (std::size_t shape = 0; shape < Oscillator::NumWaveShapes; ++shape)
+	{
+		for (bool useWaveTable : {false, true})
+		{
+			auto setup = std::make_shared<OscillatorSetup>(static_cast<Oscillator::WaveShape>(shape),
+				Oscillator::ModulationAlgo::PhaseModulation, useWaveTable, false);
+			kernels.push_back({std::string{"Oscillator::update "} + WaveShapeNames[shape]
+					+ (useWaveTable ? " wavetable" : ""),
+				[setup, &b](fpp_t frames) { setup->oscillator->update(b.dst.data(), frames, 0); }});
+		}
+	}
+
+	// modulate a saw with a sine sub oscillator
+	for (std::size_t algo = 0; algo < Oscillator::NumModulationAlgos; ++algo)
+	{
+		auto setup = std::make_shared<OscillatorSetup>(Oscillator::WaveShape::Saw,
+			static_cast<Oscillator::ModulationAlgo>(algo), false, true);
+		kernels.push_back({std::string{"Oscillator::update Saw "} + ModulationAlgoNames[algo],
+			[setup, &b](fpp_t frames) { setup->oscillator->update(b.dst.data(), frames, 0); }});
+	}
+}
+
+
+
+
+void addFilters(std::vector<Kernel>& kernels, Buffers& b)
+{
+	using FilterType = BasicFilters<>::FilterType;
+	static constexpr const char* FilterTypeNames[] = {
+		"LowPass", "HiPass", "BandPass_CSG", "BandPass_CZPG", "Notch", "AllPass", "Moog", "DoubleLowPass",
+		"Lowpass_RC12", "Bandpass_RC12", "Highpass_RC12", "Lowpass_RC24", "Bandpass_RC24", "Highpass_RC24",
+		"Formantfilter", "DoubleMoog", "Lowpass_SV", "Bandpass_SV", "Highpass_SV", "Notch_SV",
+		"FastFormant", "Tripole"
+	};
+	static_assert(std::size(FilterTypeNames) == static_cast<std::size_t>(FilterType::Tripole) + 1);
+
+	for (std::size_t type = 0; type < std::size(FilterTypeNames); ++type)
+	{
+		auto filter = std::make_shared<BasicFilters<>>(Engine::audioEngine()->outputSampleRate());
+		filter->setFilterType(static_cast<FilterType>(type));
+		filter->calcFilterCoeffs(1000.f, 0.5f);
+
+		kernels.push_back({std::string{"BasicFilters::update "} + FilterTypeNames[type],
+			[filter, &b](fpp_t frames) {
+				for (fpp_t frame = 0; frame < frames; ++frame)
+				{
+					b.dst[frame][0] = filter->update(b.src[frame][0], 0);
+				}
+			}});
+	}
+}
+
+
+
+
+void addSamples(std::vector<Kernel>& kernels, Buffers& b)
+{
+	static constexpr const char* LoopNames[] = {"Off", "On", "PingPong"};
+
+	const auto sampleRate = static_cast<int>(Engine::audioEngine()->outputSampleRate());
+	auto data = std::vector<SampleFrame>(sampleRate);
+	auto generator = std::minstd_rand{2};
+	auto noise = std::uniform_real_distribution<float>{-1.f, 1.f};
+	std::generate(data.begin(), data.end(), [&] { return SampleFrame{noise(generator), noise(generator)}; });
+
+	auto sample = std::make_shared<Sample>(std::make_shared<SampleBuffer>(std::move(data), sampleRate));
+	sample->setAllPointFrames(0, sample->sampleSize(), 0, sample->sampleSize());
+
+	for (float ratio : {1.f, 0.5f, 2.f, 1.5f})
+	{
+		for (auto loop : {Sample::Loop::Off, Sample::Loop::On, Sample::Loop::PingPong})
+		{
+			auto state = std::make_shared<Sample::PlaybackState>();
+			char name[64];
+			std::snprintf(name, sizeof(name), "Sample::play ratio %.2f loop %s",
+				ratio, LoopNames[static_cast<int>(loop)]);
+
+			kernels.push_back({name, [sample, state, ratio, loop, &b](fpp_t frames) {
+				if (!sample->play(b.dst.data(), state.get(), frames, DefaultBaseFreq * ratio, loop))
+				{
+					// start over when a non-looping sample has ended
+					state->setFrameIndex(0);
+				}
+			}});
+		}
+	}
+}
+
+
+
+
+void addResamplers(std::vector<Kernel>& kernels, Buffers& b)
+{
+	static constexpr const char* InterpolationNames[] = {
+		"SincBest", "SincMedium", "SincFastest", "ZeroOrderHold", "Linear"
+	};
+
+	for (int mode = SRC_SINC_BEST_QUALITY; mode <= SRC_LINEAR; ++mode)
+	{
+		// 44.1 kHz material played at 48 kHz, and two octaves around it
+		for (double ratio : {48000. / 44100., 0.5, 2.})
+		{
+			auto resampler = std::make_shared<AudioResampler>(mode, DEFAULT_CHANNELS);
+			char name[64];
+			std::snprintf(name, sizeof(name), "AudioResampler::resample %s ratio %.2f",
+				InterpolationNames[mode], ratio);
+
+			kernels.push_back({name, [resampler, ratio, mode, &b](fpp_t frames) {
+				// provide a little more input than needed, like Sample::play does
+				const auto input = std::min<long>(static_cast<long>(frames / ratio) + Sample::s_interpolationMargins[mode],
+					static_cast<long>(b.src.size()));
+				resampler->resample(b.src.data()->data(), input, b.dst.data()->data(), frames, ratio);
+			}});
+		}
+	}
+}
+
+
+Result measure(const Kernel& kernel, fpp_t frames, const Options& options)
+{
+	// warm up caches, branch predictors and lazily initialized state
+	for (int i = 0; i < 16; ++i) { kernel.run(frames); }
+
+	// batches of roughly 64k frames, short enough to be rarely preempted
+	const auto iterations = std::max<fpp_t>(1, 65536 / frames);
+	auto batches = std::vector<double>();
+	const auto deadline = Clock::now() + std::chrono::milliseconds{options.minTimeMs};
+
+	do
+	{
+		const auto begin = Clock::now();
+		for (fpp_t i = 0; i < iterations; ++i) { kernel.run(frames); }
+		const auto elapsed = std::chrono::duration<double, std::nano>(Clock::now() - begin).count();
+		batches.push_back(elapsed / (static_cast<double>(iterations) * frames));
+	}
+	while (Clock::now() < deadline || batches.size() < 3);
+
+	std::sort(batches.begin(), batches.end());
+	return Result{batches[batches.size() / 2], batches.front()};
+}
+
+
+void printResult(const Kernel& kernel, fpp_t frames, const Result& result)
+{
+	std::printf("{\"kernel\":\"%s\",\"frames\":%d,\"simd\":\"%s\",\"nsPerFrame\":%.3f,\"minNsPerFrame\":%.3f}\n",
+		kernel.name.c_str(), static_cast<int>(frames), SimdLevelNames[static_cast<int>(MixHelpers::simdLevel())],
+		result.nsPerFrame, result.minNsPerFrame);
+	std::fflush(stdout);
+}
+
+} // namespace
+
+
+int main(int argc, char** argv)
+{
+	auto options = Options{};
+	auto filters = std::vector<std::string>();
+
+	for (int i = 1; i < argc; ++i)
+	{
+		const auto arg = std::string{argv[i]};
+		int* value = arg == "--min-time" ? &options.minTimeMs
+			: arg == "--min-frames" ? &options.minFrames
+			: arg == "--max-frames" ? &options.maxFrames
+			: nullptr;
+
+		const auto simd = arg == "--simd" && i + 1 < argc
+			? std::find(std::begin(SimdLevelNames), std::end(SimdLevelNames), std::string{argv[++i]})
+			: std::end(SimdLevelNames);
+
+		if (value && i + 1 < argc)
+		{
+			*value = std::max(1, std::atoi(argv[++i]));
+		}
+		else if (simd != std::end(SimdLevelNames))
+		{
+			options.simd = static_cast<MixHelpers::SimdLevel>(simd - std::begin(SimdLevelNames));
+		}
+		else if (!value && arg.rfind("--", 0) != 0)
+		{
+			filters.push_back(arg);
+		}
+		else
+		{
+			std::fprintf(stderr, "usage: %s [FILTER]... [--min-time MS] [--min-frames N] [--max-frames N] "
+				"[--simd none|sse2|avx2|avx512]\n", argv[0]);
+			return EXIT_FAILURE;
+		}
+	}
+	MixHelpers::setSimdLevel(options.simd);
+
+	QCoreApplication app(argc, argv);
+	Engine::init(true);
+
+	// keep the engine from rendering in the background while measuring
+	AudioEngine* audioEngine = Engine::audioEngine();
+	bool success = false;
+	audioEngine->setAudioDevice(new AudioDummy(success, audioEngine),
+		audioEngine->currentQualitySettings(), false, false);
+
+	{
+		auto buffers = Buffers{static_cast<fpp_t>(options.maxFrames)};
+		auto kernels = std::vector<Kernel>();
+		addMixHelpers(kernels, buffers);
+		addOscillators(kernels, buffers);
+		addFilters(kernels, buffers);
+		addSamples(kernels, buffers);
+		addResamplers(kernels, buffers);
+
+		for (const auto& kernel : kernels)
+		{
+			const bool selected = filters.empty() || std::any_of(filters.begin(), filters.end(),
+				[&kernel](const std::string& filter) { return kernel.name.find(filter) != std::string::npos; });
+			if (!selected) { continue; }
+
+			for (int frames = options.minFrames; frames <= options.maxFrames; frames *= 2)
+			{
+				printResult(kernel, frames, measure(kernel, frames, options));
+			}
+		}
+	}
+
+	Engine::destroy();
+	return EXIT_SUCCESS;
+}
@@ -0,0 +1,368 @@
+/*
+ * RenderBenchmark.cpp - headless render benchmark (lmms-bench)
+ *
+ * This file is part of LMMS - https://lmms.io
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this program (see COPYING); if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301 USA.
+ *
+ */
+
+/*
+	Renders generated projects period by period through
+	AudioEngine::nextBuffer() and prints one JSON object per scenario:
+
+		lmms-bench [oscillators|sends|samples|automation|all]...
+			[--periods N] [--tracks N] [--voices N] [--depth N]
+
+	Instruments are loaded as plugins, so LMMS_PLUGIN_DIR may have to point
+	to the plugins of the build tree. Allocations are counted by replacing
+	the global operator new, so allocations done with malloc() directly,
+	e.g. by Qt containers, are not included.
+*/
+
+#include <QCoreApplication>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <new>
+#include <string>
+#include <vector>
+
+#include "AudioDummy.h"
+#include "AudioEngine.h"
+#include "AutomationClip.h"
+#include "AutomationTrack.h"
+#include "Engine.h"
+#include "InstrumentTrack.h"
+#include "MidiClip.h"
+#include "Mixer.h"
+#include "SampleBuffer.h"
+#include "SampleClip.h"
+#include "SampleTrack.h"
+#include "Song.h"
+
+namespace
+{
+
+std::atomic<std::uint64_t> s_allocations = 0;
+
+} // namespace
+
+
+void* operator new(std::size_t size)
+{
+	s_allocations.fetch_add(1, std::memory_order_relaxed);
+	if (void* ptr = std::malloc(size == 0 ? 1 : size)) { return ptr; }
+	throw std::bad_alloc{};
+}
+
+void* operator new[](std::size_t size) { return operator new(size); }
+void operator delete(void* ptr) noexcept { std::free(ptr); }
+void operator delete[](void* ptr) noexcept { std::free(ptr); }
+void operator delete(void* ptr, std::size_t) noexcept { std::free(ptr); }
+void operator delete[](void* ptr, std::size_t) noexcept { std::free(ptr); }
+
+
+namespace
+{
+
+using namespace lmms;
+
+struct Options
+{
+	int periods = 2000;
+	int warmup = 100;
+	int tracks = 16;
+	int voices = 8;
+	int depth = 16;
+};
+
+struct Result
+{
+	double periodsPerSecond;
+	double meanUs;
+	double p99Us;
+	double maxUs;
+	double allocationsPerPeriod;
+	double realtimeFactor;
+};
+
+
+int bars(const Options& options)
+{
+	const double frames = static_cast<double>(options.periods + options.warmup)
+		* Engine::audioEngine()->framesPerPeriod();
+	return static_cast<int>(frames / Engine::framesPerTick() / TimePos::ticksPerBar()) + 2;
+}
+
+
+void routeToChannel(IntModel* mixerChannelModel, int channel)
+{
+	mixerChannelModel->setRange(0, Engine::mixer()->numChannels() - 1);
+	mixerChannelModel->setValue(channel);
+}
+
+
+//! An instrument track playing chords of @p voices notes on every beat
+InstrumentTrack* addOscillatorTrack(const Options& options, int voices)
+{
+	auto track = dynamic_cast<InstrumentTrack*>(Track::create(Track::Type::Instrument, Engine::getSong()));
+	track->loadInstrument("tripleoscillator");
+	if (track->instrumentName() != "tripleoscillator")
+	{
+		std::fprintf(stderr, "TripleOscillator not found, check LMMS_PLUGIN_DIR\n");
+		std::exit(EXIT_FAILURE);
+	}
+
+	auto clip = dynamic_cast<MidiClip*>(track->createClip(TimePos{0}));
+	const int beat = TimePos::ticksPerBar() / 4;
+	for (int pos = 0; pos < bars(options) * TimePos::ticksPerBar(); pos += beat)
+	{
+		for (int voice = 0; voice < voices; ++voice)
+		{
+			clip->addNote(Note{TimePos{beat - 1}, TimePos{pos}, DefaultKey - 12 + voice * 3}, false);
+		}
+	}
+	return track;
+}
+
+
+void buildOscillators(const Options& options)
+{
+	for (int i = 0; i < options.tracks; ++i)
+	{
+		addOscillatorTrack(options, options.voices);
+	}
+}
+
+
+//! Tracks feeding a chain of mixer channels, each sending to the next one
+void buildSends(const Options& options)
+{
+	Mixer* mixer = Engine::mixer();
+	for (int i = 0; i < options.depth; ++i)
+	{
+		const int channel = mixer->createChannel();
+		if (channel > 1)
+		{
+			mixer->deleteChannelSend(channel - 1, 0);
+			mixer->createChannelSend(channel - 1, channel);
+		}
+	}
+
+	for (int i = 0; i < options.tracks; ++i)
+	{
+		routeToChannel(addOscillatorTrack(options, 1)->mixerChannelModel(), 1);
+	}
+}
+
+
+//! Long sample clips which have to be resampled to the output rate
+void buildSamples(const Options& options)
+{
+	const int sampleRate = 48000;
+	const auto length = static_cast<std::size_t>(sampleRate) * 10;
+
+	for (int i = 0; i < options.tracks; ++i)
+	{
+		auto data = std::vector<SampleFrame>(length);
+		for (std::size_t frame = 0; frame < length; ++frame)
+		{
+			const auto value = 0.5f * std::sin(static_cast<float>(frame) * (0.01f + 0.001f * i));
+			data[frame] = SampleFrame{value, -value};
+		}
+
+		auto track = Track::create(Track::Type::Sample, Engine::getSong());
+		auto clip = dynamic_cast<SampleClip*>(track->createClip(TimePos{0}));
+		clip->setSampleBuffer(std::make_shared<SampleBuffer>(std::move(data), sampleRate));
+		clip->changeLength(TimePos{bars(options) * TimePos::ticksPerBar()});
+	}
+}
+
+
+//! Tracks whose volume and panning change every few ticks
+void buildAutomation(const Options& options)
+{
+	for (int i = 0; i < options.tracks; ++i)
+	{
+		InstrumentTrack* instrumentTrack = addOscillatorTrack(options, 2);
+		for (AutomatableModel* model : {static_cast<AutomatableModel*>(instrumentTrack->volumeModel()),
+			static_cast<AutomatableModel*>(instrumentTrack->panningModel())})
+		{
+			auto track = Track::create(Track::Type::Automation, Engine::getSong());
+			auto clip = dynamic_cast<AutomationClip*>(track->createClip(TimePos{0}));
+			clip->addObject(model);
+			for (int pos = 0; pos < bars(options) * TimePos::ticksPerBar(); pos += 4)
+			{
+				const float amount = (pos / 4) % 2 ? 0.25f : 0.75f;
+				clip->putValue(TimePos{pos}, model->minValue<float>() + amount * model->range(), false);
+			}
+		}
+	}
+}
+
+
+Result render(const Options& options)
+{
+	AudioEngine* audioEngine = Engine::audioEngine();
+	Song* song = Engine::getSong();
+
+	song->startExport();
+	for (int i = 0; i < options.warmup; ++i)
+	{
+		audioEngine->nextBuffer();
+		audioEngine->releaseNextBuffer();
+	}
+
+	auto periodTimes = std::vector<double>();
+	periodTimes.reserve(options.periods);
+	const auto allocationsBefore = s_allocations.load();
+	const auto begin = std::chrono::steady_clock::now();
+
+	for (int i = 0; i < options.periods; ++i)
+	{
+		const auto periodBegin = std::chrono::steady_clock::now();
+		audioEngine->nextBuffer();
+		audioEngine->releaseNextBuffer();
+		periodTimes.push_back(std::chrono::duration<double, std::micro>(
+			std::chrono::steady_clock::now() - periodBegin).count());
+	}
+
+	const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+	const auto allocations = s_allocations.load() - allocationsBefore;
+	song->stopExport();
+
+	std::sort(periodTimes.begin(), periodTimes.end());
+	const auto p99 = static_cast<std::size_t>(std::ceil(0.99 * periodTimes.size())) - 1;
+	double sum = 0;
+	for (double time : periodTimes) { sum += time; }
+
+	const double periodSeconds = static_cast<double>(audioEngine->framesPerPeriod())
+		/ audioEngine->outputSampleRate();
+
+	return Result{
+		options.periods / seconds,
+		sum / periodTimes.size(),
+		periodTimes[p99],
+		periodTimes.back(),
+		static_cast<double>(allocations) / options.periods,
+		options.periods * periodSeconds / seconds
+	};
+}
+
+
+void printResult(const char* scenario, const Options& options, const Result& result)
+{
+	std::printf("{\"scenario\":\"%s\",\"tracks\":%d,\"voices\":%d,\"depth\":%d,"
+		"\"periods\":%d,\"framesPerPeriod\":%d,\"sampleRate\":%d,"
+		"\"periodsPerSecond\":%.1f,\"meanUs\":%.2f,\"p99Us\":%.2f,\"maxUs\":%.2f,"
+		"\"allocationsPerPeriod\":%.2f,\"realtimeFactor\":%.2f}\n",
+		scenario, options.tracks, options.voices, options.depth,
+		options.periods, static_cast<int>(Engine::audioEngine()->framesPerPeriod()),
+		static_cast<int>(Engine::audioEngine()->outputSampleRate()),
+		result.periodsPerSecond, result.meanUs, result.p99Us, result.maxUs,
+		result.allocationsPerPeriod, result.realtimeFactor);
+	std::fflush(stdout);
+}
+
+
+struct Scenario
+{
+	const char* name;
+	void (*build)(const Options&);
+};
+
+constexpr Scenario Scenarios[] = {
+	{"oscillators", buildOscillators},
+	{"sends", buildSends},
+	{"samples", buildSamples},
+	{"automation", buildAutomation},
+};
+
+} // namespace
+
+
+int main(int argc, char** argv)
+{
+	auto options = Options{};
+	auto selected = std::vector<std::string>();
+
+	for (int i = 1; i < argc; ++i)
+	{
+		const auto arg = std::string{argv[i]};
+		int* value = arg == "--periods" ? &options.periods
+			: arg == "--tracks" ? &options.tracks
+			: arg == "--voices" ? &options.voices
+			: arg == "--depth" ? &options.depth
+			: nullptr;
+
+		if (value && i + 1 < argc)
+		{
+			*value = std::max(1, std::atoi(argv[++i]));
+		}
+		else if (!value && arg.rfind("--", 0) != 0)
+		{
+			selected.push_back(arg);
+		}
+		else
+		{
+			std::fprintf(stderr, "usage: %s [oscillators|sends|samples|automation|all]... "
+				"[--periods N] [--tracks N] [--voices N] [--depth N]\n", argv[0]);
+			return EXIT_FAILURE;
+		}
+	}
+	if (selected.empty()) { selected.push_back("all"); }
+
+	QCoreApplication app(argc, argv);
+	Engine::init(true);
+
+	// render synchronously in this thread instead of the dummy device's
+	AudioEngine* audioEngine = Engine::audioEngine();
+	bool success = false;
+	audioEngine->setAudioDevice(new AudioDummy(success, audioEngine),
+		audioEngine->currentQualitySettings(), false, false);
+
+	int status = EXIT_SUCCESS;
+	for (const auto& name : selected)
+	{
+		bool found = false;
+		for (const auto& scenario : Scenarios)
+		{
+			if (name != "all" && name != scenario.name) { continue; }
+			found = true;
+
+			Engine::getSong()->clearProject();
+			scenario.build(options);
+			printResult(scenario.name, options, render(options));
+		}
+
+		if (!found)
+		{
+			std::fprintf(stderr, "unknown scenario %s\n", name.c_str());
+			status = EXIT_FAILURE;
+		}
+	}
+
+	Engine::getSong()->clearProject();
+	Engine::destroy();
+	return status;
+}
@@ -0,0 +1,171 @@
+/*
+ * AudioEngineProfilerTest.cpp
+ *
+ * This file is part of LMMS - https://lmms.io
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this program (see COPYING); if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301 USA.
+ *
+ */
+
+#include "AudioEngineProfiler.h"
+
+#include <QObject>
+#include <QtTest/QtTest>
+#include <chrono>
+#include <thread>
+
+#include "CpuTimeCounter.h"
+
+using lmms::AudioEngineProfiler;
+using lmms::CpuTimeCounter;
+using namespace std::chrono_literals;
+
+class AudioEngineProfilerTest : public QObject
+{
+	Q_OBJECT
+
+	// 441 frames at 44100 Hz give a budget of exactly 10 ms per period
+	static constexpr lmms::sample_rate_t SampleRate = 44100;
+	static constexpr lmms::fpp_t PeriodFrames = 441;
+
+	//! Renders a period in which \a counter spent \a time
+	static void renderPeriod(AudioEngineProfiler& profiler, CpuTimeCounter& counter, CpuTimeCounter::Clock::duration time)
+	{
+		profiler.startPeriod();
+		counter.add(time);
+		profiler.finishPeriod(SampleRate, PeriodFrames);
+	}
+
+private slots:
+	void counterTest()
+	{
+		auto counter = CpuTimeCounter{};
+		QCOMPARE(counter.nanoseconds(), std::uint64_t{0});
+
+		counter.add(3ms);
+		counter.add(250us);
+		QCOMPARE(counter.nanoseconds(), std::uint64_t{3250000});
+
+		{
+			const auto scope = CpuTimeCounter::Scope{counter};
+			std::this_thread::sleep_for(1ms);
+		}
+		QVERIFY(counter.nanoseconds() >= 4250000);
+	}
+
+	void renderedBudgetTest()
+	{
+		auto profiler = AudioEngineProfiler{};
+		QCOMPARE(profiler.renderedNanoseconds(), std::uint64_t{0});
+		profiler.finishPeriod(SampleRate, PeriodFrames);
+		profiler.finishPeriod(SampleRate, PeriodFrames);
+		QCOMPARE(profiler.renderedNanoseconds(), std::uint64_t{20000000});
+	}
+
+	void firstUpdateOnlyStartsTest()
+	{
+		auto profiler = AudioEngineProfiler{};
+		auto counter = CpuTimeCounter{};
+		auto meter = AudioEngineProfiler::LoadMeter{};
+
+		// the time spent before the meter was created doesn't count
+		renderPeriod(profiler, counter, 10ms);
+		QCOMPARE(meter.update(profiler, counter), 0);
+
+		renderPeriod(profiler, counter, 0ms);
+		QCOMPARE(meter.update(profiler, counter), 0);
+	}
+
+	void loadIsSmoothedTest()
+	{
+		auto profiler = AudioEngineProfiler{};
+		auto counter = CpuTimeCounter{};
+		auto meter = AudioEngineProfiler::LoadMeter{};
+		meter.update(profiler, counter);
+
+		// half of the budget: 50% * 0.25, then 12.5% + 50% * 0.25 * 0.75, ...
+		renderPeriod(profiler, counter, 5ms);
+		QCOMPARE(meter.update(profiler, counter), 12);
+		renderPeriod(profiler, counter, 5ms);
+		QCOMPARE(meter.update(profiler, counter), 21);
+		renderPeriod(profiler, counter, 5ms);
+		QCOMPARE(meter.update(profiler, counter), 28);
+
+		for (int i = 0; i < 100; ++i)
+		{
+			renderPeriod(profiler, counter, 5ms);
+			meter.update(profiler, counter);
+		}
+		QVERIFY(meter.load() >= 49 && meter.load() <= 50);
+
+		// several periods between two updates count as one
+		for (int i = 0; i < 4; ++i) { renderPeriod(profiler, counter, 0ms); }
+		QCOMPARE(meter.update(profiler, counter), 37);
+	}
+
+	void loadAboveBudgetTest()
+	{
+		auto profiler = AudioEngineProfiler{};
+		auto counter = CpuTimeCounter{};
+		auto meter = AudioEngineProfiler::LoadMeter{};
+		meter.update(profiler, counter);
+
+		// with several worker threads, more time than the budget can be spent
+		for (int i = 0; i < 100; ++i)
+		{
+			renderPeriod(profiler, counter, 25ms);
+			meter.update(profiler, counter);
+		}
+		QVERIFY(meter.load() >= 249 && meter.load() <= 250);
+	}
+
+	void loadIsKeptWithoutPeriodsTest()
+	{
+		auto profiler = AudioEngineProfiler{};
+		auto counter = CpuTimeCounter{};
+		auto meter = AudioEngineProfiler::LoadMeter{};
+		meter.update(profiler, counter);
+
+		renderPeriod(profiler, counter, 5ms);
+		QCOMPARE(meter.update(profiler, counter), 12);
+
+		// e.g. while the audio engine is stopped
+		QCOMPARE(meter.update(profiler, counter), 12);
+		QCOMPARE(meter.update(profiler, counter), 12);
+
+		// time added before a period is finished counts towards it once it is
+		counter.add(3ms);
+		QCOMPARE(meter.update(profiler, counter), 12);
+		renderPeriod(profiler, counter, 2ms);
+		QCOMPARE(meter.update(profiler, counter), 21);
+	}
+
+	void largeTotalsTest()
+	{
+		auto profiler = AudioEngineProfiler{};
+		auto counter = CpuTimeCounter{};
+		auto meter = AudioEngineProfiler::LoadMeter{};
+
+		// only the differences between two readings matter, however long the counter ran
+		counter.add(std::chrono::hours{24 * 365});
+		meter.update(profiler, counter);
+		renderPeriod(profiler, counter, 5ms);
+		QCOMPARE(meter.update(profiler, counter), 12);
+	}
+};
+
+QTEST_GUILESS_MAIN(AudioEngineProfilerTest)
+#include "AudioEngineProfilerTest.moc"
@@ -24,9 +24,13 @@
 
 
 #include <QtTest/QtTest>
+#include <thread>
+#include <vector>
+
 #include "AutomatableModel.h"
 #include "ComboBoxModel.h"
 #include "Engine.h"
+#include "ValueBufferPool.h"
 
 class AutomatableModelTest : public QObject
 {
@@ -114,6 +118,54 @@ private slots: // tests
 		QVERIFY(m2.value());
 		QVERIFY(!m3.value());
 	}
+
+	void ValueBufferTests()
+	{
+		using namespace lmms;
+
+		FloatModel model(0.f, 0.f, 1.f, 0.f);
+		AutomatableModel::incrementPeriodCounter();
+		model.valueBuffer();
+
+		// no changes, no data
+		AutomatableModel::incrementPeriodCounter();
+		QVERIFY(model.valueBuffer() == nullptr);
+
+		// a change is ramped to within one period, and cached for it
+		const auto buffersInUse = ValueBufferPool::statistics().inUse;
+		model.setValue(1.f);
+		AutomatableModel::incrementPeriodCounter();
+		const ValueBuffer* ramp = model.valueBuffer();
+		QVERIFY(ramp != nullptr);
+		QCOMPARE(ValueBufferPool::statistics().inUse, buffersInUse + 1);
+		QCOMPARE(ramp->value(0), 0.f);
+		QVERIFY(ramp->value(ramp->length() - 1) > 0.9f);
+		model.setValue(0.5f);
+		QVERIFY(model.valueBuffer() == ramp);
+		QVERIFY(ramp->value(ramp->length() - 1) > 0.9f);
+
+		AutomatableModel::incrementPeriodCounter();
+		QCOMPARE(model.valueBuffer()->value(0), 1.f);
+		AutomatableModel::incrementPeriodCounter();
+		QVERIFY(model.valueBuffer() == nullptr);
+		QCOMPARE(ValueBufferPool::statistics().inUse, buffersInUse);
+
+		// concurrent callers share the buffer of the period
+		model.setValue(0.f);
+		AutomatableModel::incrementPeriodCounter();
+		auto results = std::vector<ValueBuffer*>(8);
+		auto threads = std::vector<std::thread>{};
+		for (auto& result : results)
+		{
+			threads.emplace_back([&] { result = model.valueBuffer(); });
+		}
+		for (auto& thread : threads) { thread.join(); }
+		for (auto result : results)
+		{
+			QCOMPARE(result, results[0]);
+			QVERIFY(result != nullptr);
+		}
+	}
 };
 
 QTEST_GUILESS_MAIN(AutomatableModelTest)
@@ -0,0 +1,189 @@
+/*
+ * EnvelopeAndLfoParametersTest.cpp
+ *
+ * This file is part of LMMS - https://lmms.io
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this program (see COPYING); if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301 USA.
+ *
+ */
+
+#include <QDomDocument>
+#include <QtTest/QtTest>
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+#include "AudioEngine.h"
+#include "Engine.h"
+#include "EnvelopeAndLfoParameters.h"
+
+namespace lmms {
+extern const float SECS_PER_ENV_SEGMENT;
+}
+
+using lmms::EnvelopeAndLfoParameters;
+using lmms::f_cnt_t;
+using lmms::fpp_t;
+
+namespace {
+
+//! The envelope as it was evaluated frame by frame from tables before it was
+//! described by its linear pieces
+class TableEnvelope
+{
+public:
+	TableEnvelope(const EnvelopeAndLfoParameters& params, float valueForZeroAmount)
+	{
+		const auto expKnobVal = &EnvelopeAndLfoParameters::expKnobVal;
+		const float framesPerEnvSeg = lmms::SECS_PER_ENV_SEGMENT * lmms::Engine::audioEngine()->outputSampleRate();
+		const float sustain = params.getSustainModel().value();
+		const float amount = params.getAmountModel().value();
+		const float amountAdd = amount >= 0 ? (1.0f - amount) * valueForZeroAmount : valueForZeroAmount;
+
+		const auto predelayFrames = static_cast<f_cnt_t>(framesPerEnvSeg * expKnobVal(params.getPredelayModel().value()));
+		const auto attackFrames = std::max<f_cnt_t>(1,
+			static_cast<f_cnt_t>(framesPerEnvSeg * expKnobVal(params.getAttackModel().value())));
+		const auto holdFrames = static_cast<f_cnt_t>(framesPerEnvSeg * expKnobVal(params.getHoldModel().value()));
+		const auto decayFrames = std::max<f_cnt_t>(1,
+			static_cast<f_cnt_t>(framesPerEnvSeg * expKnobVal(params.getDecayModel().value() * (1 - sustain))));
+		auto releaseFrames = std::max<f_cnt_t>(1,
+			static_cast<f_cnt_t>(framesPerEnvSeg * expKnobVal(params.getReleaseModel().value())));
+		if (static_cast<int>(std::floor(amount * 1000.0f)) == 0) { releaseFrames = 1; }
+
+		for (f_cnt_t i = 0; i < predelayFrames; ++i) { m_pahd.push_back(amountAdd); }
+		const float afI = (1.0f / attackFrames) * amount;
+		for (f_cnt_t i = 0; i < attackFrames; ++i) { m_pahd.push_back(i * afI + amountAdd); }
+		const float amsum = amount + amountAdd;
+		for (f_cnt_t i = 0; i < holdFrames; ++i) { m_pahd.push_back(amsum); }
+		const float dfI = (1.0 / decayFrames) * (sustain - 1) * amount;
+		for (f_cnt_t i = 0; i < decayFrames; ++i) { m_pahd.push_back(amsum + i * dfI); }
+
+		const float rfI = (1.0f / releaseFrames) * amount;
+		for (f_cnt_t i = 0; i < releaseFrames; ++i) { m_release.push_back(static_cast<float>(releaseFrames - i) * rfI); }
+
+		m_sustainLevel = sustain * amount + amountAdd;
+	}
+
+	float level(f_cnt_t frame, f_cnt_t releaseBegin) const
+	{
+		if (frame < releaseBegin) { return frame < m_pahd.size() ? m_pahd[frame] : m_sustainLevel; }
+		if (frame - releaseBegin < m_release.size())
+		{
+			return m_release[frame - releaseBegin]
+				* (releaseBegin < m_pahd.size() ? m_pahd[releaseBegin] : m_sustainLevel);
+		}
+		return 0.0f;
+	}
+
+	f_cnt_t pahdFrames() const { return m_pahd.size(); }
+	f_cnt_t frames() const { return m_pahd.size() + m_release.size(); }
+
+private:
+	std::vector<float> m_pahd;
+	std::vector<float> m_release;
+	float m_sustainLevel;
+};
+
+} // namespace
+
+class EnvelopeAndLfoParametersTest : public QObject
+{
+	Q_OBJECT
+
+	static constexpr float ValueForZeroAmount = 0.5f;
+
+	//! Sets the envelope knobs the way a project would, the LFO stays off
+	static void load(EnvelopeAndLfoParameters& params, float predelay, float attack, float hold,
+		float decay, float sustain, float release, float amount)
+	{
+		auto doc = QDomDocument{};
+		auto element = doc.createElement(params.nodeName());
+		params.saveSettings(doc, element);
+		element.setAttribute("pdel", predelay);
+		element.setAttribute("att", attack);
+		element.setAttribute("hold", hold);
+		element.setAttribute("dec", decay);
+		element.setAttribute("sustain", sustain);
+		element.setAttribute("rel", release);
+		element.setAttribute("amt", amount);
+		params.loadSettings(element);
+	}
+
+	//! Compares the envelope rendered in periods of \a periodFrames to the tables
+	static void compare(EnvelopeAndLfoParameters& params, f_cnt_t releaseBegin, fpp_t periodFrames)
+	{
+		const auto table = TableEnvelope{params, ValueForZeroAmount};
+		const auto frames = releaseBegin + table.frames() + periodFrames;
+
+		auto buf = std::vector<float>(periodFrames);
+		for (f_cnt_t frame = 0; frame < frames; frame += periodFrames)
+		{
+			params.fillLevel(buf.data(), frame, releaseBegin, periodFrames);
+			for (fpp_t offset = 0; offset < periodFrames; ++offset)
+			{
+				const float expected = table.level(frame + offset, releaseBegin);
+				// bit-identical, not just close
+				QVERIFY2(buf[offset] == expected, qPrintable(QString{"frame %1 (release at %2): %3 != %4"}
+					.arg(frame + offset).arg(releaseBegin).arg(buf[offset]).arg(expected)));
+			}
+		}
+	}
+
+private slots:
+	void initTestCase()
+	{
+		lmms::Engine::init(true);
+	}
+
+	void cleanupTestCase()
+	{
+		lmms::Engine::destroy();
+	}
+
+	void segmentsMatchTablesTest()
+	{
+		auto params = EnvelopeAndLfoParameters{ValueForZeroAmount, nullptr};
+
+		// a few hundred frames per segment, negative amounts and single frame segments
+		const float settings[][7] = {
+			{0.03f, 0.04f, 0.02f, 0.05f, 0.4f, 0.06f, 1.0f},
+			{0.0f, 0.0f, 0.0f, 0.0f, 0.7f, 0.0f, 1.0f},
+			{0.01f, 0.05f, 0.0f, 0.03f, 0.0f, 0.04f, -0.6f},
+			{0.0f, 0.02f, 0.03f, 0.04f, 1.0f, 0.05f, 0.35f},
+			{0.02f, 0.03f, 0.01f, 0.02f, 0.5f, 0.03f, 0.0f},
+		};
+
+		for (const auto& s : settings)
+		{
+			load(params, s[0], s[1], s[2], s[3], s[4], s[5], s[6]);
+			const auto pahdFrames = TableEnvelope{params, ValueForZeroAmount}.pahdFrames();
+
+			// released before, in and after each piece, rendered in periods shorter and longer than a chunk
+			for (const f_cnt_t releaseBegin : {f_cnt_t{0}, f_cnt_t{1}, pahdFrames / 5, pahdFrames / 2,
+				pahdFrames - 1, pahdFrames, pahdFrames + 333})
+			{
+				for (const fpp_t periodFrames : {fpp_t{64}, fpp_t{256}, fpp_t{1000}})
+				{
+					compare(params, releaseBegin, periodFrames);
+					if (QTest::currentTestFailed()) { return; }
+				}
+			}
+		}
+	}
+};
+
+QTEST_GUILESS_MAIN(EnvelopeAndLfoParametersTest)
+#include "EnvelopeAndLfoParametersTest.moc"
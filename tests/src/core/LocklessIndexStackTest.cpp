@@ -0,0 +1,97 @@
+/*
+ * LocklessIndexStackTest.cpp
+ *
+ * This file is part of LMMS - https://lmms.io
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this program (see COPYING); if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301 USA.
+ *
+ */
+
+#include "LocklessIndexStack.h"
+
+#include <QObject>
+#include <QtTest/QtTest>
+#include <thread>
+#include <vector>
+
+using lmms::LocklessIndexStack;
+
+class LocklessIndexStackTest : public QObject
+{
+	Q_OBJECT
+private slots:
+	void emptyTest()
+	{
+		auto stack = LocklessIndexStack{4};
+		QCOMPARE(stack.size(), std::size_t{0});
+		QCOMPARE(stack.pop(), LocklessIndexStack::Empty);
+	}
+
+	void lifoOrderTest()
+	{
+		auto stack = LocklessIndexStack{4};
+		stack.push(2);
+		stack.push(0);
+		stack.push(3);
+		QCOMPARE(stack.size(), std::size_t{3});
+		QCOMPARE(stack.pop(), 3u);
+		QCOMPARE(stack.pop(), 0u);
+		QCOMPARE(stack.pop(), 2u);
+		QCOMPARE(stack.pop(), LocklessIndexStack::Empty);
+	}
+
+	void concurrentTest()
+	{
+		// all threads keep popping and pushing back indices - no index may
+		// ever be owned by two threads at once, and none may get lost
+		constexpr auto NumIndices = std::uint32_t{64};
+		constexpr auto NumThreads = 4;
+		auto stack = LocklessIndexStack{NumIndices};
+		for (auto i = std::uint32_t{0}; i < NumIndices; ++i) { stack.push(i); }
+
+		auto owners = std::vector<std::atomic<int>>(NumIndices);
+		auto failed = std::atomic<bool>{false};
+		auto threads = std::vector<std::thread>{};
+		for (auto t = 0; t < NumThreads; ++t)
+		{
+			threads.emplace_back([&] {
+				for (auto i = 0; i < 100000; ++i)
+				{
+					const auto index = stack.pop();
+					if (index == LocklessIndexStack::Empty) { continue; }
+					if (owners[index]++ != 0) { failed = true; }
+					--owners[index];
+					stack.push(index);
+				}
+			});
+		}
+		for (auto& thread : threads) { thread.join(); }
+
+		QVERIFY(!failed);
+		QCOMPARE(stack.size(), std::size_t{NumIndices});
+		auto seen = std::vector<bool>(NumIndices, false);
+		for (auto i = std::uint32_t{0}; i < NumIndices; ++i)
+		{
+			const auto index = stack.pop();
+			QVERIFY(index < NumIndices);
+			QVERIFY(!seen[index]);
+			seen[index] = true;
+		}
+	}
+};
+
+QTEST_GUILESS_MAIN(LocklessIndexStackTest)
+#include "LocklessIndexStackTest.moc"
@@ -0,0 +1,117 @@
+/*
+ * MappedCacheTest.cpp
+ *
+ * This file is part of LMMS - https://lmms.io
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this program (see COPYING); if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301 USA.
+ *
+ */
+
+#include "MappedCache.h"
+
+#include <QFile>
+#include <QObject>
+#include <QStandardPaths>
+#include <QtTest/QtTest>
+#include <array>
+
+#include "ConfigManager.h"
+#include "lmmsconfig.h"
+
+using lmms::ConfigManager;
+using lmms::MappedCache;
+
+class MappedCacheTest : public QObject
+{
+	Q_OBJECT
+	using Table = std::array<float, 1000>;
+
+	//! Every test uses its own file, since a mapped file cannot be replaced on all platforms
+	static QString fileName()
+	{
+		return QStringLiteral("mapped-cache-test-%1.bin").arg(QTest::currentTestFunction());
+	}
+
+	static Table ramp(float offset)
+	{
+		auto table = Table{};
+		for (auto i = std::size_t{0}; i < table.size(); ++i) { table[i] = offset + static_cast<float>(i); }
+		return table;
+	}
+
+private slots:
+	void initTestCase()
+	{
+		// keep the user's cache directory out of this
+		QStandardPaths::setTestModeEnabled(true);
+	}
+
+	void init()
+	{
+		QFile::remove(ConfigManager::inst()->cacheDir() + fileName());
+	}
+
+	void storeAndMapTest()
+	{
+		QVERIFY(MappedCache::map<Table>(fileName(), 1) == nullptr);
+
+		QVERIFY(MappedCache::store(fileName(), 1, ramp(0.f)));
+		const auto* mapped = MappedCache::map<Table>(fileName(), 1);
+		QVERIFY(mapped != nullptr);
+		QVERIFY(*mapped == ramp(0.f));
+		QCOMPARE(reinterpret_cast<std::uintptr_t>(mapped) % 16, std::uintptr_t{0});
+	}
+
+	void mismatchTest()
+	{
+		QVERIFY(MappedCache::store(fileName(), 1, ramp(0.f)));
+		QVERIFY(MappedCache::map<Table>(fileName(), 2) == nullptr);
+		QVERIFY(MappedCache::map<std::array<float, 999>>(fileName(), 1) == nullptr);
+	}
+
+	void parametersTest()
+	{
+		using Parameters = std::array<std::int32_t, 3>;
+		QVERIFY(MappedCache::store(fileName(), 1, ramp(0.f), Parameters{256, 128, 4}));
+
+		const auto* mapped = MappedCache::map<Table>(fileName(), 1, Parameters{256, 128, 4});
+		QVERIFY(mapped != nullptr);
+		QVERIFY(*mapped == ramp(0.f));
+		QCOMPARE(reinterpret_cast<std::uintptr_t>(mapped) % 16, std::uintptr_t{0});
+
+		QVERIFY(MappedCache::map<Table>(fileName(), 1, Parameters{256, 64, 4}) == nullptr);
+		QVERIFY(MappedCache::map<Table>(fileName(), 1, std::array<std::int32_t, 2>{256, 128}) == nullptr);
+		QVERIFY(MappedCache::map<Table>(fileName(), 1) == nullptr);
+	}
+
+	void replaceTest()
+	{
+#ifdef LMMS_BUILD_WIN32
+		QSKIP("Windows does not replace files that are mapped");
+#endif
+		QVERIFY(MappedCache::store(fileName(), 1, ramp(0.f)));
+		const auto* first = MappedCache::map<Table>(fileName(), 1);
+		QVERIFY(first != nullptr);
+
+		// the file is replaced, not overwritten, so existing mappings keep their contents
+		QVERIFY(MappedCache::store(fileName(), 1, ramp(1.f)));
+		QVERIFY(*first == ramp(0.f));
+		QVERIFY(*MappedCache::map<Table>(fileName(), 1) == ramp(1.f));
+	}
+};
+
+QTEST_GUILESS_MAIN(MappedCacheTest)
+#include "MappedCacheTest.moc"
@@ -0,0 +1,210 @@
+/*
+ * MixHelpersTest.cpp
+ *
+ * This file is part of LMMS - https://lmms.io
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this program (see COPYING); if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301 USA.
+ *
+ */
+
+#include "MixHelpers.h"
+
+#include <QObject>
+#include <QtTest/QtTest>
+#include <cstring>
+#include <limits>
+#include <random>
+#include <vector>
+
+#include "SampleFrame.h"
+#include "ValueBuffer.h"
+
+using namespace lmms;
+using MixHelpers::SimdLevel;
+
+namespace
+{
+
+// odd sizes and sizes around the vector widths, to cover the scalar tails
+constexpr int FrameCounts[] = {0, 1, 2, 3, 4, 7, 8, 9, 15, 16, 17, 64, 255, 256};
+
+std::vector<SampleFrame> noise(int frames, float amplitude, unsigned seed)
+{
+	auto generator = std::minstd_rand{seed};
+	auto distribution = std::uniform_real_distribution<float>{-amplitude, amplitude};
+	auto buffer = std::vector<SampleFrame>(frames);
+	for (auto& frame : buffer)
+	{
+		frame = SampleFrame{distribution(generator), distribution(generator)};
+	}
+	return buffer;
+}
+
+bool identical(const std::vector<SampleFrame>& a, const std::vector<SampleFrame>& b)
+{
+	return a.size() == b.size()
+		&& (a.empty() || std::memcmp(a.data(), b.data(), a.size() * sizeof(SampleFrame)) == 0);
+}
+
+//! Runs @p function with the scalar implementation and with @p level and
+//! compares the resulting buffers bit by bit
+template<typename Function>
+void compare(SimdLevel level, Function function)
+{
+	MixHelpers::setSimdLevel(SimdLevel::None);
+	const auto expected = function();
+	MixHelpers::setSimdLevel(level);
+	const auto actual = function();
+	QVERIFY(identical(expected, actual));
+}
+
+} // namespace
+
+class MixHelpersTest : public QObject
+{
+	Q_OBJECT
+private slots:
+	void init()
+	{
+		MixHelpers::setNaNHandler(true);
+	}
+
+	void cleanup()
+	{
+		MixHelpers::setSimdLevel(MixHelpers::supportedSimdLevel());
+		MixHelpers::setNaNHandler(false);
+	}
+
+	void setSimdLevelTest()
+	{
+		QCOMPARE(MixHelpers::simdLevel(), MixHelpers::supportedSimdLevel());
+
+		MixHelpers::setSimdLevel(SimdLevel::None);
+		QCOMPARE(MixHelpers::simdLevel(), SimdLevel::None);
+
+		// levels the CPU does not support are never selected
+		MixHelpers::setSimdLevel(SimdLevel::Avx512);
+		QCOMPARE(MixHelpers::simdLevel(), MixHelpers::supportedSimdLevel());
+	}
+
+	void mixTest()
+	{
+		for (auto level = SimdLevel::Sse2; level <= MixHelpers::supportedSimdLevel();
+			level = static_cast<SimdLevel>(static_cast<int>(level) + 1))
+		{
+			for (int frames : FrameCounts)
+			{
+				const auto dst = noise(frames, 1.f, 1);
+				const auto src = noise(frames, 1.f, 2);
+				auto coeffs1 = ValueBuffer(frames);
+				auto coeffs2 = ValueBuffer(frames);
+				for (int f = 0; f < frames; ++f)
+				{
+					coeffs1.values()[f] = 0.5f + 0.01f * f;
+					coeffs2.values()[f] = 1.5f - 0.01f * f;
+				}
+
+				compare(level, [&] { auto d = dst; MixHelpers::add(d.data(), src.data(), frames); return d; });
+				compare(level, [&] { auto d = dst; MixHelpers::multiply(d.data(), 0.3f, frames); return d; });
+				compare(level, [&] {
+					auto d = dst;
+					MixHelpers::addMultiplied(d.data(), src.data(), 0.7f, frames);
+					return d;
+				});
+				compare(level, [&] {
+					auto d = dst;
+					MixHelpers::addMultipliedByBuffers(d.data(), src.data(), &coeffs1, &coeffs2, frames);
+					return d;
+				});
+			}
+		}
+	}
+
+	void sanitizeTest()
+	{
+		constexpr float Bad[] = {std::numeric_limits<float>::infinity(),
+			-std::numeric_limits<float>::infinity(), std::numeric_limits<float>::quiet_NaN()};
+
+		for (auto level = SimdLevel::Sse2; level <= MixHelpers::supportedSimdLevel();
+			level = static_cast<SimdLevel>(static_cast<int>(level) + 1))
+		{
+			for (int frames : FrameCounts)
+			{
+				const auto dst = noise(frames, 1.f, 3);
+				auto coeffs1 = ValueBuffer(frames);
+				auto coeffs2 = ValueBuffer(frames);
+				coeffs1.fill(0.5f);
+				coeffs2.interpolate(0.f, 1.f);
+
+				// clean input, then a bad sample at every position
+				for (int bad = -1; bad < frames * 2; ++bad)
+				{
+					// values beyond the limit of sanitize() get clamped
+					auto src = noise(frames, 2000.f, 4);
+					if (bad >= 0) { src[bad / 2][bad % 2] = Bad[bad % 3]; }
+
+					auto expected = src;
+					MixHelpers::setSimdLevel(SimdLevel::None);
+					const bool expectedResult = MixHelpers::sanitize(expected.data(), frames);
+					auto actual = src;
+					MixHelpers::setSimdLevel(level);
+					QCOMPARE(MixHelpers::sanitize(actual.data(), frames), expectedResult);
+					QCOMPARE(expectedResult, bad >= 0);
+					QVERIFY(identical(expected, actual));
+
+					compare(level, [&] {
+						auto d = dst;
+						MixHelpers::addSanitizedMultiplied(d.data(), src.data(), 0.7f, frames);
+						return d;
+					});
+					compare(level, [&] {
+						auto d = dst;
+						MixHelpers::addSanitizedMultipliedByBuffers(d.data(), src.data(), &coeffs1, &coeffs2, frames);
+						return d;
+					});
+				}
+			}
+		}
+	}
+
+	void isSilentTest()
+	{
+		for (auto level = SimdLevel::Sse2; level <= MixHelpers::supportedSimdLevel();
+			level = static_cast<SimdLevel>(static_cast<int>(level) + 1))
+		{
+			MixHelpers::setSimdLevel(level);
+			for (int frames : FrameCounts)
+			{
+				auto buffer = std::vector<SampleFrame>(frames, SampleFrame{0.00000001f, -0.00000001f});
+				QVERIFY(MixHelpers::isSilent(buffer.data(), frames));
+
+				for (int loud = 0; loud < frames * 2; ++loud)
+				{
+					auto b = buffer;
+					b[loud / 2][loud % 2] = loud % 2 ? 0.0000001f : -0.0000001f;
+					QVERIFY(!MixHelpers::isSilent(b.data(), frames));
+
+					// NaNs are no sound, like in the scalar implementation
+					b[loud / 2][loud % 2] = std::numeric_limits<float>::quiet_NaN();
+					QVERIFY(MixHelpers::isSilent(b.data(), frames));
+				}
+			}
+		}
+	}
+};
+
+QTEST_GUILESS_MAIN(MixHelpersTest)
+#include "MixHelpersTest.moc"
@@ -0,0 +1,384 @@
+/*
+ * OscillatorTest.cpp
+ *
+ * This file is part of LMMS - https://lmms.io
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this program (see COPYING); if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301 USA.
+ *
+ */
+
+#include <QtTest/QtTest>
+#include <array>
+#include <cmath>
+#include <cstdlib>
+#include <memory>
+#include <optional>
+#include <vector>
+
+#include "AudioEngine.h"
+#include "AutomatableModel.h"
+#include "Engine.h"
+#include "Oscillator.h"
+#include "SampleBuffer.h"
+#include "interpolation.h"
+#include "lmms_math.h"
+
+using lmms::Engine;
+using lmms::fpp_t;
+using lmms::IntModel;
+using lmms::Oscillator;
+using lmms::SampleBuffer;
+using lmms::SampleFrame;
+using lmms::sample_t;
+namespace OscillatorConstants = lmms::OscillatorConstants;
+
+class OscillatorTest : public QObject
+{
+	Q_OBJECT
+
+	using WaveShape = Oscillator::WaveShape;
+	using ModulationAlgo = Oscillator::ModulationAlgo;
+
+	static constexpr int NumOscillators = 3;
+	static constexpr fpp_t Frames = 4096;
+
+	//! The knobs of one oscillator in TripleOscillator
+	struct Settings
+	{
+		WaveShape waveShape;
+		//! How the next oscillator modulates this one
+		ModulationAlgo modulationAlgo;
+		//! Factor of the note frequency
+		float detuning;
+		float phaseOffset;
+		float volume;
+		bool useWaveTable;
+	};
+
+	struct Patch
+	{
+		const char* name;
+		std::array<Settings, NumOscillators> oscillators;
+	};
+
+	//! Oscillator as it rendered one frame after another, before it rendered in blocks
+	class FrameOscillator
+	{
+	public:
+		// Sub oscillators are never owned here
+		FrameOscillator(const IntModel* waveShapeModel, const IntModel* modulationAlgoModel, const float& freq,
+			const float& detuningDivSampleRate, const float& phaseOffset, const float& volume,
+			FrameOscillator* subOsc, bool) :
+			m_waveShapeModel(waveShapeModel),
+			m_modulationAlgoModel(modulationAlgoModel),
+			m_freq(freq),
+			m_detuningDivSampleRate(detuningDivSampleRate),
+			m_volume(volume),
+			m_extPhaseOffset(phaseOffset),
+			m_subOsc(subOsc),
+			m_phaseOffset(phaseOffset),
+			m_phase(phaseOffset)
+		{
+		}
+
+		void setUseWaveTable(bool useWaveTable) { m_useWaveTable = useWaveTable; }
+		void setUserWave(std::shared_ptr<const SampleBuffer> wave) { m_userWave = wave; }
+		void setUserAntiAliasWaveTable(std::shared_ptr<const OscillatorConstants::waveform_t> waveform)
+		{
+			m_userAntiAliasWaveTable = waveform;
+		}
+
+		void update(SampleFrame* ab, const fpp_t frames, const lmms::ch_cnt_t chnl, bool modulator = false)
+		{
+			if (m_freq >= Engine::audioEngine()->outputSampleRate() / 2)
+			{
+				lmms::zeroSampleFrames(ab, frames);
+				return;
+			}
+			m_isModulator = modulator;
+
+			const auto algo = m_subOsc != nullptr
+				? static_cast<ModulationAlgo>(m_modulationAlgoModel->value())
+				: ModulationAlgo::Count;
+			auto subOscCoeff = 0.0f;
+			switch (algo)
+			{
+			case ModulationAlgo::PhaseModulation:
+			case ModulationAlgo::FrequencyModulation:
+				m_subOsc->update(ab, frames, chnl, true);
+				break;
+			case ModulationAlgo::SynchronizedBySubOsc:
+				subOscCoeff = m_subOsc->syncInit(ab, frames, chnl);
+				break;
+			case ModulationAlgo::Count:
+				break;
+			default:
+				m_subOsc->update(ab, frames, chnl, false);
+				break;
+			}
+
+			recalcPhase();
+			const float oscCoeff = m_freq * m_detuningDivSampleRate;
+			const float sampleRateCorrection = 44100.0f / Engine::audioEngine()->outputSampleRate();
+
+			for (fpp_t frame = 0; frame < frames; ++frame)
+			{
+				sample_t& out = ab[frame][chnl];
+				switch (algo)
+				{
+				case ModulationAlgo::PhaseModulation:
+					out = sample(m_phase + out) * m_volume;
+					break;
+				case ModulationAlgo::AmplitudeModulation:
+					out *= sample(m_phase) * m_volume;
+					break;
+				case ModulationAlgo::SynchronizedBySubOsc:
+					if (m_subOsc->syncOk(subOscCoeff)) { m_phase = m_phaseOffset; }
+					out = sample(m_phase) * m_volume;
+					break;
+				case ModulationAlgo::FrequencyModulation:
+					m_phase += out * sampleRateCorrection;
+					out = sample(m_phase) * m_volume;
+					break;
+				case ModulationAlgo::Count:
+					out = sample(m_phase) * m_volume;
+					break;
+				default:
+					out += sample(m_phase) * m_volume;
+					break;
+				}
+				m_phase += oscCoeff;
+			}
+		}
+
+	private:
+		void recalcPhase()
+		{
+			if (!lmms::approximatelyEqual(m_phaseOffset, m_extPhaseOffset))
+			{
+				m_phase -= m_phaseOffset;
+				m_phaseOffset = m_extPhaseOffset;
+				m_phase += m_phaseOffset;
+			}
+			m_phase = lmms::absFraction(m_phase);
+		}
+
+		//! Only renders the oscillators below, this one just keeps its phase for syncOk()
+		float syncInit(SampleFrame* ab, const fpp_t frames, const lmms::ch_cnt_t chnl)
+		{
+			if (m_subOsc != nullptr) { m_subOsc->update(ab, frames, chnl); }
+			recalcPhase();
+			return m_freq * m_detuningDivSampleRate;
+		}
+
+		bool syncOk(float oscCoeff)
+		{
+			const float v1 = m_phase;
+			m_phase += oscCoeff;
+			return std::floor(m_phase) > std::floor(v1);
+		}
+
+		//! The band of the wave table is looked up for every frame
+		sample_t wtSample(const OscillatorConstants::waveform_t& table, float phase) const
+		{
+			const int band = Oscillator::waveTableBandFromFreq(
+				m_freq * m_detuningDivSampleRate * Engine::audioEngine()->outputSampleRate());
+			const float frame = lmms::absFraction(phase) * OscillatorConstants::WAVETABLE_LENGTH;
+			const auto f1 = static_cast<lmms::f_cnt_t>(frame);
+			const auto f2 = f1 < OscillatorConstants::WAVETABLE_LENGTH - 1 ? f1 + 1 : 0;
+			return lmms::linearInterpolate(table[band][f1], table[band][f2], lmms::fraction(frame));
+		}
+
+		sample_t sample(float phase) const
+		{
+			const auto shape = static_cast<WaveShape>(m_waveShapeModel->value());
+			switch (shape)
+			{
+			case WaveShape::Sine:
+			{
+				const float currentFreq = m_freq * m_detuningDivSampleRate * Engine::audioEngine()->outputSampleRate();
+				return !m_useWaveTable || currentFreq < OscillatorConstants::MAX_FREQ ? Oscillator::sinSample(phase) : 0;
+			}
+			case WaveShape::WhiteNoise:
+				return Oscillator::noiseSample(phase);
+			case WaveShape::UserDefined:
+				return m_useWaveTable && m_userAntiAliasWaveTable && !m_isModulator
+					? wtSample(*m_userAntiAliasWaveTable, phase)
+					: Oscillator::userWaveSample(m_userWave.get(), phase);
+			default:
+				break;
+			}
+
+			if (m_useWaveTable && !m_isModulator)
+			{
+				return wtSample(Oscillator::waveTable(shape), phase);
+			}
+			switch (shape)
+			{
+			case WaveShape::Triangle: return Oscillator::triangleSample(phase);
+			case WaveShape::Saw: return Oscillator::sawSample(phase);
+			case WaveShape::Square: return Oscillator::squareSample(phase);
+			case WaveShape::MoogSaw: return Oscillator::moogSawSample(phase);
+			default: return Oscillator::expSample(phase);
+			}
+		}
+
+		const IntModel* m_waveShapeModel;
+		const IntModel* m_modulationAlgoModel;
+		const float& m_freq;
+		const float& m_detuningDivSampleRate;
+		const float& m_volume;
+		const float& m_extPhaseOffset;
+		FrameOscillator* m_subOsc;
+		float m_phaseOffset;
+		float m_phase;
+		std::shared_ptr<const SampleBuffer> m_userWave = SampleBuffer::emptyBuffer();
+		std::shared_ptr<const OscillatorConstants::waveform_t> m_userAntiAliasWaveTable;
+		bool m_useWaveTable = false;
+		bool m_isModulator = false;
+	};
+
+	std::shared_ptr<const SampleBuffer> m_userWave;
+	std::shared_ptr<const OscillatorConstants::waveform_t> m_userAntiAliasWaveTable;
+
+	//! Renders a note in periods of \a periodFrames, with the oscillators chained like in TripleOscillator
+	template<typename Osc>
+	std::vector<SampleFrame> render(const Patch& patch, const float& freq, fpp_t periodFrames) const
+	{
+		auto waveShapeModels = std::array<std::optional<IntModel>, NumOscillators>{};
+		auto modulationAlgoModels = std::array<std::optional<IntModel>, NumOscillators>{};
+		auto detunings = std::array<float, NumOscillators>{};
+		for (int i = 0; i < NumOscillators; ++i)
+		{
+			const auto& settings = patch.oscillators[i];
+			waveShapeModels[i].emplace(static_cast<int>(settings.waveShape), 0,
+				static_cast<int>(Oscillator::NumWaveShapes) - 1);
+			modulationAlgoModels[i].emplace(static_cast<int>(settings.modulationAlgo), 0,
+				static_cast<int>(Oscillator::NumModulationAlgos) - 1);
+			detunings[i] = settings.detuning / Engine::audioEngine()->outputSampleRate();
+		}
+
+		// each oscillator is modulated by the next one
+		auto left = std::array<std::optional<Osc>, NumOscillators>{};
+		auto right = std::array<std::optional<Osc>, NumOscillators>{};
+		for (int i = NumOscillators - 1; i >= 0; --i)
+		{
+			const auto& settings = patch.oscillators[i];
+			const bool last = i == NumOscillators - 1;
+			Osc& oscLeft = left[i].emplace(&*waveShapeModels[i], &*modulationAlgoModels[i], freq, detunings[i],
+				settings.phaseOffset, settings.volume, last ? nullptr : &*left[i + 1], false);
+			Osc& oscRight = right[i].emplace(&*waveShapeModels[i], &*modulationAlgoModels[i], freq, detunings[i],
+				settings.phaseOffset, settings.volume, last ? nullptr : &*right[i + 1], false);
+			for (Osc* osc : {&oscLeft, &oscRight})
+			{
+				osc->setUseWaveTable(settings.useWaveTable);
+				osc->setUserWave(m_userWave);
+				osc->setUserAntiAliasWaveTable(m_userAntiAliasWaveTable);
+			}
+		}
+
+		// the same noise for both renderings
+		std::srand(1);
+		auto buffer = std::vector<SampleFrame>(Frames);
+		for (fpp_t frame = 0; frame < Frames; frame += periodFrames)
+		{
+			const fpp_t frames = std::min(periodFrames, Frames - frame);
+			left[0]->update(buffer.data() + frame, frames, 0);
+			right[0]->update(buffer.data() + frame, frames, 1);
+		}
+		return buffer;
+	}
+
+private slots:
+	void initTestCase()
+	{
+		Engine::init(true);
+
+		auto wave = std::vector<SampleFrame>(200);
+		for (std::size_t i = 0; i < wave.size(); ++i)
+		{
+			const float value = std::sin(i * 0.0314f) * 0.7f + (i < 50 ? 0.3f : -0.1f);
+			wave[i] = SampleFrame{value, value};
+		}
+		m_userWave = std::make_shared<SampleBuffer>(std::move(wave), 44100);
+		m_userAntiAliasWaveTable = Oscillator::generateAntiAliasUserWaveTable(m_userWave.get());
+	}
+
+	void cleanupTestCase()
+	{
+		Engine::destroy();
+	}
+
+	void blocksMatchFramesTest()
+	{
+		// every wave shape and modulation algorithm, with and without wave tables
+		const Patch patches[] = {
+			{"phase modulation", {{
+				{WaveShape::Saw, ModulationAlgo::PhaseModulation, 1.0f, 0.0f, 0.6f, true},
+				{WaveShape::Square, ModulationAlgo::PhaseModulation, 2.0f, 0.25f, 0.3f, true},
+				{WaveShape::Sine, ModulationAlgo::SignalMix, 0.5f, 0.0f, 0.2f, true},
+			}}},
+			{"amplitude modulation and mix", {{
+				{WaveShape::Triangle, ModulationAlgo::AmplitudeModulation, 1.0f, 0.1f, 0.5f, true},
+				{WaveShape::Exponential, ModulationAlgo::SignalMix, 1.5f, 0.0f, 0.4f, true},
+				{WaveShape::MoogSaw, ModulationAlgo::SignalMix, 3.0f, 0.5f, 0.3f, false},
+			}}},
+			{"sync and frequency modulation", {{
+				{WaveShape::Square, ModulationAlgo::SynchronizedBySubOsc, 1.0f, 0.3f, 0.5f, true},
+				{WaveShape::Triangle, ModulationAlgo::FrequencyModulation, 0.75f, 0.0f, 0.5f, true},
+				{WaveShape::WhiteNoise, ModulationAlgo::SignalMix, 1.0f, 0.0f, 0.1f, false},
+			}}},
+			{"user defined waves", {{
+				{WaveShape::UserDefined, ModulationAlgo::SignalMix, 1.0f, 0.0f, 0.5f, true},
+				{WaveShape::UserDefined, ModulationAlgo::AmplitudeModulation, 2.0f, 0.2f, 0.5f, false},
+				// above the highest wave table at 440 Hz
+				{WaveShape::Sine, ModulationAlgo::SignalMix, 46.0f, 0.0f, 0.4f, true},
+			}}},
+			{"wave tables without modulation", {{
+				{WaveShape::MoogSaw, ModulationAlgo::SignalMix, 1.0f, 0.0f, 0.3f, true},
+				{WaveShape::Exponential, ModulationAlgo::SignalMix, 1.01f, 0.4f, 0.3f, false},
+				{WaveShape::Saw, ModulationAlgo::SignalMix, 0.99f, 0.7f, 0.3f, true},
+			}}},
+		};
+
+		for (const auto& patch : patches)
+		{
+			for (const float freq : {55.0f, 440.0f, 3000.0f})
+			{
+				// periods shorter than a block, and longer ones that end inside of a block
+				for (const fpp_t periodFrames : {fpp_t{16}, fpp_t{100}, fpp_t{256}, fpp_t{1000}})
+				{
+					const auto expected = render<FrameOscillator>(patch, freq, periodFrames);
+					const auto actual = render<Oscillator>(patch, freq, periodFrames);
+					for (fpp_t frame = 0; frame < Frames; ++frame)
+					{
+						for (int chnl = 0; chnl < 2; ++chnl)
+						{
+							// bit-identical, not just close
+							QVERIFY2(actual[frame][chnl] == expected[frame][chnl],
+								qPrintable(QString{"%1 at %2 Hz in periods of %3, frame %4 channel %5: %6 != %7"}
+									.arg(patch.name).arg(freq).arg(periodFrames).arg(frame).arg(chnl)
+									.arg(actual[frame][chnl]).arg(expected[frame][chnl])));
+						}
+					}
+				}
+			}
+		}
+	}
+};
+
+QTEST_GUILESS_MAIN(OscillatorTest)
+#include "OscillatorTest.moc"
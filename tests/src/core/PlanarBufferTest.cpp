@@ -0,0 +1,96 @@
+/*
+ * PlanarBufferTest.cpp
+ *
+ * This file is part of LMMS - https://lmms.io
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this program (see COPYING); if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301 USA.
+ *
+ */
+
+#include "PlanarBuffer.h"
+
+#include <QObject>
+#include <QtTest/QtTest>
+#include <limits>
+#include <vector>
+
+#include "MixHelpers.h"
+
+using namespace lmms;
+
+class PlanarBufferTest : public QObject
+{
+	Q_OBJECT
+private slots:
+	void interleaveTest()
+	{
+		constexpr fpp_t Frames = 37;
+		auto buffer = PlanarBuffer{Frames};
+		QCOMPARE(buffer.capacity(), Frames);
+
+		auto interleaved = std::vector<SampleFrame>(Frames);
+		for (fpp_t f = 0; f < Frames; ++f)
+		{
+			interleaved[f] = SampleFrame{static_cast<float>(f), -static_cast<float>(f)};
+		}
+
+		buffer.deinterleave(interleaved.data(), Frames);
+		for (fpp_t f = 0; f < Frames; ++f)
+		{
+			QCOMPARE(buffer.channel(0)[f], static_cast<float>(f));
+			QCOMPARE(buffer.channel(1)[f], -static_cast<float>(f));
+		}
+		QCOMPARE(buffer.channels()[1], buffer.channel(1));
+
+		// the channels must not overlap
+		buffer.zero(Frames);
+		buffer.channel(0)[Frames - 1] = 1.f;
+		QCOMPARE(buffer.channel(1)[0], 0.f);
+
+		auto result = std::vector<SampleFrame>(Frames, SampleFrame{5.f, 5.f});
+		buffer.interleave(result.data(), Frames - 1);
+		QCOMPARE(result[0][0], 0.f);
+		QCOMPARE(result[Frames - 2][1], 0.f);
+		QCOMPARE(result[Frames - 1][0], 5.f);
+	}
+
+	void sanitizeTest()
+	{
+		MixHelpers::setNaNHandler(true);
+
+		// odd frame counts leave a single sample per channel for the scalar code
+		for (fpp_t frames : {1, 2, 7, 64})
+		{
+			auto buffer = PlanarBuffer{frames};
+			for (ch_cnt_t ch = 0; ch < DEFAULT_CHANNELS; ++ch)
+			{
+				std::fill_n(buffer.channel(ch), frames, 2000.f);
+			}
+			QVERIFY(!MixHelpers::sanitize(buffer, frames));
+			QCOMPARE(buffer.channel(1)[frames - 1], 1000.f);
+
+			buffer.channel(1)[frames - 1] = std::numeric_limits<float>::quiet_NaN();
+			QVERIFY(MixHelpers::sanitize(buffer, frames));
+			QCOMPARE(buffer.channel(0)[0], 0.f);
+			QCOMPARE(buffer.channel(1)[frames - 1], 0.f);
+		}
+
+		MixHelpers::setNaNHandler(false);
+	}
+};
+
+QTEST_GUILESS_MAIN(PlanarBufferTest)
+#include "PlanarBufferTest.moc"
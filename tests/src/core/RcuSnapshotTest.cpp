@@ -0,0 +1,106 @@
+/*
+ * RcuSnapshotTest.cpp
+ *
+ * This file is part of LMMS - https://lmms.io
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this program (see COPYING); if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301 USA.
+ *
+ */
+
+#include "RcuSnapshot.h"
+
+#include <QObject>
+#include <QtTest/QtTest>
+#include <thread>
+#include <vector>
+
+using lmms::RcuDomain;
+using lmms::RcuSnapshot;
+
+class RcuSnapshotTest : public QObject
+{
+	Q_OBJECT
+private slots:
+	void updateTest()
+	{
+		auto domain = RcuDomain{};
+		auto snapshot = RcuSnapshot<std::vector<int>>{domain, {1, 2}};
+		const auto& first = snapshot.read();
+
+		snapshot.update([](auto& values) { values.push_back(3); });
+		QCOMPARE(snapshot.read(), (std::vector<int>{1, 2, 3}));
+		QCOMPARE(first, (std::vector<int>{1, 2}));
+
+		snapshot.store({4});
+		QCOMPARE(snapshot.read(), std::vector<int>{4});
+	}
+
+	void reclaimTest()
+	{
+		auto domain = RcuDomain{};
+		auto snapshot = RcuSnapshot<int>{domain, 0};
+
+		// a replaced version must outlive the read section it was read in
+		domain.beginRead();
+		const auto& read = snapshot.read();
+		snapshot.store(1);
+		snapshot.store(2);
+		QCOMPARE(snapshot.retiredVersions(), std::size_t{2});
+		QCOMPARE(read, 0);
+		domain.endRead();
+
+		// no read section is running, so old versions go away on the next write
+		snapshot.store(3);
+		QCOMPARE(snapshot.retiredVersions(), std::size_t{1});
+		domain.synchronize();
+	}
+
+	void concurrentTest()
+	{
+		// the reader checks that every snapshot it sees is complete while
+		// the writer keeps replacing them
+		auto domain = RcuDomain{};
+		auto snapshot = RcuSnapshot<std::vector<int>>{domain};
+		auto done = std::atomic<bool>{false};
+		auto failed = std::atomic<bool>{false};
+
+		auto reader = std::thread{[&] {
+			while (!done)
+			{
+				domain.beginRead();
+				const auto& values = snapshot.read();
+				for (auto value : values)
+				{
+					if (value != static_cast<int>(values.size())) { failed = true; }
+				}
+				domain.endRead();
+			}
+		}};
+
+		for (auto i = 1; i < 2000; ++i)
+		{
+			snapshot.store(std::vector<int>(i % 64, i % 64));
+			if (i % 100 == 0) { domain.synchronize(); }
+		}
+		done = true;
+		reader.join();
+
+		QVERIFY(!failed);
+	}
+};
+
+QTEST_GUILESS_MAIN(RcuSnapshotTest)
+#include "RcuSnapshotTest.moc"
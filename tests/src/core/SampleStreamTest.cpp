@@ -0,0 +1,154 @@
+/*
+ * SampleStreamTest.cpp
+ *
+ * This file is part of LMMS - https://lmms.io
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this program (see COPYING); if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301 USA.
+ *
+ */
+
+#include "SampleStream.h"
+
+#include <QDir>
+#include <QFile>
+#include <QObject>
+#include <QStandardPaths>
+#include <QTemporaryDir>
+#include <QtEndian>
+#include <QtTest/QtTest>
+#include <cmath>
+
+#include "ConfigManager.h"
+
+using lmms::SampleFrame;
+using lmms::SampleStream;
+
+class SampleStreamTest : public QObject
+{
+	Q_OBJECT
+	static constexpr int Frames = 1000;
+	static constexpr int SampleRate = 44100;
+
+	QTemporaryDir m_dir;
+
+	//! Writes a canonical 44 byte header followed by \a data
+	QString writeWave(const QString& name, quint16 formatTag, quint16 channels, quint16 bits, const QByteArray& data)
+	{
+		auto header = QByteArray(44, '\0');
+		auto put16 = [&header](int offset, quint16 value) { qToLittleEndian(value, header.data() + offset); };
+		auto put32 = [&header](int offset, quint32 value) { qToLittleEndian(value, header.data() + offset); };
+		const quint16 blockAlign = channels * bits / 8;
+
+		header.replace(0, 4, "RIFF");
+		put32(4, 36 + data.size());
+		header.replace(8, 8, "WAVEfmt ");
+		put32(16, 16);
+		put16(20, formatTag);
+		put16(22, channels);
+		put32(24, SampleRate);
+		put32(28, SampleRate * blockAlign);
+		put16(32, blockAlign);
+		put16(34, bits);
+		header.replace(36, 4, "data");
+		put32(40, data.size());
+
+		const auto path = m_dir.filePath(name);
+		auto file = QFile{path};
+		file.open(QIODevice::WriteOnly);
+		file.write(header + data);
+		return path;
+	}
+
+	static float valueAt(int frame) { return std::sin(frame * 0.01f) * 0.5f; }
+
+private slots:
+	void initTestCase()
+	{
+		// keep the user's cache directory out of this
+		QStandardPaths::setTestModeEnabled(true);
+		QVERIFY(m_dir.isValid());
+	}
+
+	void floatWaveIsCopiedTest()
+	{
+		auto data = QByteArray{};
+		for (int i = 0; i < Frames; ++i)
+		{
+			const auto frame = SampleFrame{valueAt(i), -valueAt(i)};
+			data.append(reinterpret_cast<const char*>(&frame), sizeof(frame));
+		}
+
+		const auto path = writeWave("float.wav", 3, 2, 32, data);
+		const auto stream = SampleStream::open(path, 0);
+		QVERIFY(stream != nullptr);
+		QCOMPARE(stream->sampleRate(), SampleRate);
+
+		// only the copy in the cache is mapped, so the audio file may change
+		QVERIFY(QFile::resize(path, 0));
+		QCOMPARE(stream->size(), std::size_t{Frames});
+		for (int i = 0; i < Frames; ++i)
+		{
+			QCOMPARE(stream->data()[i].left(), valueAt(i));
+			QCOMPARE(stream->data()[i].right(), -valueAt(i));
+		}
+		stream->readAhead(Frames / 2, Frames);
+	}
+
+	void pcmWaveIsDecodedTest()
+	{
+		auto data = QByteArray(Frames * 2, '\0');
+		for (int i = 0; i < Frames; ++i)
+		{
+			qToLittleEndian(static_cast<qint16>(i * 16), data.data() + i * 2);
+		}
+		const auto path = writeWave("mono.wav", 1, 1, 16, data);
+
+		// the second time, the decoded file is mapped again
+		for (int pass = 0; pass < 2; ++pass)
+		{
+			const auto stream = SampleStream::open(path, 0);
+			QVERIFY(stream != nullptr);
+			QCOMPARE(stream->size(), std::size_t{Frames});
+			for (int i = 0; i < Frames; ++i)
+			{
+				QCOMPARE(stream->data()[i].left(), i * 16 / 32768.f);
+				QCOMPARE(stream->data()[i].right(), i * 16 / 32768.f);
+			}
+		}
+	}
+
+	void shortFileIsNotStreamedTest()
+	{
+		const auto path = writeWave("short.wav", 3, 2, 32, QByteArray(Frames * sizeof(SampleFrame), '\0'));
+		QVERIFY(SampleStream::open(path, (Frames + 1) * sizeof(SampleFrame)) == nullptr);
+	}
+
+	void cacheIsTrimmedTest()
+	{
+		// with a limit of 0 MiB, only the file that was decoded last is kept
+		lmms::ConfigManager::inst()->setValue("app", "samplecachesize", "0");
+		const auto data = QByteArray(Frames * 2, '\0');
+		QVERIFY(SampleStream::open(writeWave("first.wav", 1, 1, 16, data), 0) != nullptr);
+		QVERIFY(SampleStream::open(writeWave("second.wav", 1, 1, 16, data), 0) != nullptr);
+		lmms::ConfigManager::inst()->deleteValue("app", "samplecachesize");
+
+		const auto cache = QDir{lmms::ConfigManager::inst()->cacheDir() + "samples/"};
+		QCOMPARE(cache.entryList({"*.frames"}, QDir::Files).size(), 1);
+	}
+};
+
+QTEST_GUILESS_MAIN(SampleStreamTest)
+#include "SampleStreamTest.moc"
@@ -0,0 +1,120 @@
+/*
+ * SampleTest.cpp
+ *
+ * This file is part of LMMS - https://lmms.io
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this program (see COPYING); if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301 USA.
+ *
+ */
+
+#include "Sample.h"
+
+#include <QObject>
+#include <QtTest/QtTest>
+#include <vector>
+
+using lmms::Sample;
+using lmms::SampleFrame;
+
+class SampleTest : public QObject
+{
+	Q_OBJECT
+	static constexpr int Frames = 1000;
+	static constexpr int SampleRate = 44100;
+
+	static Sample ramp()
+	{
+		auto data = std::vector<SampleFrame>{};
+		for (int i = 0; i < Frames; ++i) { data.emplace_back(static_cast<float>(i), -static_cast<float>(i)); }
+		return Sample{data.data(), data.size(), SampleRate};
+	}
+
+	//! Plays \a periods of \a periodFrames once with copyRaw(), and once with playRaw() and
+	//! advance() like the resampling path at a ratio of 1, and compares them frame by frame
+	static void compare(const Sample& sample, Sample::Loop loopMode, int startFrame, bool backwards,
+		int periods, int periodFrames)
+	{
+		auto copied = Sample::PlaybackState{};
+		auto played = Sample::PlaybackState{};
+		for (auto* state : {&copied, &played})
+		{
+			state->setFrameIndex(startFrame);
+			state->setBackwards(backwards);
+		}
+
+		auto expected = std::vector<SampleFrame>(periodFrames);
+		auto actual = std::vector<SampleFrame>(periodFrames);
+		for (int period = 0; period < periods; ++period)
+		{
+			sample.playRaw(expected.data(), periodFrames, &played, loopMode);
+			sample.advance(&played, periodFrames, loopMode);
+			sample.copyRaw(actual.data(), periodFrames, &copied, loopMode);
+
+			for (int i = 0; i < periodFrames; ++i)
+			{
+				QVERIFY2(actual[i].left() == expected[i].left() && actual[i].right() == expected[i].right(),
+					qPrintable(QString{"period %1, frame %2: %3 != %4"}
+						.arg(period).arg(i).arg(actual[i].left()).arg(expected[i].left())));
+			}
+		}
+	}
+
+private slots:
+	void copyRawMatchesResampling_data()
+	{
+		QTest::addColumn<int>("loopMode");
+		QTest::addColumn<int>("loopStart");
+		QTest::addColumn<int>("loopEnd");
+
+		const auto modes = {std::pair{"off", Sample::Loop::Off}, {"on", Sample::Loop::On},
+			{"pingpong", Sample::Loop::PingPong}};
+		for (const auto& [name, mode] : modes)
+		{
+			QTest::addRow("%s", name) << static_cast<int>(mode) << 200 << 700;
+			QTest::addRow("%s, one frame", name) << static_cast<int>(mode) << 300 << 301;
+			QTest::addRow("%s, zero-length", name) << static_cast<int>(mode) << 500 << 500;
+		}
+	}
+
+	void copyRawMatchesResampling()
+	{
+		QFETCH(int, loopMode);
+		QFETCH(int, loopStart);
+		QFETCH(int, loopEnd);
+
+		auto sample = ramp();
+		sample.setAllPointFrames(0, Frames, loopStart, loopEnd);
+
+		for (const bool reversed : {false, true})
+		{
+			sample.setReversed(reversed);
+			// starting before and inside of the loop, in both directions
+			for (const auto& [startFrame, backwards] : {std::pair{0, false},
+				{(loopStart + loopEnd) / 2, false}, {(loopStart + loopEnd) / 2, true}, {loopEnd - 1, true}})
+			{
+				// periods that are shorter and longer than the loop
+				for (const int periodFrames : {7, 64, 256, 777})
+				{
+					compare(sample, static_cast<Sample::Loop>(loopMode), startFrame, backwards, 20, periodFrames);
+					if (QTest::currentTestFailed()) { return; }
+				}
+			}
+		}
+	}
+};
+
+QTEST_GUILESS_MAIN(SampleTest)
+#include "SampleTest.moc"
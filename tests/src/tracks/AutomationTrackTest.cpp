@@ -23,6 +23,7 @@
  */
 
 #include <QtTest/QtTest>
+#include <cmath>
 
 #include "QCoreApplication"
 
@@ -87,6 +88,41 @@ private slots:
 		QCOMPARE(c.valueAt(150), 1.0f);
 	}
 
+	void testClipValuesAt()
+	{
+		using namespace lmms;
+
+		for (auto type : {AutomationClip::ProgressionType::Discrete, AutomationClip::ProgressionType::Linear,
+			AutomationClip::ProgressionType::CubicHermite})
+		{
+			AutomationClip c(nullptr);
+			c.setProgressionType(type);
+			c.putValue(10, 0.0, false);
+			c.putValues(20, 0.5, 1.0, false);
+			c.putValue(60, 0.25, false);
+
+			// the same values as valueAt(), also when stepping backwards
+			float values[80];
+			c.valuesAt(0, 1, values, 80);
+			for (int tick : {0, 9, 10, 15, 19, 20, 21, 40, 59, 60, 79, 30, 5, 20})
+			{
+				QCOMPARE(values[tick], c.valueAt(tick));
+			}
+
+			// between ticks
+			c.valuesAt(15.25, 0.25, values, 3);
+			if (type == AutomationClip::ProgressionType::Discrete)
+			{
+				QCOMPARE(values[1], 0.0f);
+			}
+			else if (type == AutomationClip::ProgressionType::Linear)
+			{
+				QCOMPARE(values[1], 0.275f);
+			}
+			QVERIFY(values[0] < values[1] || type == AutomationClip::ProgressionType::Discrete);
+		}
+	}
+
 	void testClips()
 	{
 		using namespace lmms;
@@ -150,6 +186,48 @@ private slots:
 		QCOMPARE(song->automatedValuesAt(100)[&model], 0.5f);
 	}
 
+	void testClipsInRange()
+	{
+		using namespace lmms;
+
+		auto song = Engine::getSong();
+		AutomationTrack track(song);
+
+		AutomationClip c1(&track);
+		AutomationClip c2(&track);
+		AutomationClip c3(&track);
+		c1.movePosition(200);
+		c1.changeLength(100);
+		c2.movePosition(0);
+		c2.changeLength(500);
+		c3.movePosition(100);
+		c3.changeLength(10);
+
+		auto clipsInRange = [&](int start, int end) {
+			Track::clipVector clips;
+			track.getClipsInRange(clips, start, end);
+			return clips;
+		};
+		QCOMPARE(clipsInRange(0, 1000), (Track::clipVector{&c2, &c3, &c1}));
+		QCOMPARE(clipsInRange(150, 199), (Track::clipVector{&c2}));
+		QCOMPARE(clipsInRange(300, 300), (Track::clipVector{&c2, &c1}));
+		QCOMPARE(clipsInRange(501, 600), (Track::clipVector{}));
+
+		// the index must follow moved and resized clips
+		c2.changeLength(50);
+		c3.movePosition(400);
+		QCOMPARE(clipsInRange(150, 450), (Track::clipVector{&c1, &c3}));
+
+		// clips of other tracks stay sorted
+		AutomationTrack otherTrack(song);
+		AutomationClip c4(&otherTrack);
+		c4.movePosition(250);
+		c4.changeLength(10);
+		auto clips = clipsInRange(0, 1000);
+		otherTrack.getClipsInRange(clips, 0, 1000);
+		QCOMPARE(clips, (Track::clipVector{&c2, &c1, &c4, &c3}));
+	}
+
 	void testInlineAutomation()
 	{
 		using namespace lmms;
@@ -215,6 +293,42 @@ private slots:
 		QCOMPARE(song->automatedValuesAt(TimePos::ticksPerBar() + 5)[&model], 0.5f);
 	}
 
+	void testClipDeletedMidTick()
+	{
+		using namespace lmms;
+
+		const auto framesPerPeriod = Engine::audioEngine()->framesPerPeriod();
+		if (std::fmod(framesPerPeriod, Engine::framesPerTick()) == 0)
+		{
+			QSKIP("Periods do not start mid-tick with this period size");
+		}
+
+		auto song = Engine::getSong();
+		FloatModel model;
+		AutomationTrack track(song);
+		auto clip = new AutomationClip(&track);
+		clip->setProgressionType(AutomationClip::ProgressionType::Linear);
+		clip->putValue(0, 0.0, false);
+		clip->putValue(100, 1.0, false);
+		clip->movePosition(0);
+		clip->addObject(&model);
+
+		// keep the audio engine from processing the song while we do
+		Engine::audioEngine()->requestChangeInModel();
+		song->playSong();
+		song->processNextBuffer();
+		QVERIFY(song->getPlayPos().currentFrame() > 0);
+
+		// the next period continues the tick, which must not use the deleted clip
+		delete clip;
+		song->processNextBuffer();
+
+		song->stop();
+		Engine::audioEngine()->doneChangeInModel();
+
+		QVERIFY(!song->automatedValuesAt(0).contains(&model));
+	}
+
 	void testGlobalAutomation()
 	{
 		using namespace lmms;